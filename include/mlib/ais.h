@@ -0,0 +1,238 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+///  \file ais.h Decoding of AIS messages carried by NMEA-0183 !AIVDM/!AIVDO sentences
+
+#pragma once
+
+#if __has_include("defs.h")
+#include "defs.h"
+#endif
+
+#include "bitstream.h"
+#include <stdint.h>
+#include <string_view>
+#include <variant>
+
+namespace mlib::ais {
+
+/// Bit stream using AIS 6-bit ASCII armoring
+class armored_bitstream : public bitstream
+{
+public:
+  armored_bitstream (std::iostream& str)
+    : bitstream (str, 6)
+  {}
+
+protected:
+  char encode (unsigned char bits) override;
+  unsigned char decode (char chr) override;
+};
+
+/// De-armored bits of an AIS message
+class payload
+{
+public:
+  /// Maximum message size (5 slots)
+  static constexpr size_t max_bits = 1024;
+
+  payload ();
+
+  /// Append armored characters
+  bool append (std::string_view armored, int fill = 0);
+
+  /// Remove all bits
+  void clear ();
+
+  /// Number of bits in payload
+  size_t size () const
+  {
+    return nbits;
+  }
+
+  /// Return an unsigned field (up to 32 bits)
+  uint32_t get (size_t start, size_t len) const;
+
+  /// Return a signed field (up to 32 bits)
+  int32_t sget (size_t start, size_t len) const;
+
+  /// Return a text field
+  void text (size_t start, size_t nchars, char* str) const;
+
+private:
+  uint8_t bits[max_bits / 8 + 8]; // padding allows 64-bit reads at any position
+  size_t nbits;
+};
+
+/// \name Message records
+/// Latitudes, longitudes and angles are in radians, speeds in knots and
+/// distances in meters. Values that are not available are set to NaN.
+///\{
+
+/// Common header of all messages
+struct header
+{
+  int type;          ///< message type
+  int repeat;        ///< repeat indicator
+  unsigned int mmsi; ///< MMSI number
+};
+
+/// Ship dimensions relative to position reference point
+struct dimensions
+{
+  int to_bow, to_stern, to_port, to_starboard;
+};
+
+/// Position report class A (types 1, 2 and 3)
+struct position_report : header
+{
+  int status;     ///< navigation status
+  int rot;        ///< raw rate of turn (-128 = not available)
+  double sog;     ///< speed over ground
+  bool accuracy;  ///< position accuracy flag
+  double lon, lat;
+  double cog;     ///< course over ground
+  double heading; ///< true heading
+  int second;     ///< UTC second
+  int maneuver;   ///< maneuver indicator
+  bool raim;      ///< RAIM flag
+};
+
+/// Base station report (type 4)
+struct base_station : header
+{
+  int year, month, day, hour, minute, second;
+  bool accuracy;
+  double lon, lat;
+  int epfd; ///< type of position fixing device
+  bool raim;
+};
+
+/// Static and voyage related data (type 5)
+struct static_voyage : header
+{
+  int ais_version;
+  unsigned int imo;
+  char callsign[8];
+  char name[21];
+  int shiptype;
+  dimensions dim;
+  int epfd;
+  int month, day, hour, minute; ///< ETA
+  double draught;
+  char destination[21];
+  bool dte;
+};
+
+/// Class B position report (type 18)
+struct class_b_position : header
+{
+  double sog;
+  bool accuracy;
+  double lon, lat;
+  double cog;
+  double heading;
+  int second;
+  bool cs;   ///< carrier sense unit
+  bool raim;
+};
+
+/// Extended class B position report (type 19)
+struct class_b_extended : header
+{
+  double sog;
+  bool accuracy;
+  double lon, lat;
+  double cog;
+  double heading;
+  int second;
+  char name[21];
+  int shiptype;
+  dimensions dim;
+  int epfd;
+  bool raim;
+};
+
+/// Aid-to-navigation report (type 21)
+struct aid_to_navigation : header
+{
+  int aid_type;
+  char name[35]; ///< name including name extension
+  bool accuracy;
+  double lon, lat;
+  dimensions dim;
+  int epfd;
+  int second;
+  bool off_position;
+  bool raim;
+  bool virtual_aid;
+};
+
+/// Static data report (type 24). Part A contains only the name.
+struct static_data : header
+{
+  int part;
+  char name[21];
+  int shiptype;
+  char vendor[4];
+  int model;
+  unsigned int serial;
+  char callsign[8];
+  dimensions dim;
+  unsigned int mothership; ///< MMSI of mother ship for auxiliary craft
+};
+///\}
+
+/// Result of AIS decoding. Holds `std::monostate` for unsupported or invalid messages.
+using message = std::variant<std::monostate, position_report, base_station, static_voyage,
+                             class_b_position, class_b_extended, aid_to_navigation, static_data>;
+
+/// Decode message from payload bits
+message decode (const payload& p);
+
+/// Reassembles and decodes AIS messages from !AIVDM/!AIVDO sentences
+class decoder
+{
+public:
+  /// Decoder counters
+  struct stats
+  {
+    size_t messages;   ///< messages decoded
+    size_t fragments;  ///< fragments received
+    size_t incomplete; ///< messages with missing fragments
+    size_t invalid;    ///< invalid sentences or unsupported messages
+  };
+
+  decoder ();
+
+  /// Process one sentence
+  message add (const char* sentence);
+
+  /// Return `true` if last message was from own ship (!AIVDO)
+  bool own () const
+  {
+    return own_ship;
+  }
+
+  /// Return decoder counters
+  const stats& statistics () const
+  {
+    return st;
+  }
+
+private:
+  // partially assembled multi-fragment messages indexed by sequential message ID
+  struct partial
+  {
+    payload bits;
+    int count; // number of fragments
+    int next;  // next expected fragment (0 if slot is free)
+    char channel;
+  } slot[10];
+  bool own_ship;
+  stats st;
+};
+
+} // namespace mlib::ais
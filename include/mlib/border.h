@@ -11,9 +11,13 @@
 #include "defs.h"
 #endif
 
+#include "errorcode.h"
 #include "point.h"
 
-#include <deque>
+#include <span>
+#include <stdint.h>
+#include <string>
+#include <vector>
 
 namespace mlib {
 
@@ -21,16 +25,88 @@ class Border
 {
 public:
   Border ();
-  Border (const char* fname);
+  Border (const std::string& fname);
+
+  /// Load border from a text or binary file
+  erc load (const std::string& fname);
+
+  /// Save border to a text file
+  erc save (const std::string& fname) const;
+
+  /// Save border to a binary file
+  erc save_binary (const std::string& fname) const;
+
   void add (double x, double y);
   void close (double x, double y);
 
-  bool inside (double x, double y);
+  bool inside (double x, double y) const;
+
+  /// Check if many points are inside the border
+  size_t inside (std::span<const double> x, std::span<const double> y, std::span<uint8_t> result,
+                 unsigned int nthreads = 0) const;
+
+  /// Return number of vertexes
+  size_t size () const
+  {
+    return vertex.size ();
+  }
+
+  /// Return border vertexes
+  const std::vector<dpoint>& vertexes () const
+  {
+    return vertex;
+  }
+
+  /// Return closing point
+  const dpoint& closing_point () const
+  {
+    return closing;
+  }
+
+  bool bbox (dpoint& ll, dpoint& ur) const;
+
+  /// Return `true` if "inside" region is outside the polygon
+  bool hole () const
+  {
+    return closing_outside;
+  }
+
+  /// Build spatial index used by inside() function
+  void build_index ();
+
+  /// Remove spatial index
+  void drop_index ();
+
+  /// Return `true` if border has a spatial index
+  bool indexed () const
+  {
+    return !grid.status.empty ();
+  }
+
+  /// Minimum number of vertexes for automatic index creation
+  static constexpr size_t index_threshold = 64;
 
 private:
-  std::deque<dpoint> vertex;
+  bool inside_scan (double x, double y) const;
+  bool inside_grid (double x, double y) const;
+  size_t inside_block (const double* x, const double* y, uint8_t* result, size_t count) const;
+
+  std::vector<dpoint> vertex;
   dpoint closing;
   bool closing_outside;
+
+  // Uniform grid over bounding box. Each cell has the list of edges
+  // intersecting it and the inside/outside status of its center.
+  struct
+  {
+    dpoint ll;                   // lower left corner
+    dpoint ur;                   // upper right corner
+    double cw, ch;               // cell width and height
+    int nx, ny;                  // number of columns and rows
+    std::vector<uint32_t> start; // start of each cell in edges array
+    std::vector<uint32_t> edges; // edge indexes (edge i ends in vertex i)
+    std::vector<uint8_t> status; // parity of cell centers
+  } grid;
 };
 
 } // namespace mlib
@@ -0,0 +1,104 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+/// \file borderset.h Collection of borders with a spatial index
+
+#pragma once
+
+#if __has_include("defs.h")
+#include "defs.h"
+#endif
+
+#include "border.h"
+
+#include <span>
+#include <stdint.h>
+#include <vector>
+
+namespace mlib {
+
+class BorderSet
+{
+public:
+  BorderSet ();
+
+  /// Add a border to the set and return its identifier
+  size_t insert (Border b);
+
+  /// Remove a border from the set
+  bool remove (size_t id);
+
+  /// Remove all borders
+  void clear ();
+
+  /// Return number of borders in set
+  size_t size () const
+  {
+    return count;
+  }
+
+  /// Return `true` if `id` identifies a border in set
+  bool contains (size_t id) const
+  {
+    return id < used.size () && used[id];
+  }
+
+  /// Access a border by its identifier
+  const Border& operator[] (size_t id) const
+  {
+    return borders[id];
+  }
+
+  /// Find borders containing a point
+  size_t find (double x, double y, std::vector<size_t>& ids) const;
+
+  /// Find borders containing each of many points
+  size_t find (std::span<const double> x, std::span<const double> y, std::vector<size_t>& start,
+               std::vector<size_t>& ids, unsigned int nthreads = 0) const;
+
+  /// Return height of R-tree
+  int height () const;
+
+private:
+  static constexpr int max_entries = 16;
+  static constexpr int min_entries = 6;
+  static constexpr uint32_t none = UINT32_MAX;
+
+  struct box
+  {
+    double xmin, ymin, xmax, ymax;
+  };
+
+  // R-tree node. Entries of leaf nodes are border identifiers; entries of
+  // other nodes are child nodes. There is room for one extra entry before
+  // a node is split.
+  struct node
+  {
+    int count;
+    bool leaf;
+    box rc[max_entries + 1];
+    uint32_t child[max_entries + 1];
+  };
+
+  uint32_t new_node (bool leaf);
+  void insert_entry (const box& b, uint32_t id);
+  uint32_t split (uint32_t n);
+  bool find_leaf (uint32_t n, const box& b, uint32_t id, std::vector<uint32_t>& path) const;
+  void collect (uint32_t n, std::vector<uint32_t>& ids);
+  void search (uint32_t n, double x, double y, std::vector<size_t>& ids) const;
+  void search (double x, double y, std::vector<size_t>& ids) const;
+
+  std::vector<Border> borders;      // borders indexed by identifier
+  std::vector<box> boxes;           // bounding box of each border
+  std::vector<bool> used;           // `true` if identifier is in use
+  std::vector<size_t> free_ids;     // identifiers available for reuse
+  std::vector<size_t> unbounded;    // hole or empty borders, not in R-tree
+  std::vector<node> nodes;          // R-tree nodes
+  std::vector<uint32_t> free_nodes; // R-tree nodes available for reuse
+  uint32_t root;
+  size_t count;
+};
+
+} // namespace mlib
@@ -25,8 +25,251 @@
 
 #include "point.h"
 
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 namespace mlib {
 
 int convex_hull (dpoint* p, int n);
 
+namespace detail {
+
+// Twice the signed area of triangle a, b, c (positive if counterclockwise)
+template <typename T>
+inline double hull_orient (const Point<T>& a, const Point<T>& b, const Point<T>& c)
+{
+  return ((double)b.x - a.x) * ((double)c.y - a.y) - ((double)b.y - a.y) * ((double)c.x - a.x);
+}
+
+// True if points i, j, k are counterclockwise (or collinear)
+template <typename T>
+inline bool hull_ccw (const Point<T>& i, const Point<T>& j, const Point<T>& k)
+{
+  return hull_orient (i, j, k) >= 0;
 }
+
+/*
+  Sort points using `less` comparison and make a convex chain from them.
+
+  If `last` is not null, it is the end point of the chain. Returns the number
+  of points in the chain, excluding the end point (which is `v[s]` or `*last`).
+*/
+template <typename T, class Cmp>
+size_t hull_chain (Point<T>* v, size_t n, const Point<T>* last, Cmp less)
+{
+  std::sort (v, v + n, less);
+  if (n < 2)
+    return last ? n : 0;
+
+  size_t s = 1;
+  for (size_t i = 2; i < n; i++)
+  {
+    size_t j = s;
+    while (j >= 1 && hull_ccw (v[i], v[j], v[j - 1]))
+      j--;
+    s = j + 1;
+    std::swap (v[s], v[i]);
+  }
+  if (last)
+  {
+    size_t j = s;
+    while (j >= 1 && hull_ccw (*last, v[j], v[j - 1]))
+      j--;
+    s = j + 1;
+  }
+  return s;
+}
+
+} // namespace detail
+
+/*!
+  Find convex hull for an array of points.
+
+  \param p points array
+  \param n number of points
+  \param nthreads maximum number of threads to use. If 0, use the number of
+                  hardware threads.
+  \return number of points in the convex hull
+
+  If `r` is the number of points returned by this function, the input array is
+  rearranged so that the first `r` points make the convex hull in
+  counterclockwise order, starting with the lowest-leftmost point.
+
+  Large arrays are split in chunks processed by separate threads. The hull of
+  each chunk is computed in place, the hull points are moved at the beginning
+  of the array and the final hull is the convex hull of these points.
+*/
+template <typename T>
+size_t convex_hull (Point<T>* p, size_t n, unsigned int nthreads = 1)
+{
+  // split only if there is enough work for each thread
+  const size_t min_points = 1 << 16;
+  if (!nthreads)
+    nthreads = (std::max) (std::thread::hardware_concurrency (), 1u);
+  size_t nchunks = std::clamp (n / min_points, (size_t)1, (size_t)nthreads);
+  if (nchunks > 1)
+  {
+    std::vector<size_t> first (nchunks + 1), hn (nchunks);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i <= nchunks; i++)
+      first[i] = n * i / nchunks;
+    for (size_t i = 0; i < nchunks; i++)
+      workers.emplace_back (
+        [&, i] () { hn[i] = convex_hull (p + first[i], first[i + 1] - first[i], 1); });
+    for (auto& w : workers)
+      w.join ();
+
+    size_t m = 0;
+    for (size_t i = 0; i < nchunks; i++)
+      for (size_t k = 0; k < hn[i]; k++)
+        std::swap (p[m++], p[first[i] + k]);
+    n = m;
+  }
+
+  auto lower = [] (const Point<T>& a, const Point<T>& b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  };
+  auto higher = [] (const Point<T>& a, const Point<T>& b) {
+    return a.x > b.x || (a.x == b.x && a.y > b.y);
+  };
+
+  size_t u = detail::hull_chain (p, n, (const Point<T>*)nullptr, lower); // make lower hull
+  if (!u)
+    return n;
+  return u + detail::hull_chain (p + u, n - u, p, higher); // make upper hull
+}
+
+/// Convex hull of a stream of points
+template <typename T>
+class OnlineHull
+{
+public:
+  OnlineHull ();
+
+  /// Add a new point
+  void add (const Point<T>& pt);
+
+  /// Return hull vertexes in counterclockwise order
+  const std::vector<Point<T>>& hull ();
+
+  /// Check if a point is inside the hull
+  bool inside (const Point<T>& pt);
+
+  /// Return area of hull
+  double area ();
+
+  /// Return number of points added
+  size_t count () const
+  {
+    return added;
+  }
+
+  /// Remove all points
+  void clear ();
+
+private:
+  bool inside_hull (const Point<T>& pt) const;
+  void update ();
+
+  std::vector<Point<T>> h;       // hull vertexes
+  std::vector<Point<T>> pending; // points outside hull not yet merged
+  size_t added;
+};
+
+/*!
+  \class OnlineHull
+  \ingroup geom
+
+  Points that fall inside the current hull are discarded after an
+  O(log h) check, where `h` is the number of hull vertexes. The other points
+  are kept in a buffer that is merged with the hull when it becomes as large as
+  the hull or when the hull is needed. A merge costs O(h log h) so the
+  amortized cost of adding a point is small and memory usage is proportional
+  to the size of the hull, not to the number of points.
+*/
+
+/// Create an empty hull
+template <typename T>
+OnlineHull<T>::OnlineHull ()
+  : added (0)
+{}
+
+template <typename T>
+void OnlineHull<T>::add (const Point<T>& pt)
+{
+  added++;
+  if (inside_hull (pt))
+    return;
+  pending.push_back (pt);
+  if (pending.size () >= (std::max) (h.size (), (size_t)32))
+    update ();
+}
+
+template <typename T>
+const std::vector<Point<T>>& OnlineHull<T>::hull ()
+{
+  if (!pending.empty ())
+    update ();
+  return h;
+}
+
+/// Points on the hull boundary are considered inside
+template <typename T>
+bool OnlineHull<T>::inside (const Point<T>& pt)
+{
+  if (!pending.empty ())
+    update ();
+  return inside_hull (pt);
+}
+
+template <typename T>
+double OnlineHull<T>::area ()
+{
+  hull ();
+  double a = 0;
+  for (size_t i = 0, j = h.size () - 1; i < h.size (); j = i++)
+    a += ((double)h[j].x + h[i].x) * ((double)h[i].y - h[j].y);
+  return a / 2;
+}
+
+template <typename T>
+void OnlineHull<T>::clear ()
+{
+  h.clear ();
+  pending.clear ();
+  added = 0;
+}
+
+// Binary search for the wedge from h[0] containing the point
+template <typename T>
+bool OnlineHull<T>::inside_hull (const Point<T>& pt) const
+{
+  size_t n = h.size ();
+  if (n < 3)
+    return false;
+  if (detail::hull_orient (h[0], h[1], pt) < 0 || detail::hull_orient (h[0], h[n - 1], pt) > 0)
+    return false;
+  size_t lo = 1, hi = n - 1;
+  while (hi - lo > 1)
+  {
+    size_t mid = (lo + hi) / 2;
+    if (detail::hull_orient (h[0], h[mid], pt) >= 0)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return detail::hull_orient (h[lo], h[hi], pt) >= 0;
+}
+
+// Merge pending points with hull vertexes
+template <typename T>
+void OnlineHull<T>::update ()
+{
+  pending.insert (pending.end (), h.begin (), h.end ());
+  size_t n = convex_hull (pending.data (), pending.size ());
+  h.assign (pending.begin (), pending.begin () + n);
+  pending.clear ();
+}
+
+} // namespace mlib
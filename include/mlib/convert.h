@@ -11,7 +11,9 @@
 #pragma once
 
 #include <math.h>
+#include <charconv>
 #include <numbers>
+#include <span>
 #include <string>
 #include <cmath>
 
@@ -252,9 +254,23 @@ enum deg_fmt
 /// Conversion from degrees to a string.
 std::string degtoa (double degrees, deg_fmt format, bool latitude, int precision);
 
+/// Conversion from degrees to a character buffer
+std::to_chars_result degtoa (char* first, char* last, double degrees, deg_fmt format,
+                             bool latitude, int precision);
+
+/// Conversion of an array of degrees values to a character buffer
+std::to_chars_result degtoa (char* first, char* last, std::span<const double> degrees,
+                             deg_fmt format, bool latitude, int precision, char sep = '\n');
+
 /// Conversion from string to decimal degrees
 double atodeg (const std::string& str);
 
+/// Conversion from a character buffer to decimal degrees
+std::from_chars_result atodeg (const char* first, const char* last, double& degrees);
+
+/// Conversion from a character buffer to an array of decimal degrees values
+size_t atodeg (const char* first, const char* last, std::span<double> degrees, char sep = '\n');
+
 /*!
    A handy template to get sin and cos in a single function call
 
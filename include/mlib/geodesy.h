@@ -0,0 +1,44 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+/// \file geodesy.h Distances and azimuths on the sphere and on the ellipsoid
+
+#pragma once
+
+#if __has_include("defs.h")
+#include "defs.h"
+#endif
+
+#include "convert.h"
+
+#include <span>
+
+namespace mlib {
+
+/// Mean radius of the Earth (IUGG)
+constexpr double R_EARTH = 6371008.8;
+
+/// Great circle distance and initial azimuth between two points
+double haversine (double lat1, double lon1, double lat2, double lon2, double* az = nullptr,
+                  double radius = R_EARTH);
+
+/// Great circle distances and initial azimuths between pairs of points
+void haversine (std::span<const double> lat1, std::span<const double> lon1,
+                std::span<const double> lat2, std::span<const double> lon2,
+                std::span<double> dist, std::span<double> az = {}, unsigned int nthreads = 0,
+                double radius = R_EARTH);
+
+/// Geodesic distance and azimuths between two points on the ellipsoid
+bool vincenty (double lat1, double lon1, double lat2, double lon2, double& dist,
+               double* az1 = nullptr, double* az2 = nullptr, double a = A_WGS84,
+               double f = F_WGS84);
+
+/// Geodesic distances and azimuths between pairs of points on the ellipsoid
+size_t vincenty (std::span<const double> lat1, std::span<const double> lon1,
+                 std::span<const double> lat2, std::span<const double> lon2,
+                 std::span<double> dist, std::span<double> az1 = {}, std::span<double> az2 = {},
+                 unsigned int nthreads = 0, double a = A_WGS84, double f = F_WGS84);
+
+} // namespace mlib
@@ -0,0 +1,431 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+/// \file kdtree.h KD-tree for nearest neighbour and radius searches of 2D points
+
+#pragma once
+
+#if __has_include("defs.h")
+#include "defs.h"
+#endif
+
+#include "point.h"
+
+#include <algorithm>
+#include <math.h>
+#include <span>
+#include <stdint.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mlib {
+
+/*!
+  \class KdTree
+  \ingroup geom
+  \brief Static KD-tree of 2D points
+
+  The tree has an implicit layout: points are stored in one array, arranged so
+  that the root of each subtree is the median element of its range, with
+  smaller coordinates on its left and larger ones on its right. The only other
+  information kept is the split dimension of each node, chosen as the one with
+  the larger spread. There are no pointers and points close in space are close
+  in memory.
+
+  Small subtrees (up to \ref leaf_size points) are leaves that are scanned
+  linearly.
+
+  Query functions return indexes in the array used to build the tree.
+  Distances are the Euclidean distances computed by Point::distance().
+*/
+template <typename T>
+class KdTree
+{
+public:
+  /// Create an empty tree
+  KdTree () = default;
+
+  /// Create a tree from a set of points
+  KdTree (std::span<const Point<T>> pts, unsigned int nthreads = 1)
+  {
+    build (pts, nthreads);
+  }
+
+  void build (std::span<const Point<T>> pts, unsigned int nthreads = 1);
+
+  /// Return number of points in tree
+  size_t size () const
+  {
+    return pt.size ();
+  }
+
+  size_t nearest (const Point<T>& q) const;
+  size_t nearest (const Point<T>& q, size_t k, std::vector<size_t>& ids) const;
+  size_t radius (const Point<T>& q, double r, std::vector<size_t>& ids) const;
+
+  void nearest (std::span<const Point<T>> q, std::span<size_t> ids, unsigned int nthreads = 0) const;
+  size_t radius (std::span<const Point<T>> q, double r, std::vector<size_t>& start,
+                 std::vector<size_t>& ids, unsigned int nthreads = 0) const;
+
+  /// Maximum number of points in a leaf
+  static constexpr size_t leaf_size = 8;
+
+private:
+  static double coord (const Point<T>& p, int d)
+  {
+    return d ? (double)p.y : (double)p.x;
+  }
+  static double dist2 (const Point<T>& a, const Point<T>& b)
+  {
+    double dx = (double)a.x - b.x, dy = (double)a.y - b.y;
+    return dx * dx + dy * dy;
+  }
+
+  struct entry
+  {
+    Point<T> p;
+    size_t idx;
+  };
+  void build (std::vector<entry>& w, size_t lo, size_t hi, int depth);
+  void search1 (size_t lo, size_t hi, const Point<T>& q, double& best, size_t& pos) const;
+  void searchk (size_t lo, size_t hi, const Point<T>& q, size_t k,
+                std::vector<std::pair<double, size_t>>& heap) const;
+  void search_r (size_t lo, size_t hi, const Point<T>& q, double r,
+                 std::vector<size_t>& ids) const;
+
+  template <class F>
+  static void parallel (size_t n, unsigned int nthreads, F f);
+
+  std::vector<Point<T>> pt;  // points in tree order
+  std::vector<size_t> index; // original index of each point
+  std::vector<uint8_t> dim;  // split dimension of each node
+  int par_depth = 0;         // tree levels built in parallel
+};
+
+/*!
+  Build the tree from a set of points.
+
+  \param pts - points
+  \param nthreads - maximum number of threads to use. If 0, use the number of
+                    hardware threads.
+
+  The points are copied in the tree. For large sets, the top levels of the
+  tree are built in parallel, each subtree in a separate thread.
+*/
+template <typename T>
+void KdTree<T>::build (std::span<const Point<T>> pts, unsigned int nthreads)
+{
+  std::vector<entry> w (pts.size ());
+  for (size_t i = 0; i < w.size (); i++)
+    w[i] = {pts[i], i};
+  dim.assign (pts.size (), 0);
+
+  if (!nthreads)
+    nthreads = (std::max) (std::thread::hardware_concurrency (), 1u);
+  par_depth = 0;
+  if (pts.size () >= (1 << 16))
+  {
+    while ((1u << par_depth) < nthreads)
+      par_depth++;
+  }
+  build (w, 0, w.size (), 0);
+
+  pt.resize (w.size ());
+  index.resize (w.size ());
+  for (size_t i = 0; i < w.size (); i++)
+  {
+    pt[i] = w[i].p;
+    index[i] = w[i].idx;
+  }
+}
+
+// Build subtree for range [lo, hi) of work array. Points are moved together with
+// their original indexes.
+template <typename T>
+void KdTree<T>::build (std::vector<entry>& w, size_t lo, size_t hi, int depth)
+{
+  if (hi - lo <= leaf_size)
+    return;
+
+  double xmin = w[lo].p.x, xmax = xmin, ymin = w[lo].p.y, ymax = ymin;
+  for (size_t i = lo + 1; i < hi; i++)
+  {
+    const Point<T>& p = w[i].p;
+    xmin = (std::min) (xmin, (double)p.x);
+    xmax = (std::max) (xmax, (double)p.x);
+    ymin = (std::min) (ymin, (double)p.y);
+    ymax = (std::max) (ymax, (double)p.y);
+  }
+  int d = (ymax - ymin > xmax - xmin) ? 1 : 0;
+
+  size_t mid = (lo + hi) / 2;
+  std::nth_element (w.begin () + lo, w.begin () + mid, w.begin () + hi,
+                    [d] (const entry& a, const entry& b) { return coord (a.p, d) < coord (b.p, d); });
+  dim[mid] = (uint8_t)d;
+
+  if (depth < par_depth)
+  {
+    std::thread left ([&w, lo, mid, depth, this] () { build (w, lo, mid, depth + 1); });
+    build (w, mid + 1, hi, depth + 1);
+    left.join ();
+  }
+  else
+  {
+    build (w, lo, mid, depth + 1);
+    build (w, mid + 1, hi, depth + 1);
+  }
+}
+
+/*!
+  Find the nearest point.
+
+  \param q - query point
+  \return index of nearest point or `SIZE_MAX` if tree is empty
+
+  If more points are at the same distance, the function returns the one with
+  the smallest index.
+*/
+template <typename T>
+size_t KdTree<T>::nearest (const Point<T>& q) const
+{
+  if (pt.empty ())
+    return SIZE_MAX;
+  double best = HUGE_VAL;
+  size_t pos = 0;
+  search1 (0, pt.size (), q, best, pos);
+  return index[pos];
+}
+
+/*!
+  Find the `k` nearest points.
+
+  \param q - query point
+  \param k - number of points to find
+  \param ids - indexes of nearest points, in increasing order of distance
+  \return number of points found; smaller than `k` only if the tree has fewer
+          than `k` points
+*/
+template <typename T>
+size_t KdTree<T>::nearest (const Point<T>& q, size_t k, std::vector<size_t>& ids) const
+{
+  ids.clear ();
+  if (!k || pt.empty ())
+    return 0;
+  std::vector<std::pair<double, size_t>> heap;
+  heap.reserve (k + 1);
+  searchk (0, pt.size (), q, k, heap);
+  std::sort_heap (heap.begin (), heap.end ());
+  for (auto& h : heap)
+    ids.push_back (h.second);
+  return ids.size ();
+}
+
+/*!
+  Find all points within a given distance.
+
+  \param q - query point
+  \param r - search radius
+  \param ids - indexes of points at a distance not larger than `r`, in
+               ascending order
+  \return number of points found
+*/
+template <typename T>
+size_t KdTree<T>::radius (const Point<T>& q, double r, std::vector<size_t>& ids) const
+{
+  ids.clear ();
+  if (!pt.empty () && r >= 0)
+    search_r (0, pt.size (), q, r, ids);
+  std::sort (ids.begin (), ids.end ());
+  return ids.size ();
+}
+
+/*!
+  Find the nearest point for each of many query points.
+
+  \param q - query points
+  \param ids - index of nearest point for each query point
+  \param nthreads - maximum number of threads to use. If 0, use the number of
+                    hardware threads.
+
+  The number of queries is the size of the shorter span.
+*/
+template <typename T>
+void KdTree<T>::nearest (std::span<const Point<T>> q, std::span<size_t> ids,
+                         unsigned int nthreads) const
+{
+  size_t n = (std::min) (q.size (), ids.size ());
+  parallel (n, nthreads, [&] (size_t first, size_t last, size_t) {
+    for (size_t i = first; i < last; i++)
+      ids[i] = nearest (q[i]);
+  });
+}
+
+/*!
+  Find all points within a given distance from each of many query points.
+
+  \param q - query points
+  \param r - search radius
+  \param start - index in `ids` of first point found for each query point
+  \param ids - indexes of points found for each query point
+  \param nthreads - maximum number of threads to use. If 0, use the number of
+                    hardware threads.
+  \return total number of points found
+
+  On return, `start` has one more element than `q` and the points within
+  distance `r` from `q[i]` are `ids[start[i]]` to `ids[start[i+1]-1]`.
+*/
+template <typename T>
+size_t KdTree<T>::radius (std::span<const Point<T>> q, double r, std::vector<size_t>& start,
+                          std::vector<size_t>& ids, unsigned int nthreads) const
+{
+  start.assign (q.size () + 1, 0);
+  std::vector<std::vector<size_t>> results (
+    (std::max) (nthreads ? nthreads : std::thread::hardware_concurrency (), 1u));
+  parallel (q.size (), nthreads, [&] (size_t first, size_t last, size_t chunk) {
+    std::vector<size_t> found;
+    for (size_t i = first; i < last; i++)
+    {
+      radius (q[i], r, found);
+      start[i + 1] = found.size ();
+      results[chunk].insert (results[chunk].end (), found.begin (), found.end ());
+    }
+  });
+  ids.clear ();
+  for (auto& v : results)
+    ids.insert (ids.end (), v.begin (), v.end ());
+  for (size_t i = 0; i < q.size (); i++)
+    start[i + 1] += start[i];
+  return ids.size ();
+}
+
+// Run f (first, last, chunk) over ranges of [0, n) in separate threads
+template <typename T>
+template <class F>
+void KdTree<T>::parallel (size_t n, unsigned int nthreads, F f)
+{
+  const size_t min_queries = 4096;
+  if (!nthreads)
+    nthreads = (std::max) (std::thread::hardware_concurrency (), 1u);
+  size_t nchunks = std::clamp (n / min_queries, (size_t)1, (size_t)nthreads);
+  if (nchunks == 1)
+  {
+    f (0, n, 0);
+    return;
+  }
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < nchunks; i++)
+    workers.emplace_back (f, n * i / nchunks, n * (i + 1) / nchunks, i);
+  for (auto& w : workers)
+    w.join ();
+}
+
+// Nearest neighbour search in range [lo, hi)
+template <typename T>
+void KdTree<T>::search1 (size_t lo, size_t hi, const Point<T>& q, double& best,
+                         size_t& pos) const
+{
+  if (hi - lo <= leaf_size)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      double d = dist2 (q, pt[i]);
+      if (d < best || (d == best && index[i] < index[pos]))
+      {
+        best = d;
+        pos = i;
+      }
+    }
+    return;
+  }
+
+  size_t mid = (lo + hi) / 2;
+  double d = dist2 (q, pt[mid]);
+  if (d < best || (d == best && index[mid] < index[pos]))
+  {
+    best = d;
+    pos = mid;
+  }
+  double diff = coord (q, dim[mid]) - coord (pt[mid], dim[mid]);
+  if (diff < 0)
+  {
+    search1 (lo, mid, q, best, pos);
+    if (diff * diff <= best)
+      search1 (mid + 1, hi, q, best, pos);
+  }
+  else
+  {
+    search1 (mid + 1, hi, q, best, pos);
+    if (diff * diff <= best)
+      search1 (lo, mid, q, best, pos);
+  }
+}
+
+// k nearest neighbours search in range [lo, hi). Results are kept in a max-heap
+// of (squared distance, original index) pairs.
+template <typename T>
+void KdTree<T>::searchk (size_t lo, size_t hi, const Point<T>& q, size_t k,
+                         std::vector<std::pair<double, size_t>>& heap) const
+{
+  auto consider = [&] (size_t i) {
+    std::pair<double, size_t> c{dist2 (q, pt[i]), index[i]};
+    if (heap.size () < k)
+    {
+      heap.push_back (c);
+      std::push_heap (heap.begin (), heap.end ());
+    }
+    else if (c < heap.front ())
+    {
+      std::pop_heap (heap.begin (), heap.end ());
+      heap.back () = c;
+      std::push_heap (heap.begin (), heap.end ());
+    }
+  };
+
+  if (hi - lo <= leaf_size)
+  {
+    for (size_t i = lo; i < hi; i++)
+      consider (i);
+    return;
+  }
+
+  size_t mid = (lo + hi) / 2;
+  consider (mid);
+  double diff = coord (q, dim[mid]) - coord (pt[mid], dim[mid]);
+  size_t lo1 = lo, hi1 = mid, lo2 = mid + 1, hi2 = hi;
+  if (diff >= 0)
+  {
+    std::swap (lo1, lo2);
+    std::swap (hi1, hi2);
+  }
+  searchk (lo1, hi1, q, k, heap);
+  if (heap.size () < k || diff * diff <= heap.front ().first)
+    searchk (lo2, hi2, q, k, heap);
+}
+
+// Radius search in range [lo, hi)
+template <typename T>
+void KdTree<T>::search_r (size_t lo, size_t hi, const Point<T>& q, double r,
+                          std::vector<size_t>& ids) const
+{
+  if (hi - lo <= leaf_size)
+  {
+    for (size_t i = lo; i < hi; i++)
+      if (q.distance (pt[i]) <= r)
+        ids.push_back (index[i]);
+    return;
+  }
+
+  size_t mid = (lo + hi) / 2;
+  if (q.distance (pt[mid]) <= r)
+    ids.push_back (index[mid]);
+  double diff = coord (q, dim[mid]) - coord (pt[mid], dim[mid]);
+  if (diff <= r)
+    search_r (lo, mid, q, r, ids);
+  if (diff >= -r)
+    search_r (mid + 1, hi, q, r, ids);
+}
+
+} // namespace mlib
@@ -0,0 +1,44 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+///  \file mapfile.h Read-only memory mapping of a file
+
+#pragma once
+
+#if __has_include("defs.h")
+#include "defs.h"
+#endif
+
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace mlib {
+
+/// Read-only memory mapping of a file
+class mapped_file
+{
+public:
+  mapped_file (const std::string& fname);
+  ~mapped_file ();
+
+  mapped_file (const mapped_file&) = delete;
+  mapped_file& operator= (const mapped_file&) = delete;
+
+  const char* data; ///< file content or `nullptr` if file is empty or cannot be mapped
+  size_t size;      ///< file size
+  int error;        ///< system error code if file cannot be mapped
+
+private:
+#ifdef _WIN32
+  HANDLE file, map;
+#else
+  int fd;
+#endif
+};
+
+} // namespace mlib
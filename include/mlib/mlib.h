@@ -13,34 +13,46 @@
 
 #include "safe_winsock.h"
 
+#include "ais.h"
 #include "base64.h"
 #include "bitstream.h"
 #include "border.h"
+#include "borderset.h"
+#include "chull.h"
 #include "convert.h"
 #include "crc32.h"
 #include "dprintf.h"
 #include "errorcode.h"
+#include "geodesy.h"
 #include "hex.h"
 #include "ipow.h"
 #include "json.h"
+#include "kdtree.h"
+#include "mapfile.h"
 #include "md5.h"
 #include "nmea.h"
+#include "nmealog.h"
+#include "nmeaepoch.h"
 #include "options.h"
 #include "point.h"
+#include "pointarray.h"
 #include "poly.h"
 #include "ringbuf.h"
 #include "rotmat.h"
+#include "simplify.h"
 #include "sock.h"
 #include "sockbuf.h"
 #include "sockstream.h"
 #include "statpars.h"
 #include "stopwatch.h"
 #include "trace.h"
+#include "track.h"
 #include "tvops.h"
 
 // sqlite3 wrappers needs SQLITE3 headers
 #if __has_include("sqlite3/sqlite3.h")
 #include "sqlitepp.h"
+#include "sqlrtree.h"
 #endif
 
 // Windows specific stuff
@@ -48,7 +60,6 @@
 
 #include "asset.h"
 #include "basename.h"
-#include "chull.h"
 #include "firewall.h"
 #include "http.h"
 #include "jbridge.h"
@@ -11,10 +11,44 @@
 #include "defs.h"
 #endif
 
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
 namespace mlib::nmea {
 
 bool checksum (const char* buf);
 
+/// Checksum validation result for one sentence in a buffer
+struct checksum_result
+{
+  size_t offset; ///< offset of sentence start in buffer
+  size_t length; ///< sentence length, without line terminator
+  bool present;  ///< sentence has a checksum field
+  bool valid;    ///< checksum is correct or missing
+};
+
+/// Validate checksums of all sentences in a buffer
+size_t checksum (const char* buf, size_t len, std::vector<checksum_result>& results);
+
+/// \name Field decoders
+///\{
+
+/// Decode a fixed-point decimal field as a scaled integer
+bool fixed (std::string_view fld, int64_t& val, int& decimals);
+
+/// Decode a decimal field
+double decimal (std::string_view fld);
+
+/// Decode a latitude or longitude field (DDMM.mmm or DDDMM.mmm) to radians
+double latlon (std::string_view fld);
+
+/// Decode a time field (HHMMSS.sss) to seconds since midnight
+double hms (std::string_view fld);
+///\}
+
 int dbs (const char* buf, double* depth);
 int dbt (const char* buf, double* depth);
 int dpt (const char* buf, double* depth, double* offset, double* range);
@@ -51,4 +85,225 @@ int vtg (const char* buf, double* speed, double* head);
 int zda (const char* buf, double* time, unsigned short* day, unsigned short* month,
          unsigned short* year);
 
+/// \name Sentence records produced by nmea::parse()
+/// Values and units are the same as those returned by the corresponding
+/// parsing function.
+///\{
+
+/// Depth below surface
+struct DBS
+{
+  double depth;
+};
+
+/// Depth below transducer
+struct DBT
+{
+  double depth;
+};
+
+/// Depth of water
+struct DPT
+{
+  double depth, offset, range;
+};
+
+/// GPS fix data
+struct GGA
+{
+  double lat, lon, time, height, undul, dop, age;
+  int sat, mode, station;
+};
+
+/// Geographic position (Ashtech GGK)
+struct GGK
+{
+  double lat, lon, time, height, dop;
+  int sat, mode;
+};
+
+/// Geographic position - latitude/longitude
+struct GLL
+{
+  double lat, lon, time;
+  int mode;
+};
+
+/// GNSS fix data
+struct GNS
+{
+  double time, lat, lon, dop, height, age;
+  int mode, sat, station;
+};
+
+/// GNSS DOP and active satellites
+struct GSA
+{
+  int hmode, fmode;
+  int sv[12];
+  double pdop, hdop, vdop;
+};
+
+/// GNSS pseudorange error statistics
+struct GST
+{
+  double time, rms, smaj, smin, orient, stdlat, stdlon, stdh;
+};
+
+/// GNSS satellites in view. Satellite data is for the satellites in this message only.
+struct GSV
+{
+  int tmsg, msg, count;
+  int sv[4], az[4], elev[4], snr[4];
+};
+
+/// TRANSIT fix data
+struct GXP
+{
+  double lat, lon, time;
+  int wp;
+};
+
+/// Heading, deviation and variation
+struct HDG
+{
+  double head, dev, var;
+};
+
+/// Heading, magnetic
+struct HDM
+{
+  double head;
+};
+
+/// Heading, true
+struct HDT
+{
+  double head;
+};
+
+/// Leica local position and quality
+struct LLQ
+{
+  double time, x, y, dop, height;
+  int mode, sat;
+};
+
+/// Attitude data (proprietary $PASHR)
+struct PASHR
+{
+  double time, hdg, pitch, roll, heave, roll_std, pitch_std, hdg_std;
+  int flag_h, flag_i;
+};
+
+/// Hemisphere heading, pitch and roll (proprietary $PSAT,HPR)
+struct PSATHPR
+{
+  double time, head, pitch, roll;
+  char type;
+};
+
+/// Trimble time, position, position type and DOP (proprietary $PTNL,GGK)
+struct PTNLGGK
+{
+  double lat, lon, time, height, dop;
+  int sat, mode;
+};
+
+/// Trimble quality information (proprietary $PTNL,QA)
+struct PTNLQA
+{
+  double sigman, sigmae, smaj, smin, orient;
+};
+
+/// Recommended minimum specific GNSS data
+struct RMC
+{
+  double lat, lon, time, speed, head;
+  int date, mode;
+};
+
+/// Tracked target message
+struct TTM
+{
+  double utc, dist, brg, speed, cog, cpa, tcpa;
+  int num, relbrg, relcog, stat;
+  char name[32];
+};
+
+/// Course over ground and ground speed
+struct VTG
+{
+  double speed, head;
+};
+
+/// Time and date
+struct ZDA
+{
+  double time;
+  unsigned short day, month, year;
+};
+///\}
+
+/// Result of nmea::parse(). Holds `std::monostate` if sentence could not be parsed.
+using sentence = std::variant<std::monostate, DBS, DBT, DPT, GGA, GGK, GLL, GNS, GSA, GST, GSV,
+                              GXP, HDG, HDM, HDT, LLQ, PASHR, PSATHPR, PTNLGGK, PTNLQA, RMC, TTM,
+                              VTG, ZDA>;
+
+/// Identify and parse any supported NMEA-0183 sentence
+sentence parse (const char* buf);
+
+/// \name Sentence encoders
+///\{
+size_t encode (char* buf, size_t sz, const GGA& r, const char* talker = "GP");
+size_t encode (char* buf, size_t sz, const HDT& r, const char* talker = "GP");
+size_t encode (char* buf, size_t sz, const RMC& r, const char* talker = "GP");
+size_t encode (char* buf, size_t sz, const VTG& r, const char* talker = "GP");
+size_t encode (char* buf, size_t sz, const ZDA& r, const char* talker = "GP");
+///\}
+
+/// Splits a stream of bytes into NMEA-0183 sentences
+class framer
+{
+public:
+  /// Framer counters
+  struct stats
+  {
+    size_t sentences;    ///< valid sentences returned
+    size_t bad_checksum; ///< sentences with invalid checksum
+    size_t overlong;     ///< sentences longer than maximum length
+    size_t dropped;      ///< bytes of garbage, incomplete or overlong sentences
+  };
+
+  framer (size_t max_length = 128, bool need_checksum = false);
+
+  /// Supply a new chunk of data
+  void push (const char* data, size_t len);
+
+  /// Retrieve next complete sentence
+  bool next (std::string_view& sentence);
+
+  /// Return framer counters
+  const stats& statistics () const
+  {
+    return st;
+  }
+
+  /// Discard any partial sentence and reset counters
+  void reset ();
+
+private:
+  bool valid (std::string_view s) const;
+
+  const char* chunk;   // current chunk
+  size_t chunk_len;    // length of current chunk
+  size_t pos;          // scanning position in current chunk
+  size_t seg;          // start of current sentence in chunk
+  bool in_sentence;    // inside a sentence
+  std::string partial; // beginning of sentence from previous chunks
+  size_t maxlen;
+  bool need_cks;
+  stats st;
+};
+
 } // namespace mlib::nmea
@@ -0,0 +1,124 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+///  \file nmeaepoch.h Grouping of NMEA-0183 sentences in GNSS epochs
+
+#pragma once
+
+#if __has_include("defs.h")
+#include "defs.h"
+#endif
+
+#include "nmea.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace mlib::nmea {
+
+/// Consolidated GNSS solution for one epoch
+struct fix
+{
+  /// Flags showing which sentence types contributed to a fix
+  enum source : unsigned int
+  {
+    gga = 1,
+    gst = 2,
+    gsa = 4,
+    hdt = 8,
+    pashr = 16,
+    zda = 32
+  };
+
+  unsigned int have; ///< combination of source flags
+  double time;       ///< UTC time of epoch (HHMMSS.sss)
+  unsigned short day, month, year;
+
+  // GGA
+  double lat, lon, height, undul, dop, age;
+  int sat, mode, station;
+
+  // GST
+  double rms, smaj, smin, orient, stdlat, stdlon, stdh;
+
+  // GSA
+  int fmode;
+  int sv[12];
+  double pdop, hdop, vdop;
+
+  // HDT or PASHR
+  double heading, pitch, roll, heave;
+
+  double latency; ///< time (in seconds) between first sentence and emission
+};
+
+/// Groups parsed NMEA sentences by epoch time and produces consolidated fixes
+class epoch_assembler
+{
+public:
+  /// Assembler counters
+  struct stats
+  {
+    size_t epochs;     ///< fixes produced
+    size_t complete;   ///< fixes with all expected sentences
+    size_t late;       ///< sentences received after their epoch was produced
+    size_t untimed;    ///< sentences without time received between epochs
+    size_t overflow;   ///< fixes dropped because queue was full
+    double latency;    ///< average latency (seconds)
+    double max_latency;///< maximum latency (seconds)
+  };
+
+  epoch_assembler (unsigned int expected = fix::gga | fix::gst, double tolerance = 0.05,
+                   size_t queue_size = 64);
+
+  /// Add a parsed sentence
+  void add (const sentence& s);
+
+  /// Parse and add a sentence
+  void add (const char* buf);
+
+  /// Produce the current epoch, even if incomplete
+  void flush ();
+
+  /// Retrieve next fix
+  bool next (fix& f);
+
+  /// Return a copy of assembler counters
+  stats statistics () const;
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  void open (double t);
+  void emit ();
+  bool push (const fix& f);
+
+  unsigned int expected;
+  double tolerance;
+
+  // producer state; protected by mutex
+  mutable std::mutex lock;
+  bool pending;       // an epoch is being assembled
+  fix current;        // epoch being assembled
+  double epoch_secs;  // time of current epoch (seconds since midnight)
+  double last_secs;   // time of last produced epoch
+  long long interval; // interval between last two produced epochs (ms)
+  clock::time_point first_arrival;
+  stats st;
+  double total_latency;
+
+  // bounded lock-free queue of produced fixes
+  struct cell
+  {
+    std::atomic<size_t> seq;
+    fix data;
+  };
+  std::unique_ptr<cell[]> cells;
+  size_t mask;
+  std::atomic<size_t> enqueue_pos, dequeue_pos;
+};
+
+} // namespace mlib::nmea
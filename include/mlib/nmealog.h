@@ -0,0 +1,81 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+///  \file nmealog.h Bulk decoding of NMEA-0183 log files
+
+#pragma once
+
+#if __has_include("defs.h")
+#include "defs.h"
+#endif
+
+#include "errorcode.h"
+#include <string>
+#include <vector>
+
+namespace mlib::nmea {
+
+/// Columns of data decoded from GGA sentences
+struct gga_columns
+{
+  std::vector<double> time, lat, lon, height, undul, dop, age;
+  std::vector<int> quality, sat, station;
+};
+
+/// Columns of data decoded from GST sentences
+struct gst_columns
+{
+  std::vector<double> time, rms, smaj, smin, orient, stdlat, stdlon, stdh;
+};
+
+/// Columns of data decoded from HDT sentences
+struct hdt_columns
+{
+  std::vector<double> time; ///< time of most recent sentence with a time field
+  std::vector<double> head;
+};
+
+/// Columnar table of data decoded from a NMEA-0183 log
+struct log_table
+{
+  gga_columns gga;
+  gst_columns gst;
+  hdt_columns hdt;
+
+  /// Remove all data
+  void clear ();
+
+  /// Append data from another table
+  void append (const log_table& other);
+
+  /// Save table to a binary file
+  erc write (const std::string& fname) const;
+
+  /// Load table from a binary file
+  erc read (const std::string& fname);
+};
+
+/// Statistics of a bulk decoding operation
+struct log_stats
+{
+  size_t sentences;    ///< sentences with a valid checksum
+  size_t decoded;      ///< sentences decoded into table
+  size_t invalid;      ///< sentences that could not be parsed
+  size_t bad_checksum; ///< sentences with bad checksum or too long
+  size_t dropped;      ///< bytes outside valid sentences
+  double seconds;      ///< elapsed time
+
+  /// Throughput in sentences/second
+  double rate () const
+  {
+    return seconds > 0 ? sentences / seconds : 0;
+  }
+};
+
+/// Decode a NMEA-0183 log file using multiple threads
+erc decode_log (const std::string& fname, log_table& tbl, log_stats* stats = nullptr,
+                unsigned int nthreads = 0);
+
+} // namespace mlib::nmea
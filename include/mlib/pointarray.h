@@ -0,0 +1,338 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+/// \file pointarray.h Structure-of-arrays container for large sets of points
+
+#pragma once
+
+#if __has_include("defs.h")
+#include "defs.h"
+#endif
+
+#include "point.h"
+
+#include <algorithm>
+#include <math.h>
+#include <span>
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+
+namespace mlib {
+
+namespace detail {
+// Vectorized kernels for arrays of double coordinates
+void pa_distance (const double* x, const double* y, size_t n, double rx, double ry, double* out);
+void pa_azimuth (const double* x, const double* y, size_t n, double rx, double ry, double* out);
+void pa_bbox (const double* x, const double* y, size_t n, double& xmin, double& ymin, double& xmax,
+              double& ymax);
+size_t pa_nearest (const double* x, const double* y, size_t n, double rx, double ry);
+} // namespace detail
+
+/*!
+  \class point_array
+  \ingroup geom
+
+  Points are stored as two separate arrays of X and Y coordinates. Bulk
+  operations process all points in one call; for `double` coordinates, the
+  distance, azimuth, bounding box and nearest point functions use SSE2 or AVX
+  instructions. Translations and rotations are simple loops that compilers
+  vectorize on their own.
+
+  Results are the same as those of the corresponding Point functions, within
+  floating point rounding.
+
+  The coordinate arrays can be accessed directly using the x() and y()
+  functions. They can be passed without copying to any function expecting a
+  span of values.
+*/
+template <typename T>
+class point_array
+{
+public:
+  /// Create an empty array
+  point_array () = default;
+
+  /// Create an array of `n` points at origin
+  explicit point_array (size_t n)
+    : xv (n)
+    , yv (n)
+  {}
+
+  /// Create an array from a set of points
+  point_array (std::span<const Point<T>> pts)
+  {
+    assign (pts);
+  }
+
+  /// Replace content with a set of points
+  void assign (std::span<const Point<T>> pts);
+
+  /// Return all points as an array of structures
+  std::vector<Point<T>> points () const;
+
+  /// Return number of points
+  size_t size () const
+  {
+    return xv.size ();
+  }
+
+  /// Return `true` if array is empty
+  bool empty () const
+  {
+    return xv.empty ();
+  }
+
+  /// Change number of points
+  void resize (size_t n)
+  {
+    xv.resize (n);
+    yv.resize (n);
+  }
+
+  /// Reserve space for `n` points
+  void reserve (size_t n)
+  {
+    xv.reserve (n);
+    yv.reserve (n);
+  }
+
+  /// Remove all points
+  void clear ()
+  {
+    xv.clear ();
+    yv.clear ();
+  }
+
+  /// Append a point
+  void push_back (const Point<T>& p)
+  {
+    xv.push_back (p.x);
+    yv.push_back (p.y);
+  }
+
+  /// Return a point
+  Point<T> operator[] (size_t i) const
+  {
+    return {xv[i], yv[i]};
+  }
+
+  /// Change a point
+  void set (size_t i, const Point<T>& p)
+  {
+    xv[i] = p.x;
+    yv[i] = p.y;
+  }
+
+  /// X coordinates
+  std::span<T> x ()
+  {
+    return xv;
+  }
+  /// X coordinates
+  std::span<const T> x () const
+  {
+    return xv;
+  }
+
+  /// Y coordinates
+  std::span<T> y ()
+  {
+    return yv;
+  }
+  /// Y coordinates
+  std::span<const T> y () const
+  {
+    return yv;
+  }
+
+  void distance (const Point<T>& ref, std::span<double> out) const;
+  void azimuth (const Point<T>& ref, std::span<double> out) const;
+  void translate (const Point<T>& d);
+  void rotate (double angle);
+  void rotate (double angle, const Point<T>& center);
+  bool bbox (Point<T>& ll, Point<T>& ur) const;
+  size_t nearest (const Point<T>& ref) const;
+
+private:
+  std::vector<T> xv, yv;
+};
+
+template <typename T>
+void point_array<T>::assign (std::span<const Point<T>> pts)
+{
+  xv.resize (pts.size ());
+  yv.resize (pts.size ());
+  for (size_t i = 0; i < pts.size (); i++)
+  {
+    xv[i] = pts[i].x;
+    yv[i] = pts[i].y;
+  }
+}
+
+template <typename T>
+std::vector<Point<T>> point_array<T>::points () const
+{
+  std::vector<Point<T>> pts (size ());
+  for (size_t i = 0; i < pts.size (); i++)
+  {
+    pts[i].x = xv[i];
+    pts[i].y = yv[i];
+  }
+  return pts;
+}
+
+/*!
+  Compute distances from a reference point.
+
+  \param ref - reference point
+  \param out - distances to each point
+
+  Number of distances computed is the smaller of array size and output size.
+*/
+template <typename T>
+void point_array<T>::distance (const Point<T>& ref, std::span<double> out) const
+{
+  size_t n = (std::min) (size (), out.size ());
+  if constexpr (std::is_same_v<T, double>)
+    detail::pa_distance (xv.data (), yv.data (), n, ref.x, ref.y, out.data ());
+  else
+  {
+    for (size_t i = 0; i < n; i++)
+      out[i] = hypot ((double)xv[i] - ref.x, (double)yv[i] - ref.y);
+  }
+}
+
+/*!
+  Compute azimuths from a reference point.
+
+  \param ref - reference point
+  \param out - azimuths from `ref` to each point
+
+  Results are the same as those of Point::azimuth() function.
+  Number of azimuths computed is the smaller of array size and output size.
+*/
+template <typename T>
+void point_array<T>::azimuth (const Point<T>& ref, std::span<double> out) const
+{
+  size_t n = (std::min) (size (), out.size ());
+  if constexpr (std::is_same_v<T, double>)
+    detail::pa_azimuth (xv.data (), yv.data (), n, ref.x, ref.y, out.data ());
+  else
+  {
+    for (size_t i = 0; i < n; i++)
+      out[i] = ref.azimuth ((*this)[i]);
+  }
+}
+
+/// Translate all points
+template <typename T>
+void point_array<T>::translate (const Point<T>& d)
+{
+  T* px = xv.data ();
+  T* py = yv.data ();
+  for (size_t i = 0; i < size (); i++)
+  {
+    px[i] += d.x;
+    py[i] += d.y;
+  }
+}
+
+/// Rotate all points around origin
+template <typename T>
+void point_array<T>::rotate (double angle)
+{
+  auto [s, c] = sincos (angle);
+  T* px = xv.data ();
+  T* py = yv.data ();
+  for (size_t i = 0; i < size (); i++)
+  {
+    double x1 = px[i] * c - py[i] * s;
+    double y1 = px[i] * s + py[i] * c;
+    px[i] = (T)x1;
+    py[i] = (T)y1;
+  }
+}
+
+/// Rotate all points around a center point
+template <typename T>
+void point_array<T>::rotate (double angle, const Point<T>& center)
+{
+  auto [s, c] = sincos (angle);
+  T* px = xv.data ();
+  T* py = yv.data ();
+  for (size_t i = 0; i < size (); i++)
+  {
+    double dx = px[i] - center.x, dy = py[i] - center.y;
+    px[i] = (T)(center.x + dx * c - dy * s);
+    py[i] = (T)(center.y + dx * s + dy * c);
+  }
+}
+
+/*!
+  Find bounding box of all points.
+
+  \param ll - lower left corner
+  \param ur - upper right corner
+  \return `false` if array is empty
+*/
+template <typename T>
+bool point_array<T>::bbox (Point<T>& ll, Point<T>& ur) const
+{
+  if (empty ())
+    return false;
+  if constexpr (std::is_same_v<T, double>)
+    detail::pa_bbox (xv.data (), yv.data (), size (), ll.x, ll.y, ur.x, ur.y);
+  else
+  {
+    ll = ur = (*this)[0];
+    for (size_t i = 1; i < size (); i++)
+    {
+      ll.x = (std::min) (ll.x, xv[i]);
+      ll.y = (std::min) (ll.y, yv[i]);
+      ur.x = (std::max) (ur.x, xv[i]);
+      ur.y = (std::max) (ur.y, yv[i]);
+    }
+  }
+  return true;
+}
+
+/*!
+  Find the point closest to a reference point.
+
+  \param ref - reference point
+  \return index of closest point or `SIZE_MAX` if array is empty
+
+  If more points are at the same distance, the function returns the first one.
+*/
+template <typename T>
+size_t point_array<T>::nearest (const Point<T>& ref) const
+{
+  if (empty ())
+    return SIZE_MAX;
+  if constexpr (std::is_same_v<T, double>)
+    return detail::pa_nearest (xv.data (), yv.data (), size (), ref.x, ref.y);
+  else
+  {
+    size_t best = 0;
+    double dmin = HUGE_VAL;
+    for (size_t i = 0; i < size (); i++)
+    {
+      double dx = (double)xv[i] - ref.x, dy = (double)yv[i] - ref.y;
+      double d = dx * dx + dy * dy;
+      if (d < dmin)
+      {
+        dmin = d;
+        best = i;
+      }
+    }
+    return best;
+  }
+}
+
+/// Specialization of point_array using double as underlining type
+typedef point_array<double> dpoint_array;
+
+} // namespace mlib
@@ -10,11 +10,29 @@
 #include "defs.h"
 #endif
 
+#include <algorithm>
 #include <array>
+#include <span>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace mlib {
 
+namespace detail {
+// Vectorized evaluation of a polynomial with double coefficients
+void poly_eval (const double* x, size_t cnt, const double* coeff, int n, double* out);
+
+// Horner's scheme completely unrolled for a fixed number of coefficients
+template <typename T, size_t N, size_t... I>
+T poly_unrolled (T x, const T* coeff, std::index_sequence<I...>)
+{
+  T val = coeff[N - 1];
+  ((val = val * x + coeff[N - 2 - I]), ...);
+  return val;
+}
+} // namespace detail
+
 template <typename T>
 /*!
   Evaluate a polynomial using Horner's scheme
@@ -46,11 +64,13 @@ T poly (T x, const T* coeff, int n)
           coeff[N-1]*x^(N-1) + coeff[N-2]*x^(N-2) + ... + coeff[1]*x + coeff[0]
 
   This template function will generate a new instantiation for each array size.
+  The evaluation loop is completely unrolled.
 */
 template <typename T, size_t N>
-T poly (T x, std::array<T, N> coeff)
+T poly (T x, const std::array<T, N>& coeff)
 {
-  return poly (x, coeff.data (), (int)N);
+  static_assert (N > 0, "Polynomial must have at least one coefficient");
+  return detail::poly_unrolled<T, N> (x, coeff.data (), std::make_index_sequence<N - 1> ());
 }
 
 /*!
@@ -62,9 +82,73 @@ T poly (T x, std::array<T, N> coeff)
           coeff[N-1]*x^(N-1) + coeff[N-2]*x^(N-2) + ... + coeff[1]*x + coeff[0]
 */
 template <typename T>
-T poly (T x, std::vector<T> coeff)
+T poly (T x, const std::vector<T>& coeff)
 {
   return poly (x, coeff.data (), (int)coeff.size ());
 }
 
+/*!
+  Evaluate a polynomial in many points
+  \param x Evaluation points
+  \param out Polynomial values in each point
+  \param coeff polynomial coefficients in order from lowest power (coeff[0]) to
+               highest power (coeff[N-1])
+  \param n size of coefficient's array.
+
+  Number of values computed is the smaller of the sizes of `x` and `out`. They
+  can be the same span for in-place evaluation.
+
+  For `double` values, points are evaluated in parallel using SSE2 or AVX
+  instructions, with the evaluation loop unrolled for up to 16 coefficients.
+  Operations are done in the same order as in the scalar function.
+*/
+template <typename T>
+void poly (std::span<const std::type_identity_t<T>> x, std::span<std::type_identity_t<T>> out,
+           const T* coeff, int n)
+{
+  size_t cnt = (std::min) (x.size (), out.size ());
+  if constexpr (std::is_same_v<T, double>)
+    detail::poly_eval (x.data (), cnt, coeff, n, out.data ());
+  else
+  {
+    for (size_t i = 0; i < cnt; i++)
+      out[i] = poly (x[i], coeff, n);
+  }
+}
+
+/*!
+  Evaluate a polynomial in many points
+  \param x Evaluation points
+  \param out Polynomial values in each point
+  \param coeff array of polynomial coefficients in order from lowest power
+               (coeff[0]) to highest power (coeff[N-1])
+*/
+template <typename T, size_t N>
+void poly (std::span<const std::type_identity_t<T>> x, std::span<std::type_identity_t<T>> out,
+           const std::array<T, N>& coeff)
+{
+  size_t cnt = (std::min) (x.size (), out.size ());
+  if constexpr (std::is_same_v<T, double>)
+    detail::poly_eval (x.data (), cnt, coeff.data (), (int)N, out.data ());
+  else
+  {
+    for (size_t i = 0; i < cnt; i++)
+      out[i] = poly (x[i], coeff);
+  }
+}
+
+/*!
+  Evaluate a polynomial in many points
+  \param x Evaluation points
+  \param out Polynomial values in each point
+  \param coeff vector of polynomial coefficients in order from lowest power
+               (coeff[0]) to highest power (coeff[N-1])
+*/
+template <typename T>
+void poly (std::span<const std::type_identity_t<T>> x, std::span<std::type_identity_t<T>> out,
+           const std::vector<T>& coeff)
+{
+  poly (x, out, coeff.data (), (int)coeff.size ());
+}
+
 } // namespace mlib
@@ -11,6 +11,9 @@
 #include "defs.h"
 #endif
 
+#include <span>
+#include <stddef.h>
+
 namespace mlib {
 
 ///  3D Rotation Calculator
@@ -23,6 +26,9 @@ public:
   /// Build rotation matrix in order Z, Y, X (yaw, pitch, roll)
   RotMat (double rx, double ry, double rz);
 
+  /// Build rotation from a 3x3 matrix
+  RotMat (const double m[3][3]);
+
   /// Rotation by X (roll) axis
   void x_rotation (double angle);
 
@@ -38,12 +44,27 @@ public:
   /// Rotate a vector containing the x, y, z coordinates
   void rotate (double* vec) const;
 
+  /// Rotate many points stored as consecutive x, y, z triplets
+  void rotate (double* xyz, size_t n) const;
+
+  /// Rotate many points stored as separate coordinate arrays
+  void rotate (std::span<double> x, std::span<double> y, std::span<double> z) const;
+
+  /// Combined rotation: `other` followed by this one
+  RotMat operator* (const RotMat& other) const;
+
+  /// Inverse rotation
+  RotMat transpose () const;
+
   /// Return reference to rotation matrix (3x3)
   double (&matrix ())[3][3];
 
+  /// Return reference to rotation matrix (3x3)
+  const double (&matrix () const)[3][3];
+
 private:
   double r[3][3];
-  void multiply (double m[3][3]);
+  void multiply (const double m[3][3]);
 };
 
 inline double (&RotMat::matrix ())[3][3]
@@ -51,4 +72,49 @@ inline double (&RotMat::matrix ())[3][3]
   return r;
 }
 
+inline const double (&RotMat::matrix () const)[3][3]
+{
+  return r;
+}
+
+/// Unit quaternion representing a 3D rotation
+class Quaternion
+{
+public:
+  /// Build an identity rotation
+  Quaternion ();
+
+  /// Build a quaternion from its components
+  Quaternion (double w, double x, double y, double z);
+
+  /// Build rotation in order Z, Y, X (yaw, pitch, roll)
+  Quaternion (double rx, double ry, double rz);
+
+  /// Build quaternion from a rotation matrix
+  explicit Quaternion (const RotMat& m);
+
+  /// Return rotation matrix
+  RotMat rotmat () const;
+
+  /// Combined rotation: `other` followed by this one
+  Quaternion operator* (const Quaternion& other) const;
+
+  /// Inverse rotation
+  Quaternion conjugate () const;
+
+  /// Scale quaternion to unit length
+  void normalize ();
+
+  /// Rotate a 3D point
+  void rotate (double& x, double& y, double& z) const;
+
+  double w, x, y, z;
+};
+
+/// Spherical linear interpolation between two rotations
+Quaternion slerp (const Quaternion& q0, const Quaternion& q1, double t);
+
+/// Normalized linear interpolation between two rotations
+Quaternion nlerp (const Quaternion& q0, const Quaternion& q1, double t);
+
 } // namespace mlib
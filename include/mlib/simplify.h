@@ -0,0 +1,361 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+/// \file simplify.h Simplification of polylines and GNSS tracks
+
+#pragma once
+
+#if __has_include("defs.h")
+#include "defs.h"
+#endif
+
+#include "point.h"
+
+#include <algorithm>
+#include <math.h>
+#include <span>
+#include <stdint.h>
+#include <vector>
+
+namespace mlib {
+
+namespace detail {
+/// Square of distance from point `p` to segment `a`-`b`
+template <typename T>
+double seg_dist2 (const Point<T>& p, const Point<T>& a, const Point<T>& b)
+{
+  double dx = (double)b.x - a.x, dy = (double)b.y - a.y;
+  double px = (double)p.x - a.x, py = (double)p.y - a.y;
+  double len2 = dx * dx + dy * dy;
+  if (len2 > 0)
+  {
+    double t = std::clamp ((px * dx + py * dy) / len2, 0., 1.);
+    px -= t * dx;
+    py -= t * dy;
+  }
+  return px * px + py * py;
+}
+
+/// Area of triangle `a`-`b`-`c`
+template <typename T>
+double tri_area (const Point<T>& a, const Point<T>& b, const Point<T>& c)
+{
+  double abx = (double)b.x - a.x, aby = (double)b.y - a.y;
+  double acx = (double)c.x - a.x, acy = (double)c.y - a.y;
+  return fabs (abx * acy - acx * aby) / 2;
+}
+} // namespace detail
+
+/*!
+  Simplify a polyline using Douglas-Peucker algorithm.
+
+  \param pts - polyline vertexes
+  \param tol - maximum distance between removed vertexes and simplified polyline
+  \param keep - indexes of vertexes kept, in ascending order
+  \return number of vertexes kept
+
+  First and last vertexes are always kept. The function uses an explicit stack
+  instead of recursion, so long tracks cannot overflow the call stack. Running
+  time is O(n log n) for typical tracks, degrading to O(n<sup>2</sup>) only for
+  pathological inputs like spirals. Use visvalingam() if a guaranteed bound is
+  needed.
+*/
+template <typename T>
+size_t douglas_peucker (std::span<const Point<T>> pts, double tol, std::vector<size_t>& keep)
+{
+  keep.clear ();
+  size_t n = pts.size ();
+  if (n <= 2)
+  {
+    for (size_t i = 0; i < n; i++)
+      keep.push_back (i);
+    return n;
+  }
+
+  std::vector<uint8_t> marked (n, 0);
+  marked[0] = marked[n - 1] = 1;
+  const double tol2 = tol * tol;
+  std::vector<std::pair<size_t, size_t>> stack;
+  stack.emplace_back (0, n - 1);
+  while (!stack.empty ())
+  {
+    auto [first, last] = stack.back ();
+    stack.pop_back ();
+    double dmax = -1;
+    size_t imax = first;
+    for (size_t i = first + 1; i < last; i++)
+    {
+      double d = detail::seg_dist2 (pts[i], pts[first], pts[last]);
+      if (d > dmax)
+      {
+        dmax = d;
+        imax = i;
+      }
+    }
+    if (dmax > tol2)
+    {
+      marked[imax] = 1;
+      if (imax - first > 1)
+        stack.emplace_back (first, imax);
+      if (last - imax > 1)
+        stack.emplace_back (imax, last);
+    }
+  }
+  for (size_t i = 0; i < n; i++)
+  {
+    if (marked[i])
+      keep.push_back (i);
+  }
+  return keep.size ();
+}
+
+/*!
+  Simplify a polyline using Visvalingam-Whyatt algorithm.
+
+  \param pts - polyline vertexes
+  \param min_area - minimum effective area of vertexes kept
+  \param keep - indexes of vertexes kept, in ascending order
+  \return number of vertexes kept
+
+  The effective area of a vertex is the area of the triangle it forms with its
+  neighbours. Vertexes are removed in increasing order of their effective
+  area, updating the areas of their neighbours, until all remaining vertexes
+  have an area of at least `min_area`. First and last vertexes are always kept.
+
+  An indexed binary heap keeps the running time at O(n log n).
+*/
+template <typename T>
+size_t visvalingam (std::span<const Point<T>> pts, double min_area, std::vector<size_t>& keep)
+{
+  keep.clear ();
+  size_t n = pts.size ();
+  if (n <= 2)
+  {
+    for (size_t i = 0; i < n; i++)
+      keep.push_back (i);
+    return n;
+  }
+
+  // doubly-linked list of remaining vertexes
+  std::vector<size_t> prev (n), next (n);
+  for (size_t i = 0; i < n; i++)
+  {
+    prev[i] = i - 1;
+    next[i] = i + 1;
+  }
+
+  // binary min-heap of vertexes ordered by area; pos[i] is position of vertex
+  // i in heap. Areas are updated in place so the heap never holds stale entries.
+  std::vector<double> area (n);
+  std::vector<size_t> heap, pos (n);
+  heap.reserve (n - 2);
+  auto sift_up = [&] (size_t k) {
+    size_t v = heap[k];
+    while (k > 0 && area[heap[(k - 1) / 2]] > area[v])
+    {
+      heap[k] = heap[(k - 1) / 2];
+      pos[heap[k]] = k;
+      k = (k - 1) / 2;
+    }
+    heap[k] = v;
+    pos[v] = k;
+  };
+  auto sift_down = [&] (size_t k) {
+    size_t v = heap[k];
+    for (size_t c; (c = 2 * k + 1) < heap.size (); k = c)
+    {
+      if (c + 1 < heap.size () && area[heap[c + 1]] < area[heap[c]])
+        c++;
+      if (area[heap[c]] >= area[v])
+        break;
+      heap[k] = heap[c];
+      pos[heap[k]] = k;
+    }
+    heap[k] = v;
+    pos[v] = k;
+  };
+  auto update = [&] (size_t v, double a) {
+    double old = area[v];
+    area[v] = a;
+    if (a < old)
+      sift_up (pos[v]);
+    else
+      sift_down (pos[v]);
+  };
+
+  for (size_t i = 1; i < n - 1; i++)
+  {
+    area[i] = detail::tri_area (pts[i - 1], pts[i], pts[i + 1]);
+    heap.push_back (i);
+  }
+  for (size_t k = heap.size () / 2; k-- > 0;)
+    sift_down (k);
+
+  while (!heap.empty ())
+  {
+    size_t i = heap[0];
+    double a = area[i];
+    if (a >= min_area)
+      break;
+    heap[0] = heap.back ();
+    heap.pop_back ();
+    if (!heap.empty ())
+      sift_down (0);
+
+    size_t p = prev[i], q = next[i];
+    next[p] = q;
+    prev[q] = p;
+    // neighbours' areas cannot drop below that of the removed vertex
+    if (p > 0)
+      update (p, (std::max) (a, detail::tri_area (pts[prev[p]], pts[p], pts[q])));
+    if (q < n - 1)
+      update (q, (std::max) (a, detail::tri_area (pts[p], pts[q], pts[next[q]])));
+  }
+  for (size_t i = 0; i < n; i = next[i])
+    keep.push_back (i);
+  return keep.size ();
+}
+
+/*!
+  \class OnlineSimplifier
+  \ingroup geom
+  \brief Simplification of a track received one point at a time
+
+  The simplifier uses an opening window algorithm: points after the last key
+  point are kept pending as long as all of them are within the tolerance from
+  the segment joining the last key point and the newest point. When a pending
+  point falls outside the tolerance, the previous point becomes a key point.
+
+  Memory is bounded: when the number of pending points reaches a limit, the
+  previous point is made a key point even if the tolerance is not exceeded.
+  Each point added costs at most O(max_pending) operations.
+
+  Points are identified by their sequence number (0 for the first point
+  added). Each call to add() produces at most one new key point. The caller
+  can keep track attributes, like time or height, of the last couple of points
+  and store them when a key point is reported:
+  \code
+    OnlineSimplifier<double> simp (1e-6);
+    track_point prev_pt, pt;
+    while (get_fix (pt))
+    {
+      if (simp.add (pt.pos))
+        store (simp.key_index () == simp.count () - 1 ? pt : prev_pt);
+      prev_pt = pt;
+    }
+    if (simp.finish ())
+      store (pt);
+  \endcode
+*/
+template <typename T>
+class OnlineSimplifier
+{
+public:
+  /*!
+    Create a simplifier
+    \param tol - maximum distance between removed points and simplified track
+    \param max_pending - maximum number of pending points
+  */
+  OnlineSimplifier (double tol, size_t max_pending = 256)
+    : tol2 (tol * tol)
+    , max_pending ((std::max) (max_pending, (size_t)1))
+    , n (0)
+    , key_idx (SIZE_MAX)
+  {}
+
+  bool add (const Point<T>& p);
+  bool finish ();
+
+  /// Prepare for a new track
+  void clear ()
+  {
+    pending.clear ();
+    n = 0;
+    key_idx = SIZE_MAX;
+  }
+
+  /// Return number of points added
+  size_t count () const
+  {
+    return n;
+  }
+
+  /// Return sequence number of last key point or `SIZE_MAX` if there is none
+  size_t key_index () const
+  {
+    return key_idx;
+  }
+
+  /// Return last key point
+  const Point<T>& key () const
+  {
+    return anchor;
+  }
+
+private:
+  double tol2;
+  size_t max_pending;
+  size_t n;                      // number of points added
+  size_t key_idx;                // sequence number of last key point
+  Point<T> anchor;               // last key point
+  std::vector<Point<T>> pending; // points after last key point
+};
+
+/*!
+  Add a new point to the track.
+
+  \param p - new point
+  \return `true` if a new key point was found
+
+  The first point is always a key point. Afterwards, a new key point is
+  always the point added before `p`. Use key() and key_index() functions to
+  retrieve it.
+*/
+template <typename T>
+bool OnlineSimplifier<T>::add (const Point<T>& p)
+{
+  if (n++ == 0)
+  {
+    anchor = p;
+    key_idx = 0;
+    return true;
+  }
+
+  bool fits = pending.size () < max_pending;
+  for (size_t i = 0; fits && i < pending.size (); i++)
+    fits = detail::seg_dist2 (pending[i], anchor, p) <= tol2;
+
+  if (fits)
+  {
+    pending.push_back (p);
+    return false;
+  }
+  anchor = pending.back ();
+  key_idx = n - 2;
+  pending.clear ();
+  pending.push_back (p);
+  return true;
+}
+
+/*!
+  Finish the track.
+
+  \return `true` if a new key point was found
+
+  The last point added is always a key point. After this function, the
+  simplifier can be reused for a new track only after calling clear().
+*/
+template <typename T>
+bool OnlineSimplifier<T>::finish ()
+{
+  if (pending.empty ())
+    return false;
+  anchor = pending.back ();
+  key_idx = n - 1;
+  pending.clear ();
+  return true;
+}
+
+} // namespace mlib
@@ -17,6 +17,11 @@
 #include <cassert>
 #include <cstring>
 #include <filesystem>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include "safe_winsock.h"
 #include <sqlite3/sqlite3.h>
@@ -190,6 +195,15 @@ public:
     ext_result    = SQLITE_OPEN_EXRESCODE ///< enables extended result codes
   };
 
+  /// Flags for user-defined SQL functions
+  enum class funcflags
+  {
+    none          = 0,                    ///< no special properties
+    deterministic = SQLITE_DETERMINISTIC, ///< same inputs always produce same result
+    directonly    = SQLITE_DIRECTONLY,    ///< cannot be used from triggers or views
+    innocuous     = SQLITE_INNOCUOUS      ///< function has no side effects
+  };
+
   /// Default constructor
   Database ();
 
@@ -256,6 +270,23 @@ public:
   /// Flush
   erc flush ();
 
+  /// Register a C++ callable as an SQL scalar function
+  template <class F>
+  erc create_function (const std::string& name, F&& func,
+                       funcflags flags = funcflags::deterministic);
+
+  /// Register a class as an SQL aggregate function
+  template <class Agg>
+  erc create_aggregate (const std::string& name, funcflags flags = funcflags::deterministic);
+
+  /// Register a class as an SQL aggregate window function
+  template <class Agg>
+  erc create_window_function (const std::string& name,
+                              funcflags flags = funcflags::deterministic);
+
+  /// Remove a user-defined SQL function
+  erc remove_function (const std::string& name, int nargs);
+
   /// Set error facility for all SQLITEPP errors
   inline static void Errors (mlib::errfac& fac)
   {
@@ -272,9 +303,262 @@ private:
   std::shared_ptr<sqlite3> db;
   friend class Query;
 
+  erc register_function (const std::string& name, int nargs, funcflags flags, void* app,
+                         void (*xfunc) (sqlite3_context*, int, sqlite3_value**),
+                         void (*xstep) (sqlite3_context*, int, sqlite3_value**),
+                         void (*xfinal) (sqlite3_context*),
+                         void (*xvalue) (sqlite3_context*),
+                         void (*xinverse) (sqlite3_context*, int, sqlite3_value**),
+                         void (*xdestroy) (void*));
+
   static errfac* sqlite_errors;
 };
 
+/// Helpers for marshalling values between SQLITE and C++ user-defined functions
+namespace sqlfunc {
+
+/// Signature traits of a callable object
+template <class F>
+struct traits : traits<decltype (&std::remove_cvref_t<F>::operator())>
+{};
+
+template <class R, class... A>
+struct traits<R (*) (A...)>
+{
+  using result = R;
+  using args = std::tuple<std::remove_cvref_t<A>...>;
+  static constexpr int arity = sizeof...(A);
+};
+
+template <class R, class... A>
+struct traits<R (A...)> : traits<R (*) (A...)>
+{};
+
+template <class C, class R, class... A>
+struct traits<R (C::*) (A...)> : traits<R (*) (A...)>
+{};
+
+template <class C, class R, class... A>
+struct traits<R (C::*) (A...) const> : traits<R (*) (A...)>
+{};
+
+template <class T>
+struct is_optional : std::false_type
+{};
+
+template <class T>
+struct is_optional<std::optional<T>> : std::true_type
+{};
+
+/// Convert an SQLITE value to a C++ function argument
+template <class T>
+T arg (sqlite3_value* v)
+{
+  if constexpr (is_optional<T>::value)
+  {
+    if (sqlite3_value_type (v) == SQLITE_NULL)
+      return std::nullopt;
+    return arg<typename T::value_type> (v);
+  }
+  else if constexpr (std::is_same_v<T, sqlite3_value*>)
+    return v;
+  else if constexpr (std::is_same_v<T, bool>)
+    return sqlite3_value_int (v) != 0;
+  else if constexpr (std::is_integral_v<T> && sizeof (T) <= sizeof (int))
+    return static_cast<T> (sqlite3_value_int (v));
+  else if constexpr (std::is_integral_v<T>)
+    return static_cast<T> (sqlite3_value_int64 (v));
+  else if constexpr (std::is_floating_point_v<T>)
+    return static_cast<T> (sqlite3_value_double (v));
+  else if constexpr (std::is_same_v<T, const char*>)
+    return reinterpret_cast<const char*> (sqlite3_value_text (v));
+  else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>)
+  {
+    auto txt = reinterpret_cast<const char*> (sqlite3_value_text (v));
+    return txt ? T (txt, sqlite3_value_bytes (v)) : T ();
+  }
+  else
+    static_assert (!sizeof (T), "unsupported argument type");
+}
+
+/// Set the result of an SQL function from a C++ value
+template <class T>
+void result (sqlite3_context* ctx, const T& val)
+{
+  if constexpr (is_optional<T>::value)
+  {
+    if (val)
+      result (ctx, *val);
+    else
+      sqlite3_result_null (ctx);
+  }
+  else if constexpr (std::is_same_v<T, std::nullptr_t>)
+    sqlite3_result_null (ctx);
+  else if constexpr (std::is_same_v<T, bool>)
+    sqlite3_result_int (ctx, val ? 1 : 0);
+  else if constexpr (std::is_integral_v<T> && sizeof (T) <= sizeof (int)
+                     && (std::is_signed_v<T> || sizeof (T) < sizeof (int)))
+    sqlite3_result_int (ctx, static_cast<int> (val)); // all values fit in an int
+  else if constexpr (std::is_integral_v<T>)
+    sqlite3_result_int64 (ctx, static_cast<sqlite3_int64> (val));
+  else if constexpr (std::is_floating_point_v<T>)
+    sqlite3_result_double (ctx, static_cast<double> (val));
+  else if constexpr (std::is_convertible_v<T, std::string_view>)
+  {
+    if constexpr (std::is_pointer_v<T>)
+    {
+      if (!val)
+      {
+        sqlite3_result_null (ctx);
+        return;
+      }
+    }
+    std::string_view sv (val);
+    sqlite3_result_text (ctx, sv.data (), (int)sv.size (), SQLITE_TRANSIENT);
+  }
+  else
+    static_assert (!sizeof (T), "unsupported result type");
+}
+
+/// Call \p f with arguments converted from SQLITE values and set the result
+template <class Sig, class F>
+void invoke (sqlite3_context* ctx, F&& f, sqlite3_value** argv)
+{
+  using args = typename traits<Sig>::args;
+  [&]<size_t... I> (std::index_sequence<I...>) {
+    using R = decltype (f (arg<std::tuple_element_t<I, args>> (argv[I])...));
+    if constexpr (std::is_void_v<R>)
+      f (arg<std::tuple_element_t<I, args>> (argv[I])...); // result stays NULL
+    else
+      result (ctx, f (arg<std::tuple_element_t<I, args>> (argv[I])...));
+  }(std::make_index_sequence<traits<Sig>::arity> ());
+}
+
+/// Report an exception thrown by user code as an SQL error
+inline void error (sqlite3_context* ctx)
+{
+  try
+  {
+    throw;
+  }
+  catch (const erc& e)
+  {
+    auto msg = e.message ();
+    sqlite3_result_error (ctx, msg.empty () ? "error in user function" : msg.c_str (), -1);
+  }
+  catch (const std::bad_alloc&)
+  {
+    sqlite3_result_error_nomem (ctx);
+  }
+  catch (const std::exception& e)
+  {
+    sqlite3_result_error (ctx, e.what (), -1);
+  }
+  catch (...)
+  {
+    sqlite3_result_error (ctx, "unknown exception in user function", -1);
+  }
+}
+
+template <class F>
+void scalar_func (sqlite3_context* ctx, int, sqlite3_value** argv)
+{
+  try
+  {
+    auto f = static_cast<F*> (sqlite3_user_data (ctx));
+    invoke<F> (ctx, *f, argv);
+  }
+  catch (...)
+  {
+    error (ctx);
+  }
+}
+
+template <class T>
+void destroy (void* p)
+{
+  delete static_cast<T*> (p);
+}
+
+/// Return aggregate object for current group, creating it if \p create is `true`
+template <class Agg>
+Agg* instance (sqlite3_context* ctx, bool create)
+{
+  auto pp = static_cast<Agg**> (sqlite3_aggregate_context (ctx, create ? sizeof (Agg*) : 0));
+  if (!pp)
+    return nullptr;
+  if (!*pp && create)
+    *pp = new Agg;
+  return *pp;
+}
+
+template <class Agg>
+void agg_step (sqlite3_context* ctx, int, sqlite3_value** argv)
+{
+  try
+  {
+    auto agg = instance<Agg> (ctx, true);
+    if (!agg)
+      sqlite3_result_error_nomem (ctx);
+    else
+      invoke<decltype (&Agg::step)> (
+        ctx, [agg] (auto&&... a) { agg->step (std::forward<decltype (a)> (a)...); }, argv);
+  }
+  catch (...)
+  {
+    error (ctx);
+  }
+}
+
+template <class Agg>
+void agg_inverse (sqlite3_context* ctx, int, sqlite3_value** argv)
+{
+  try
+  {
+    auto agg = instance<Agg> (ctx, true);
+    if (!agg)
+      sqlite3_result_error_nomem (ctx);
+    else
+      invoke<decltype (&Agg::inverse)> (
+        ctx, [agg] (auto&&... a) { agg->inverse (std::forward<decltype (a)> (a)...); }, argv);
+  }
+  catch (...)
+  {
+    error (ctx);
+  }
+}
+
+template <class Agg>
+void agg_value (sqlite3_context* ctx)
+{
+  try
+  {
+    auto agg = instance<Agg> (ctx, false);
+    if (agg)
+      result (ctx, agg->result ());
+    else
+      result (ctx, Agg ().result ());
+  }
+  catch (...)
+  {
+    error (ctx);
+  }
+}
+
+template <class Agg>
+void agg_final (sqlite3_context* ctx)
+{
+  agg_value<Agg> (ctx);
+  auto pp = static_cast<Agg**> (sqlite3_aggregate_context (ctx, 0));
+  if (pp)
+  {
+    delete *pp;
+    *pp = nullptr;
+  }
+}
+
+} // namespace sqlfunc
+
 
 /*==================== INLINE FUNCTIONS ===========================*/
 inline sqlite3_int64 Database::last_rowid ()
@@ -343,4 +627,87 @@ inline Database::openflags operator| (const Database::openflags& f1, const Datab
   return static_cast<Database::openflags> (static_cast<int> (f1) | static_cast<int> (f2));
 }
 
+/// Bitwise OR operator permits combining function flags
+inline Database::funcflags operator| (const Database::funcflags& f1, const Database::funcflags& f2)
+{
+  return static_cast<Database::funcflags> (static_cast<int> (f1) | static_cast<int> (f2));
+}
+
+/*!
+  \param name  SQL name of the function
+  \param func  function object, lambda or function pointer
+  \param flags function properties
+
+  The number of SQL arguments is the number of arguments of \p func. Arguments
+  and result are converted automatically between SQLITE values and C++ types.
+  Supported types are integral and floating point types, `bool`, `std::string`,
+  `std::string_view` and `const char*`. Wrap a type in `std::optional` to
+  receive or return SQL `NULL` values. A `sqlite3_value*` argument is passed
+  unchanged.
+
+  Any exception thrown by \p func is converted into an SQL error.
+
+  Example:
+\code
+  db.create_function ("half", [] (double x) { return x / 2; });
+  Query q (db, "SELECT half (col) FROM tab");
+\endcode
+*/
+template <class F>
+erc Database::create_function (const std::string& name, F&& func, funcflags flags)
+{
+  using fobj = std::decay_t<F>;
+  auto pf = new fobj (std::forward<F> (func));
+  return register_function (name, sqlfunc::traits<fobj>::arity, flags, pf,
+                            &sqlfunc::scalar_func<fobj>, nullptr, nullptr, nullptr, nullptr,
+                            &sqlfunc::destroy<fobj>);
+}
+
+/*!
+  \param name  SQL name of the function
+  \param flags function properties
+
+  The aggregate class \p Agg must be default constructible and provide
+  two member functions:
+  - `void step (...)` called for each row. Its arguments determine the number
+    and type of SQL arguments.
+  - `R result ()` called to obtain the aggregate value.
+
+  A new \p Agg object is constructed for each group of rows.
+
+  Example:
+\code
+  struct product {
+    double p = 1;
+    void step (double x) { p *= x; }
+    double result () const { return p; }
+  };
+  db.create_aggregate<product> ("product");
+\endcode
+*/
+template <class Agg>
+erc Database::create_aggregate (const std::string& name, funcflags flags)
+{
+  return register_function (name, sqlfunc::traits<decltype (&Agg::step)>::arity, flags, nullptr,
+                            nullptr, &sqlfunc::agg_step<Agg>, &sqlfunc::agg_final<Agg>, nullptr,
+                            nullptr, nullptr);
+}
+
+/*!
+  \param name  SQL name of the function
+  \param flags function properties
+
+  In addition to the requirements for aggregate classes (see create_aggregate()),
+  the class \p Agg must provide a function `void inverse (...)` that removes
+  a row from the current window. Its arguments must match those of the `step`
+  function. The `result` function can be called multiple times.
+*/
+template <class Agg>
+erc Database::create_window_function (const std::string& name, funcflags flags)
+{
+  return register_function (name, sqlfunc::traits<decltype (&Agg::step)>::arity, flags, nullptr,
+                            nullptr, &sqlfunc::agg_step<Agg>, &sqlfunc::agg_final<Agg>,
+                            &sqlfunc::agg_value<Agg>, &sqlfunc::agg_inverse<Agg>, nullptr);
+}
+
 }; // namespace mlib
@@ -0,0 +1,71 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+///   \file sqlrtree.h Spatial index for SQLITE tables using R*Tree virtual tables
+
+#pragma once
+
+#if __has_include("defs.h")
+#include "defs.h"
+#endif
+
+#include "sqlitepp.h"
+#include "border.h"
+
+#include <string>
+#include <vector>
+
+namespace mlib {
+
+/// R*Tree spatial index attached to an SQLITE data table
+class RTree
+{
+public:
+  /// Index for a table of points
+  RTree (Database& db, const std::string& table, const std::string& x = "x",
+         const std::string& y = "y");
+
+  /// Index for a table of bounding boxes
+  RTree (Database& db, const std::string& table, const std::string& xmin,
+         const std::string& xmax, const std::string& ymin, const std::string& ymax);
+
+  /// Create index table and maintenance triggers
+  erc create ();
+
+  /// Repopulate index table from data table
+  erc rebuild ();
+
+  /// Remove index table and maintenance triggers
+  erc drop ();
+
+  /// Return rows whose bounding box intersects a rectangle
+  Query query (const dpoint& ll, const dpoint& ur);
+
+  /// Return rows whose bounding box intersects the bounding box of a border
+  Query query (const Border& b);
+
+  /// Return rowids of all points inside a border
+  std::vector<sqlite3_int64> inside (const Border& b);
+
+  /// Return name of index table
+  const std::string& name () const
+  {
+    return index;
+  }
+
+  /// Return `true` if index is for a table of points
+  bool points () const
+  {
+    return xmin == xmax && ymin == ymax;
+  }
+
+private:
+  Database& db;
+  std::string table;
+  std::string index;
+  std::string xmin, xmax, ymin, ymax;
+};
+
+} // namespace mlib
@@ -0,0 +1,202 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+///  \file track.h Compact binary storage of GNSS tracks
+
+#pragma once
+
+#if __has_include("defs.h")
+#include "defs.h"
+#endif
+
+#include "errorcode.h"
+#include "mapfile.h"
+#include "point.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mlib {
+
+/// One point of a GNSS track
+struct track_point
+{
+  double time;         ///< time (seconds)
+  Point<double> pos;   ///< position (usually longitude and latitude in radians)
+  double height;       ///< height (meters)
+  int quality;         ///< fix quality (0 to 255)
+  int sat;             ///< number of satellites (0 to 255)
+};
+
+/// Resolution of fixed-point values stored in a track file
+struct track_resolution
+{
+  double time = 1e-3;   ///< time resolution (seconds)
+  double pos = 1e-10;   ///< position resolution (about 0.6 mm for angles in radians)
+  double height = 1e-3; ///< height resolution (meters)
+};
+
+/// Appends points to a binary track file
+class track_writer
+{
+public:
+  track_writer ();
+  ~track_writer ();
+
+  /// Open or create a track file
+  erc open (const std::string& fname, const track_resolution& res = track_resolution{},
+            size_t block_points = 1024);
+
+  /// Add a point at the end of track
+  erc append (const track_point& pt);
+
+  /// Write all buffered points to file
+  erc flush ();
+
+  /// Flush buffered points and close file
+  erc close ();
+
+  /// Return resolution of track file
+  const track_resolution& resolution () const
+  {
+    return res;
+  }
+
+private:
+  void encode (const track_point& pt);
+
+  FILE* f;
+  track_resolution res;
+  size_t block_points;
+  std::vector<uint8_t> buf; // encoded points of current block
+  uint32_t count;           // points in current block
+  double t_first, t_last;   // time range of current block
+  double last_time;         // time of last appended point
+  int64_t prev[4], delta[3]; // predictor state
+  int prev_quality, prev_sat;
+};
+
+/// Memory-mapped reader of a binary track file
+class track_reader
+{
+public:
+  /// Summary of one block of points
+  struct block
+  {
+    const uint8_t* data; ///< encoded points
+    const uint8_t* end;  ///< end of encoded points
+    size_t count;        ///< number of points
+    size_t first;        ///< index of first point in track
+    double t_first;      ///< time of first point
+    double t_last;       ///< time of last point
+  };
+
+  /// Iterator decoding points directly from the file mapping
+  class iterator
+  {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = track_point;
+    using difference_type = ptrdiff_t;
+    using pointer = const track_point*;
+    using reference = const track_point&;
+
+    iterator ()
+      : rdr (nullptr)
+      , blk (0)
+      , idx (0)
+    {}
+
+    reference operator* () const
+    {
+      return pt;
+    }
+    pointer operator->() const
+    {
+      return &pt;
+    }
+    iterator& operator++ ();
+    iterator operator++ (int);
+
+    bool operator== (const iterator& other) const
+    {
+      return blk == other.blk && idx == other.idx;
+    }
+
+  private:
+    iterator (const track_reader* r, size_t b);
+    void decode ();
+
+    const track_reader* rdr;
+    size_t blk;        // current block
+    size_t idx;        // index of current point in block
+    const uint8_t* p;  // decoding position
+    int64_t prev[4], delta[3];
+    track_point pt;
+
+    friend class track_reader;
+  };
+
+  track_reader ();
+  ~track_reader ();
+
+  /// Open a track file
+  erc open (const std::string& fname);
+
+  /// Close track file
+  void close ();
+
+  /// Return number of points
+  size_t size () const
+  {
+    return npoints;
+  }
+
+  /// Return iterator to first point
+  iterator begin () const
+  {
+    return iterator (this, 0);
+  }
+
+  /// Return iterator past last point
+  iterator end () const
+  {
+    return iterator (this, blocks.size ());
+  }
+
+  /// Return iterator to first point with time not before `t`
+  iterator lower_bound (double t) const;
+
+  /// Return sparse index of track
+  const std::vector<block>& index () const
+  {
+    return blocks;
+  }
+
+  /// Return resolution of track file
+  const track_resolution& resolution () const
+  {
+    return res;
+  }
+
+private:
+  std::unique_ptr<mapped_file> mf;
+  track_resolution res;
+  std::vector<block> blocks;
+  size_t npoints;
+};
+
+/// Iterator to the point after the current one
+inline track_reader::iterator track_reader::iterator::operator++ (int)
+{
+  iterator tmp = *this;
+  ++*this;
+  return tmp;
+}
+
+} // namespace mlib
@@ -0,0 +1,518 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <algorithm>
+#include <limits>
+#include <string.h>
+
+namespace mlib::ais {
+
+/*!
+  \defgroup AIS AIS Messages
+  \brief Decoding of AIS messages
+
+  AIS messages are transported in NMEA-0183 `!AIVDM` (messages received from
+  other stations) and `!AIVDO` (own station messages) sentences. Message bits
+  are encoded as 6-bit ASCII characters and longer messages are split into
+  multiple sentences (fragments).
+
+  ais::decoder reassembles the fragments and converts the message to one of
+  the message structures. The bits of a message are held in an ais::payload
+  object that de-armors a whole character at a time and extracts fields with
+  64-bit word operations.
+
+  Reference: [AIVDM/AIVDO protocol decoding](https://gpsd.gitlab.io/gpsd/AIVDM.html)
+ @{
+*/
+
+static const double NaN = std::numeric_limits<double>::quiet_NaN ();
+
+/// Convert a 6-bit field to an armored character
+char armored_bitstream::encode (unsigned char bits)
+{
+  bits &= 0x3f;
+  return (char)(bits < 40 ? bits + 48 : bits + 56);
+}
+
+/*
+  Convert an armored character to a 6-bit value. Valid characters are '0' to
+  'W' and '`' to 'w'. Returns a value larger than 63 for invalid characters.
+*/
+static inline unsigned int dearmor (char chr)
+{
+  unsigned int v = (unsigned char)chr - 48;
+  if (v >= 40)
+    v = (v >= 48 && v < 72) ? v - 8 : 64;
+  return v;
+}
+
+/*!
+  Convert an armored character to a 6-bit field.
+
+  If the character is not a valid armored character, the function sets the
+  `failbit` of the stream and returns 0.
+*/
+unsigned char armored_bitstream::decode (char chr)
+{
+  unsigned int v = dearmor (chr);
+  if (v > 63)
+  {
+    s.setstate (std::ios::failbit);
+    return 0;
+  }
+  return (unsigned char)v;
+}
+
+payload::payload ()
+{
+  clear ();
+}
+
+void payload::clear ()
+{
+  memset (bits, 0, sizeof (bits));
+  nbits = 0;
+}
+
+/*!
+  \param armored  armored characters
+  \param fill     number of fill bits at the end of data
+  \return `false` if data contains invalid characters or it is too long. In
+          this case the payload is not modified.
+
+  Each character is converted to a 6-bit value that is stored with a single
+  shift and two byte writes.
+*/
+bool payload::append (std::string_view armored, int fill)
+{
+  size_t pos = nbits;
+  if (pos + 6 * armored.size () > max_bits || fill < 0 || fill > 5)
+    return false;
+  for (auto c : armored)
+  {
+    unsigned int v = dearmor (c);
+    if (v > 63)
+    {
+      // clear bits already written
+      bits[nbits >> 3] &= (uint8_t)(0xff00 >> (nbits & 7));
+      memset (bits + (nbits >> 3) + 1, 0, (pos >> 3) + 1 - (nbits >> 3));
+      return false;
+    }
+    unsigned int w = v << (10 - (pos & 7)); // 6 bits aligned in a 16-bit window
+    bits[pos >> 3] |= (uint8_t)(w >> 8);
+    bits[(pos >> 3) + 1] |= (uint8_t)w;
+    pos += 6;
+  }
+  nbits = (pos >= (size_t)fill) ? pos - fill : 0;
+  return true;
+}
+
+/*!
+  \param start  position of first bit
+  \param len    number of bits (1 to 32)
+*/
+uint32_t payload::get (size_t start, size_t len) const
+{
+  if (start + len > max_bits)
+    return 0;
+  const uint8_t* p = bits + (start >> 3);
+  uint64_t w = 0;
+  for (int i = 0; i < 8; i++)
+    w = (w << 8) | p[i];
+  w <<= (start & 7);
+  return (uint32_t)(w >> (64 - len));
+}
+
+/*!
+  \param start  position of first bit
+  \param len    number of bits (1 to 32)
+
+  Field is interpreted as a two's complement number.
+*/
+int32_t payload::sget (size_t start, size_t len) const
+{
+  uint32_t v = get (start, len);
+  if (len < 32 && (v & (1u << (len - 1))))
+    v |= ~0u << len;
+  return (int32_t)v;
+}
+
+/*!
+  \param start  position of first bit
+  \param nchars number of 6-bit characters
+  \param str    output string. Must have space for `nchars+1` characters.
+
+  Text ends at the first '@' character. Trailing spaces are removed.
+*/
+void payload::text (size_t start, size_t nchars, char* str) const
+{
+  static const char sixbit[] =
+    "@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_ !\"#$%&'()*+,-./0123456789:;<=>?";
+  size_t n = 0;
+  for (; n < nchars && start + 6 <= nbits; n++, start += 6)
+  {
+    char c = sixbit[get (start, 6)];
+    if (c == '@')
+      break;
+    str[n] = c;
+  }
+  while (n && str[n - 1] == ' ')
+    n--;
+  str[n] = 0;
+}
+
+// Latitude or longitude in 1/10000 minutes to radians
+static double position (int32_t v, int32_t not_available)
+{
+  return (v == not_available) ? NaN : v / 600000. * D2R;
+}
+
+// Speed in 1/10 knots
+static double speed (uint32_t v)
+{
+  return (v == 1023) ? NaN : v / 10.;
+}
+
+// Course in 1/10 degrees
+static double course (uint32_t v)
+{
+  return (v == 3600) ? NaN : v / 10. * D2R;
+}
+
+// Heading in degrees
+static double heading (uint32_t v)
+{
+  return (v == 511) ? NaN : v * D2R;
+}
+
+static void dims (const payload& p, size_t start, dimensions& d)
+{
+  d.to_bow = p.get (start, 9);
+  d.to_stern = p.get (start + 9, 9);
+  d.to_port = p.get (start + 18, 6);
+  d.to_starboard = p.get (start + 24, 6);
+}
+
+template <class M>
+static M make (const payload& p)
+{
+  M m{};
+  m.type = p.get (0, 6);
+  m.repeat = p.get (6, 2);
+  m.mmsi = p.get (8, 30);
+  return m;
+}
+
+/*!
+  Message types 1, 2, 3, 4, 5, 18, 19, 21 and 24 are decoded. Type 11 (UTC
+  and date response) has the same layout as type 4 and is also decoded as a
+  base_station record.
+
+  \return message structure or `std::monostate` if message type is not
+  supported or message is too short.
+*/
+message decode (const payload& p)
+{
+  if (p.size () < 38)
+    return {};
+
+  switch (p.get (0, 6))
+  {
+  case 1:
+  case 2:
+  case 3:
+  {
+    if (p.size () < 168)
+      break;
+    auto m = make<position_report> (p);
+    m.status = p.get (38, 4);
+    m.rot = p.sget (42, 8);
+    m.sog = speed (p.get (50, 10));
+    m.accuracy = p.get (60, 1);
+    m.lon = position (p.sget (61, 28), 181 * 600000);
+    m.lat = position (p.sget (89, 27), 91 * 600000);
+    m.cog = course (p.get (116, 12));
+    m.heading = heading (p.get (128, 9));
+    m.second = p.get (137, 6);
+    m.maneuver = p.get (143, 2);
+    m.raim = p.get (148, 1);
+    return m;
+  }
+
+  case 4:
+  case 11:
+  {
+    if (p.size () < 168)
+      break;
+    auto m = make<base_station> (p);
+    m.year = p.get (38, 14);
+    m.month = p.get (52, 4);
+    m.day = p.get (56, 5);
+    m.hour = p.get (61, 5);
+    m.minute = p.get (66, 6);
+    m.second = p.get (72, 6);
+    m.accuracy = p.get (78, 1);
+    m.lon = position (p.sget (79, 28), 181 * 600000);
+    m.lat = position (p.sget (107, 27), 91 * 600000);
+    m.epfd = p.get (134, 4);
+    m.raim = p.get (148, 1);
+    return m;
+  }
+
+  case 5:
+  {
+    if (p.size () < 420) // some transmitters drop the last 2 bits
+      break;
+    auto m = make<static_voyage> (p);
+    m.ais_version = p.get (38, 2);
+    m.imo = p.get (40, 30);
+    p.text (70, 7, m.callsign);
+    p.text (112, 20, m.name);
+    m.shiptype = p.get (232, 8);
+    dims (p, 240, m.dim);
+    m.epfd = p.get (270, 4);
+    m.month = p.get (274, 4);
+    m.day = p.get (278, 5);
+    m.hour = p.get (283, 5);
+    m.minute = p.get (288, 6);
+    m.draught = p.get (294, 8) / 10.;
+    p.text (302, 20, m.destination);
+    m.dte = p.get (422, 1);
+    return m;
+  }
+
+  case 18:
+  {
+    if (p.size () < 168)
+      break;
+    auto m = make<class_b_position> (p);
+    m.sog = speed (p.get (46, 10));
+    m.accuracy = p.get (56, 1);
+    m.lon = position (p.sget (57, 28), 181 * 600000);
+    m.lat = position (p.sget (85, 27), 91 * 600000);
+    m.cog = course (p.get (112, 12));
+    m.heading = heading (p.get (124, 9));
+    m.second = p.get (133, 6);
+    m.cs = p.get (141, 1);
+    m.raim = p.get (147, 1);
+    return m;
+  }
+
+  case 19:
+  {
+    if (p.size () < 312)
+      break;
+    auto m = make<class_b_extended> (p);
+    m.sog = speed (p.get (46, 10));
+    m.accuracy = p.get (56, 1);
+    m.lon = position (p.sget (57, 28), 181 * 600000);
+    m.lat = position (p.sget (85, 27), 91 * 600000);
+    m.cog = course (p.get (112, 12));
+    m.heading = heading (p.get (124, 9));
+    m.second = p.get (133, 6);
+    p.text (143, 20, m.name);
+    m.shiptype = p.get (263, 8);
+    dims (p, 271, m.dim);
+    m.epfd = p.get (301, 4);
+    m.raim = p.get (305, 1);
+    return m;
+  }
+
+  case 21:
+  {
+    if (p.size () < 272)
+      break;
+    auto m = make<aid_to_navigation> (p);
+    m.aid_type = p.get (38, 5);
+    p.text (43, 20, m.name);
+    m.accuracy = p.get (163, 1);
+    m.lon = position (p.sget (164, 28), 181 * 600000);
+    m.lat = position (p.sget (192, 27), 91 * 600000);
+    dims (p, 219, m.dim);
+    m.epfd = p.get (249, 4);
+    m.second = p.get (253, 6);
+    m.off_position = p.get (259, 1);
+    m.raim = p.get (268, 1);
+    m.virtual_aid = p.get (269, 1);
+    if (strlen (m.name) == 20 && p.size () >= 278)
+      p.text (272, std::min<size_t> ((p.size () - 272) / 6, 14), m.name + 20); // name extension
+    return m;
+  }
+
+  case 24:
+  {
+    if (p.size () < 160)
+      break;
+    auto m = make<static_data> (p);
+    m.part = p.get (38, 2);
+    if (m.part == 0)
+      p.text (40, 20, m.name);
+    else if (m.part == 1 && p.size () >= 162)
+    {
+      m.shiptype = p.get (40, 8);
+      p.text (48, 3, m.vendor);
+      m.model = p.get (66, 4);
+      m.serial = p.get (70, 20);
+      p.text (90, 7, m.callsign);
+      if (m.mmsi / 10000000 == 98) // auxiliary craft
+        m.mothership = p.get (132, 30);
+      else
+        dims (p, 132, m.dim);
+    }
+    else
+      break;
+    return m;
+  }
+  }
+  return {};
+}
+
+/*!
+  \class decoder
+
+  The decoder accepts !AIVDM and !AIVDO sentences from any talker. Single
+  fragment messages are decoded immediately. Multi-fragment messages are
+  assembled using the sequential message ID. If a fragment is missing, the
+  incomplete message is discarded.
+
+  Sentence checksum is not verified. Use nmea::framer or nmea::checksum() to
+  validate sentences.
+
+  Example:
+\code
+  ais::decoder dec;
+  nmea::framer fr;
+  ...
+  while (fr.next (sentence))
+  {
+    auto msg = dec.add (sentence.data ());
+    if (auto pos = std::get_if<ais::position_report> (&msg))
+      update_target (pos->mmsi, pos->lat, pos->lon);
+  }
+\endcode
+*/
+
+decoder::decoder ()
+  : own_ship (false)
+  , st{}
+{
+  for (auto& s : slot)
+    s.next = 0;
+}
+
+// Return next comma separated field of sentence
+static std::string_view field (const char*& ptr)
+{
+  const char* start = ptr;
+  while (*ptr && *ptr != ',' && *ptr != '*' && *ptr != '\r' && *ptr != '\n')
+    ptr++;
+  std::string_view f (start, ptr - start);
+  if (*ptr == ',')
+    ptr++;
+  return f;
+}
+
+/*!
+  \param sentence a !AIVDM or !AIVDO sentence
+  \return decoded message or `std::monostate` if the message is not
+          complete, not supported or invalid.
+*/
+message decoder::add (const char* sentence)
+{
+  const char* ptr = sentence;
+  auto f = field (ptr);
+  if (f.size () != 6 || f[0] != '!' || f[3] != 'V' || f[4] != 'D'
+      || (f[5] != 'M' && f[5] != 'O'))
+  {
+    st.invalid++;
+    return {};
+  }
+  bool own = (f[5] == 'O');
+
+  auto fcount = field (ptr);
+  auto fnum = field (ptr);
+  auto fseq = field (ptr);
+  auto fchan = field (ptr);
+  auto data = field (ptr);
+  auto ffill = field (ptr);
+  if (fcount.size () != 1 || fnum.size () != 1 || fseq.size () > 1 || ffill.size () != 1)
+  {
+    st.invalid++;
+    return {};
+  }
+  int count = fcount[0] - '0', num = fnum[0] - '0', fill = ffill[0] - '0';
+  if (count < 1 || count > 9 || num < 1 || num > count)
+  {
+    st.invalid++;
+    return {};
+  }
+  st.fragments++;
+
+  payload single;
+  const payload* complete = nullptr;
+  if (count == 1)
+  {
+    if (!single.append (data, fill))
+    {
+      st.invalid++;
+      return {};
+    }
+    complete = &single;
+  }
+  else
+  {
+    if (fseq.empty () || fseq[0] < '0' || fseq[0] > '9')
+    {
+      st.invalid++;
+      return {};
+    }
+    auto& s = slot[fseq[0] - '0'];
+    char chan = fchan.empty () ? 0 : fchan[0];
+    if (num == 1)
+    {
+      if (s.next)
+        st.incomplete++; // previous message was not finished
+      s.bits.clear ();
+      s.count = count;
+      s.next = 1;
+      s.channel = chan;
+    }
+    else if (s.next != num || s.count != count || s.channel != chan)
+    {
+      if (s.next)
+        st.incomplete++;
+      s.next = 0;
+      return {};
+    }
+    if (!s.bits.append (data, num == count ? fill : 0))
+    {
+      st.invalid++;
+      s.next = 0;
+      return {};
+    }
+    if (num < count)
+    {
+      s.next++;
+      return {};
+    }
+    s.next = 0;
+    complete = &s.bits;
+  }
+
+  own_ship = own;
+  auto m = decode (*complete);
+  if (m.index () == 0)
+    st.invalid++;
+  else
+    st.messages++;
+  return m;
+}
+
+///@}
+
+} // namespace mlib::ais
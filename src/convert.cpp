@@ -17,9 +17,25 @@
 */
 namespace mlib {
 
-static double inline pow10 (int x)
+static const uint64_t int_pow10[] = {1ULL,         10ULL,         100ULL,       1000ULL,
+                                     10000ULL,     100000ULL,     1000000ULL,   10000000ULL,
+                                     100000000ULL, 1000000000ULL};
+
+// Append an unsigned integer zero-padded to the given width
+static char* put_uint (char* p, uint64_t val, int width)
 {
-  return ipow (10., x);
+  char digits[20];
+  int n = 0;
+  do
+  {
+    digits[n++] = '0' + val % 10;
+    val /= 10;
+  } while (val);
+  while (width-- > n)
+    *p++ = '0';
+  while (n)
+    *p++ = digits[--n];
+  return p;
 }
 
 /// safe replacement for sprintf to a string
@@ -65,49 +81,127 @@ double deg_reduce (double value)
    In the above formats, `H` is the hemisphere which can be one of `N` or `S`
    if \p latitude parameter is \b true. Otherwise it is one of `E` or `W`.
 
+   The function returns an empty string if value cannot be converted.
    \ingroup convert
 */
 std::string degtoa (double degrees, deg_fmt format, bool latitude, int precision)
 {
-  std::string str;
-  char sign;
-  int deg_width, width;
+  char buf[64];
+  auto [ptr, ec] = degtoa (buf, buf + sizeof (buf), degrees, format, latitude, precision);
+  return (ec == std::errc ()) ? std::string (buf, ptr) : std::string ();
+}
 
-  width = precision + 3;
-  if (latitude)
-  {
-    sign = (char)((degrees >= 0.) ? 'N' : 'S');
-    deg_width = 2;
-  }
-  else
-  {
-    sign = (char)((degrees >= 0.) ? 'E' : 'W');
-    deg_width = 3;
-  }
+/*!
+  \param first beginning of output buffer
+  \param last end of output buffer
+  \param degrees value to convert in decimal degrees
+  \param format formatting flags
+  \param latitude true if value is a latitude value
+  \param precision number of decimal places for fractional part (0 to 9)
+  \return pointer past the last character written and error code
+
+  This is a variant of degtoa() function that doesn't allocate memory and it is
+  independent of the current locale. Output format is the same, but the
+  result is not null-terminated. Like `std::to_chars`, it returns
+  `std::errc::value_too_large` if the buffer is too small and
+  `std::errc::invalid_argument` if the value is not finite. In case of error,
+  the returned pointer is \p last.
+
+  The value is rounded to an integer number of the smallest unit shown
+  (degrees, minutes or seconds), so that rounding carries into the
+  larger units.
+  \ingroup convert
+*/
+std::to_chars_result degtoa (char* first, char* last, double degrees, deg_fmt format,
+                             bool latitude, int precision)
+{
+  if (!isfinite (degrees))
+    return {last, std::errc::invalid_argument};
+  precision = std::clamp (precision, 0, 9);
+  char hemi = latitude ? ((degrees >= 0.) ? 'N' : 'S') : ((degrees >= 0.) ? 'E' : 'W');
+  int deg_width = latitude ? 2 : 3;
+  double units = fabs (degrees) * int_pow10[precision];
+  if (format == deg_fmt::seconds)
+    units *= 3600.;
+  else if (format == deg_fmt::minutes)
+    units *= 60.;
+  if (!(units < 1e18))
+    return {last, std::errc::value_too_large};
 
-  degrees = fabs (degrees);
+  uint64_t n = (uint64_t)llround (units);
+  uint64_t frac = n % int_pow10[precision];
+  n /= int_pow10[precision];
+
+  char buf[64];
+  char* p = buf;
+  auto put_frac = [&] () {
+    if (precision)
+    {
+      *p++ = '.';
+      p = put_uint (p, frac, precision);
+    }
+  };
   if (format == deg_fmt::seconds)
   {
-    double dd, mm;
-    degrees = modf (modf (degrees + .5 * pow10 (-precision - 1) / 3600., &dd) * 60., &mm) * 60.;
-    strprintf (str, u8"%0*.0lf°%02.0lf'%0*.*lf\"%c", deg_width, dd, mm, width, precision, degrees,
-               sign);
+    p = put_uint (p, n / 3600, deg_width);
+    p = std::copy_n (u8"°", 2, p);
+    p = put_uint (p, n / 60 % 60, 2);
+    *p++ = '\'';
+    p = put_uint (p, n % 60, 2);
+    put_frac ();
+    *p++ = '"';
   }
   else if (format == deg_fmt::minutes)
   {
-    double dd;
-    degrees = modf (degrees + .5 * pow10 (-precision - 1) / 60., &dd) * 60.;
-    strprintf (str, u8"%0*.lf°%0*.*lf\'%c", deg_width, dd, width, precision, degrees,
-               sign);
+    p = put_uint (p, n / 60, deg_width);
+    p = std::copy_n (u8"°", 2, p);
+    p = put_uint (p, n % 60, 2);
+    put_frac ();
+    *p++ = '\'';
   }
   else
   {
-    width = deg_width + precision + 1;
-    strprintf (str, u8"%0*.*lf°%c", width, precision,
-               degrees + .5 * pow10 (-precision - 1), sign);
+    p = put_uint (p, n, deg_width);
+    put_frac ();
+    p = std::copy_n (u8"°", 2, p);
   }
+  *p++ = hemi;
 
-  return str;
+  if (last - first < p - buf)
+    return {last, std::errc::value_too_large};
+  return {std::copy (buf, p, first), std::errc ()};
+}
+
+/*!
+  \param first beginning of output buffer
+  \param last end of output buffer
+  \param degrees values to convert in decimal degrees
+  \param format formatting flags
+  \param latitude true if values are latitude values
+  \param precision number of decimal places for fractional part (0 to 9)
+  \param sep separator character written after each value
+  \return pointer past the last character written and error code
+
+  Each value is formatted like in degtoa() function and followed by the
+  separator. In case of error, conversion stops and the returned pointer
+  points after the last value successfully converted. If the error is
+  `std::errc::value_too_large`, conversion can be resumed with a new buffer.
+  \ingroup convert
+*/
+std::to_chars_result degtoa (char* first, char* last, std::span<const double> degrees,
+                             deg_fmt format, bool latitude, int precision, char sep)
+{
+  for (double d : degrees)
+  {
+    auto [ptr, ec] = degtoa (first, last, d, format, latitude, precision);
+    if (ec == std::errc () && ptr == last)
+      ec = std::errc::value_too_large; // no room for separator
+    if (ec != std::errc ())
+      return {first, ec};
+    *ptr++ = sep;
+    first = ptr;
+  }
+  return {first, std::errc ()};
 }
 
 /*!
@@ -121,50 +215,137 @@ std::string degtoa (double degrees, deg_fmt format, bool latitude, int precision
   - 130.56789W
   - 85°30.45678N
 
+  The function returns 0 if the string cannot be converted.
   \ingroup convert
 */
 double atodeg (const std::string& str)
 {
-  int mm;
-  double val, ss;
-  char* ptrm;
+  double val = 0;
+  atodeg (str.data (), str.data () + str.size (), val);
+  return val;
+}
 
-  if (str.empty ())
-    return 0;
+/*!
+  \param first beginning of input buffer
+  \param last end of input buffer
+  \param degrees converted value in decimal degrees
+  \return pointer past the last character parsed and error code
 
-  const char* cstr = str.c_str ();
+  This is a variant of atodeg() function that doesn't allocate memory and it is
+  independent of the current locale. It accepts the same formats, including
+  those produced by degtoa() function. Like `std::from_chars` it returns
+  `std::errc::invalid_argument` if there is no number at the beginning of the
+  buffer. In this case, \p degrees is not modified.
 
-  int dd = (int)strtol (cstr, &ptrm, 10);
-  int sign = (dd < 0) ? -1 : 1;
-  dd = ::abs (dd);
+  Blanks (spaces or tabs) before the numbers and before the hemisphere letter
+  (`N`, `S`, `E` or `W`) are ignored. Parsing stops after the hemisphere
+  letter and any blanks following it.
+  \ingroup convert
+*/
+std::from_chars_result atodeg (const char* first, const char* last, double& degrees)
+{
+  auto skip_blanks = [last] (const char* p) {
+    while (p < last && (*p == ' ' || *p == '\t'))
+      p++;
+    return p;
+  };
+  const char* p = skip_blanks (first);
+  if (p < last && *p == '+')
+    p++;
+  double dd, mm, ss;
+  auto r = std::from_chars (p, last, dd);
+  if (r.ec != std::errc ())
+    return {first, std::errc::invalid_argument};
+  p = r.ptr;
+  bool neg = signbit (dd);
+  double val = fabs (dd);
 
-  if (toupper (*ptrm) == 'D' || utf8::rune (ptrm) == U'°')
+  bool deg_mark = false;
+  if (p < last && (*p == 'D' || *p == 'd'))
   {
-    utf8::next (ptrm);
-    char* ptrs;
-    mm = (int)strtol (ptrm, &ptrs, 10);
-    if (*ptrs == '\'' || toupper (*ptrs) == 'M')
-    {
-      ptrs++;
-      ss = atof (ptrs);
-      val = dd + mm / 60. + ss / 3600.;
-    }
-    else if (*ptrs == '.')
+    p++;
+    deg_mark = true;
+  }
+  else if (last - p >= 2 && p[0] == '\xC2' && p[1] == '\xB0') // UTF-8 degrees sign
+  {
+    p += 2;
+    deg_mark = true;
+  }
+  if (deg_mark && (r = std::from_chars (skip_blanks (p), last, mm)).ec == std::errc ())
+  {
+    p = r.ptr;
+    if (p < last && (*p == '\'' || *p == 'M' || *p == 'm'))
     {
-      ss = atof (ptrm);
-      val = dd + ss / 60.;
+      p++;
+      if ((r = std::from_chars (skip_blanks (p), last, ss)).ec == std::errc ())
+      {
+        p = r.ptr;
+        val = val + mm / 60. + ss / 3600.;
+        if (p < last && *p == '"')
+          p++;
+      }
+      else
+        val = val + mm / 60.;
     }
     else
-      val = dd + mm / 60.;
+      val = val + mm / 60.;
   }
-  else if (*ptrm == '.')
-    val = ::abs (stof (str));
-  else
-    val = dd;
-  if (val != 0. && (str.find ('S') != std::string::npos || str.find ('W') != std::string::npos))
-    val = -val;
 
-  return val * sign;
+  p = skip_blanks (p);
+  if (p < last)
+  {
+    char h = (*p >= 'a' && *p <= 'z') ? *p - 'a' + 'A' : *p;
+    if (h == 'S' || h == 'W')
+      neg = !neg;
+    if (h == 'N' || h == 'S' || h == 'E' || h == 'W')
+      p = skip_blanks (p + 1);
+  }
+  degrees = (neg && val != 0.) ? -val : val;
+  return {p, std::errc ()};
+}
+
+/*!
+  \param first beginning of input buffer
+  \param last end of input buffer
+  \param degrees converted values
+  \param sep separator character between values
+  \return number of values converted
+
+  The buffer contains fields separated by \p sep character, like the output
+  of the array version of degtoa(). Each field is converted using the
+  atodeg() function. Fields that cannot be converted produce a NaN value.
+
+  Conversion stops when all the fields have been converted or the output
+  span is full. An empty field at the end of buffer is ignored.
+
+  Unless the separator is a character that can be part of a value, fields are
+  parsed in place and the end of field is searched only if there are
+  unparsed characters left in it.
+  \ingroup convert
+*/
+size_t atodeg (const char* first, const char* last, std::span<double> degrees, char sep)
+{
+  // separators that atodeg() could mistake for a part of the value
+  bool in_value = (sep >= '0' && sep <= '9') || (sep >= 'A' && sep <= 'Z')
+                  || (sep >= 'a' && sep <= 'z') || (sep & 0x80) || !sep
+                  || strchr (" \t+-.'\"", sep);
+  size_t n = 0;
+  while (first < last && n < degrees.size ())
+  {
+    const char* end = in_value ? std::find (first, last, sep) : last;
+    auto r = atodeg (first, end, degrees[n]);
+    const char* p = r.ptr;
+    if (r.ec != std::errc ())
+    {
+      degrees[n] = NAN;
+      p = first;
+    }
+    if (p == end || *p != sep)
+      p = std::find (p, last, sep);
+    n++;
+    first = (p < last) ? p + 1 : last;
+  }
+  return n;
 }
 
 } // namespace mlib
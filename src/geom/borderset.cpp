@@ -0,0 +1,557 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+#include <mlib/mlib.h>
+#pragma hdrstop
+#include <algorithm>
+#include <math.h>
+#include <thread>
+
+namespace mlib {
+
+/*!
+  \class BorderSet
+  \ingroup geom
+  \brief A collection of borders that can quickly find all borders containing
+  a point.
+
+  The bounding boxes of borders are kept in an R-tree (A. Guttman, "R-trees:
+  a dynamic index structure for spatial searching", 1984) with quadratic node
+  splitting. A query descends only in the nodes whose bounding box contains
+  the point and calls Border::inside() only for the borders whose bounding box
+  contains the point. For typical sets of borders the cost of a query grows
+  with the logarithm of the number of borders.
+
+  The "inside" region of a hole border extends to infinity. These borders are
+  not kept in the R-tree and are checked by every query.
+
+  Each border is identified by the number returned by insert(). Identifiers
+  of removed borders are reused.
+*/
+
+// Area of a box
+static inline double area (double xmin, double ymin, double xmax, double ymax)
+{
+  return (xmax - xmin) * (ymax - ymin);
+}
+
+/// Create an empty set
+BorderSet::BorderSet ()
+  : root (none)
+  , count (0)
+{}
+
+/*!
+  Add a border to the set.
+
+  \param b - border to add
+  \return identifier of border
+
+  The border is copied (or moved) in the set.
+*/
+size_t BorderSet::insert (Border b)
+{
+  size_t id;
+  if (!free_ids.empty ())
+  {
+    id = free_ids.back ();
+    free_ids.pop_back ();
+    borders[id] = std::move (b);
+  }
+  else
+  {
+    id = borders.size ();
+    borders.push_back (std::move (b));
+    boxes.emplace_back ();
+    used.push_back (false);
+  }
+  used[id] = true;
+  count++;
+
+  const Border& bd = borders[id];
+  dpoint ll, ur;
+  if (bd.hole ())
+    unbounded.push_back (id);
+  else if (bd.bbox (ll, ur))
+  {
+    boxes[id] = {ll.x, ll.y, ur.x, ur.y};
+    insert_entry (boxes[id], (uint32_t)id);
+  }
+  // an empty border that is not a hole doesn't contain any point
+  return id;
+}
+
+/*!
+  Remove a border from the set.
+
+  \param id - border identifier
+  \return `false` if there is no border with that identifier or it cannot be
+           found in the R-tree
+
+  If a R-tree node becomes underfull, the node is removed and its borders are
+  inserted again in the tree.
+*/
+bool BorderSet::remove (size_t id)
+{
+  if (!contains (id))
+    return false;
+
+  if (borders[id].hole ())
+  {
+    auto it = std::find (unbounded.begin (), unbounded.end (), id);
+    if (it == unbounded.end ())
+      return false; // inconsistent state
+    unbounded.erase (it);
+  }
+  else if (borders[id].size ())
+  {
+    std::vector<uint32_t> path;
+    if (root == none || !find_leaf (root, boxes[id], (uint32_t)id, path))
+      return false; // stored box doesn't match tree
+
+    // remove entry from leaf
+    node& leaf = nodes[path.back ()];
+    int k = (int)(std::find (leaf.child, leaf.child + leaf.count, (uint32_t)id) - leaf.child);
+    if (k >= leaf.count)
+      return false;
+    leaf.count--;
+    leaf.rc[k] = leaf.rc[leaf.count];
+    leaf.child[k] = leaf.child[leaf.count];
+
+    // walk up the tree, removing underfull nodes and adjusting bounding boxes
+    std::vector<uint32_t> orphans;
+    for (size_t lvl = path.size () - 1; lvl > 0; lvl--)
+    {
+      uint32_t n = path[lvl];
+      node& parent = nodes[path[lvl - 1]];
+      int i = (int)(std::find (parent.child, parent.child + parent.count, n) - parent.child);
+      if (nodes[n].count < min_entries)
+      {
+        collect (n, orphans);
+        parent.count--;
+        parent.rc[i] = parent.rc[parent.count];
+        parent.child[i] = parent.child[parent.count];
+      }
+      else
+      {
+        const node& nd = nodes[n];
+        box& b = parent.rc[i];
+        b = nd.rc[0];
+        for (int j = 1; j < nd.count; j++)
+        {
+          b.xmin = (std::min) (b.xmin, nd.rc[j].xmin);
+          b.ymin = (std::min) (b.ymin, nd.rc[j].ymin);
+          b.xmax = (std::max) (b.xmax, nd.rc[j].xmax);
+          b.ymax = (std::max) (b.ymax, nd.rc[j].ymax);
+        }
+      }
+    }
+
+    // shorten the tree if root has only one child
+    while (!nodes[root].leaf && nodes[root].count == 1)
+    {
+      free_nodes.push_back (root);
+      root = nodes[root].child[0];
+    }
+    if (!nodes[root].count)
+      nodes[root].leaf = true;
+
+    for (auto o : orphans)
+      insert_entry (boxes[o], o);
+  }
+
+  borders[id] = Border ();
+  used[id] = false;
+  free_ids.push_back (id);
+  count--;
+  return true;
+}
+
+/// Remove all borders from set
+void BorderSet::clear ()
+{
+  borders.clear ();
+  boxes.clear ();
+  used.clear ();
+  free_ids.clear ();
+  unbounded.clear ();
+  nodes.clear ();
+  free_nodes.clear ();
+  root = none;
+  count = 0;
+}
+
+/*!
+  Find all borders containing a point.
+
+  \param x - X coordinate of the point
+  \param y - Y coordinate of the point
+  \param ids - identifiers of borders containing the point, in ascending order
+  \return number of borders containing the point
+*/
+size_t BorderSet::find (double x, double y, std::vector<size_t>& ids) const
+{
+  ids.clear ();
+  search (x, y, ids);
+  return ids.size ();
+}
+
+/*!
+  Find the borders containing each of many points.
+
+  \param x - X coordinates of points
+  \param y - Y coordinates of points
+  \param start - index in `ids` of first border containing each point
+  \param ids - identifiers of borders containing each point
+  \param nthreads - maximum number of threads to use. If 0, use the number of
+                    hardware threads.
+  \return total number of borders found
+
+  The number of points is the size of the shortest span. On return, `start`
+  has one more element than the number of points and the borders containing
+  point `i` are `ids[start[i]]` to `ids[start[i+1]-1]`, in ascending order.
+*/
+size_t BorderSet::find (std::span<const double> x, std::span<const double> y,
+                        std::vector<size_t>& start, std::vector<size_t>& ids,
+                        unsigned int nthreads) const
+{
+  size_t npts = (std::min) (x.size (), y.size ());
+  start.assign (npts + 1, 0);
+  ids.clear ();
+  if (!npts)
+    return 0;
+
+  // split only if there is enough work for each thread
+  const size_t min_points = 4096;
+  if (!nthreads)
+    nthreads = (std::max) (std::thread::hardware_concurrency (), 1u);
+  size_t nchunks = std::clamp (npts / min_points, (size_t)1, (size_t)nthreads);
+
+  // each chunk keeps the number of borders for each point in start[i+1]
+  auto run = [&] (size_t first, size_t last, std::vector<size_t>& out) {
+    for (size_t i = first; i < last; i++)
+    {
+      size_t n = out.size ();
+      search (x[i], y[i], out);
+      start[i + 1] = out.size () - n;
+    }
+  };
+
+  if (nchunks == 1)
+    run (0, npts, ids);
+  else
+  {
+    std::vector<std::vector<size_t>> results (nchunks);
+    std::vector<std::thread> workers;
+    size_t chunk = (npts + nchunks - 1) / nchunks;
+    for (size_t i = 0, first = 0; first < npts; i++, first += chunk)
+      workers.emplace_back (run, first, (std::min) (first + chunk, npts), std::ref (results[i]));
+    for (auto& w : workers)
+      w.join ();
+    size_t total = 0;
+    for (auto& r : results)
+      total += r.size ();
+    ids.reserve (total);
+    for (auto& r : results)
+      ids.insert (ids.end (), r.begin (), r.end ());
+  }
+
+  for (size_t i = 0; i < npts; i++)
+    start[i + 1] += start[i];
+  return ids.size ();
+}
+
+/// Return height of R-tree. An empty tree has height 0.
+int BorderSet::height () const
+{
+  if (root == none)
+    return 0;
+  int h = 1;
+  for (uint32_t n = root; !nodes[n].leaf; n = nodes[n].child[0])
+    h++;
+  return h;
+}
+
+// Append to `ids` all borders containing the point, in ascending order
+void BorderSet::search (double x, double y, std::vector<size_t>& ids) const
+{
+  size_t n = ids.size ();
+  if (root != none)
+    search (root, x, y, ids);
+  for (auto h : unbounded)
+  {
+    if (borders[h].inside (x, y))
+      ids.push_back (h);
+  }
+  if (ids.size () - n > 1)
+    std::sort (ids.begin () + n, ids.end ());
+}
+
+// Recursive search of R-tree starting from node `n`
+void BorderSet::search (uint32_t n, double x, double y, std::vector<size_t>& ids) const
+{
+  const node& nd = nodes[n];
+  for (int i = 0; i < nd.count; i++)
+  {
+    const box& b = nd.rc[i];
+    if (x < b.xmin || x > b.xmax || y < b.ymin || y > b.ymax)
+      continue;
+    if (!nd.leaf)
+      search (nd.child[i], x, y, ids);
+    else if (borders[nd.child[i]].inside (x, y))
+      ids.push_back (nd.child[i]);
+  }
+}
+
+// Allocate a new R-tree node
+uint32_t BorderSet::new_node (bool leaf)
+{
+  uint32_t n;
+  if (!free_nodes.empty ())
+  {
+    n = free_nodes.back ();
+    free_nodes.pop_back ();
+  }
+  else
+  {
+    n = (uint32_t)nodes.size ();
+    nodes.emplace_back ();
+  }
+  nodes[n].count = 0;
+  nodes[n].leaf = leaf;
+  return n;
+}
+
+/*
+  Insert a border in the R-tree.
+
+  Descend from root choosing the child needing the least enlargement, add the
+  border to the leaf and, if the leaf overflows, split it. Splits propagate
+  upward and, if the root is split, the tree grows by one level.
+*/
+void BorderSet::insert_entry (const box& b, uint32_t id)
+{
+  if (root == none)
+    root = new_node (true);
+
+  std::vector<uint32_t> path;
+  uint32_t n = root;
+  while (!nodes[n].leaf)
+  {
+    path.push_back (n);
+    node& nd = nodes[n];
+    int best = 0;
+    double best_enl = 0, best_area = 0;
+    for (int i = 0; i < nd.count; i++)
+    {
+      const box& r = nd.rc[i];
+      double a = area (r.xmin, r.ymin, r.xmax, r.ymax);
+      double enl = area ((std::min) (r.xmin, b.xmin), (std::min) (r.ymin, b.ymin),
+                         (std::max) (r.xmax, b.xmax), (std::max) (r.ymax, b.ymax))
+                   - a;
+      if (!i || enl < best_enl || (enl == best_enl && a < best_area))
+      {
+        best = i;
+        best_enl = enl;
+        best_area = a;
+      }
+    }
+    // enlarge child box on the way down
+    box& r = nd.rc[best];
+    r.xmin = (std::min) (r.xmin, b.xmin);
+    r.ymin = (std::min) (r.ymin, b.ymin);
+    r.xmax = (std::max) (r.xmax, b.xmax);
+    r.ymax = (std::max) (r.ymax, b.ymax);
+    n = nd.child[best];
+  }
+
+  node& leaf = nodes[n];
+  leaf.rc[leaf.count] = b;
+  leaf.child[leaf.count++] = id;
+
+  // split overflowing nodes
+  auto cover = [this] (uint32_t k) {
+    const node& nd = nodes[k];
+    box c = nd.rc[0];
+    for (int i = 1; i < nd.count; i++)
+    {
+      c.xmin = (std::min) (c.xmin, nd.rc[i].xmin);
+      c.ymin = (std::min) (c.ymin, nd.rc[i].ymin);
+      c.xmax = (std::max) (c.xmax, nd.rc[i].xmax);
+      c.ymax = (std::max) (c.ymax, nd.rc[i].ymax);
+    }
+    return c;
+  };
+  uint32_t sibling = nodes[n].count > max_entries ? split (n) : none;
+  while (sibling != none && !path.empty ())
+  {
+    uint32_t p = path.back ();
+    path.pop_back ();
+    node& parent = nodes[p];
+    int i = (int)(std::find (parent.child, parent.child + parent.count, n) - parent.child);
+    parent.rc[i] = cover (n);
+    parent.rc[parent.count] = cover (sibling);
+    parent.child[parent.count++] = sibling;
+    sibling = parent.count > max_entries ? split (p) : none;
+    n = p;
+  }
+  if (sibling != none)
+  {
+    // root was split
+    uint32_t r = new_node (false);
+    node& nr = nodes[r];
+    nr.rc[0] = cover (root);
+    nr.child[0] = root;
+    nr.rc[1] = cover (sibling);
+    nr.child[1] = sibling;
+    nr.count = 2;
+    root = r;
+  }
+}
+
+/*
+  Quadratic split of an overflowing node.
+
+  Entries are divided between node `n` and a new node. Returns the new node.
+*/
+uint32_t BorderSet::split (uint32_t n)
+{
+  uint32_t m = new_node (nodes[n].leaf);
+  node& a = nodes[n];
+  node& b = nodes[m];
+  const int cnt = a.count;
+  box rc[max_entries + 1];
+  uint32_t child[max_entries + 1];
+  bool done[max_entries + 1]{};
+  std::copy (a.rc, a.rc + cnt, rc);
+  std::copy (a.child, a.child + cnt, child);
+
+  // pick as seeds the pair of entries that would waste most area if put together
+  int s1 = 0, s2 = 1;
+  double worst = -HUGE_VAL;
+  for (int i = 0; i < cnt - 1; i++)
+  {
+    for (int j = i + 1; j < cnt; j++)
+    {
+      double d = area ((std::min) (rc[i].xmin, rc[j].xmin), (std::min) (rc[i].ymin, rc[j].ymin),
+                       (std::max) (rc[i].xmax, rc[j].xmax), (std::max) (rc[i].ymax, rc[j].ymax))
+                 - area (rc[i].xmin, rc[i].ymin, rc[i].xmax, rc[i].ymax)
+                 - area (rc[j].xmin, rc[j].ymin, rc[j].xmax, rc[j].ymax);
+      if (d > worst)
+      {
+        worst = d;
+        s1 = i;
+        s2 = j;
+      }
+    }
+  }
+
+  auto add = [&] (node& nd, box& cov, int i) {
+    if (!nd.count)
+      cov = rc[i];
+    else
+    {
+      cov.xmin = (std::min) (cov.xmin, rc[i].xmin);
+      cov.ymin = (std::min) (cov.ymin, rc[i].ymin);
+      cov.xmax = (std::max) (cov.xmax, rc[i].xmax);
+      cov.ymax = (std::max) (cov.ymax, rc[i].ymax);
+    }
+    nd.rc[nd.count] = rc[i];
+    nd.child[nd.count++] = child[i];
+    done[i] = true;
+  };
+  auto growth = [&] (const box& cov, int i) {
+    return area ((std::min) (cov.xmin, rc[i].xmin), (std::min) (cov.ymin, rc[i].ymin),
+                 (std::max) (cov.xmax, rc[i].xmax), (std::max) (cov.ymax, rc[i].ymax))
+           - area (cov.xmin, cov.ymin, cov.xmax, cov.ymax);
+  };
+
+  box ca{}, cb{};
+  a.count = 0;
+  add (a, ca, s1);
+  add (b, cb, s2);
+  for (int left = cnt - 2; left > 0; left--)
+  {
+    // if one group needs all remaining entries to reach minimum fill, give them all
+    if (a.count + left == min_entries || b.count + left == min_entries)
+    {
+      node& g = (a.count + left == min_entries) ? a : b;
+      box& c = (&g == &a) ? ca : cb;
+      for (int i = 0; i < cnt; i++)
+        if (!done[i])
+          add (g, c, i);
+      break;
+    }
+
+    // pick the entry with greatest preference for one group
+    int next = -1;
+    double best = -1, ga = 0, gb = 0;
+    for (int i = 0; i < cnt; i++)
+    {
+      if (done[i])
+        continue;
+      double da = growth (ca, i), db = growth (cb, i);
+      if (fabs (da - db) > best)
+      {
+        best = fabs (da - db);
+        next = i;
+        ga = da;
+        gb = db;
+      }
+    }
+    bool to_a = ga < gb
+                || (ga == gb
+                    && (area (ca.xmin, ca.ymin, ca.xmax, ca.ymax)
+                          < area (cb.xmin, cb.ymin, cb.xmax, cb.ymax)
+                        || (area (ca.xmin, ca.ymin, ca.xmax, ca.ymax)
+                              == area (cb.xmin, cb.ymin, cb.xmax, cb.ymax)
+                            && a.count <= b.count)));
+    if (to_a)
+      add (a, ca, next);
+    else
+      add (b, cb, next);
+  }
+  return m;
+}
+
+/*
+  Find the leaf containing a border. On return `path` has all the nodes from
+  root to leaf.
+*/
+bool BorderSet::find_leaf (uint32_t n, const box& b, uint32_t id,
+                           std::vector<uint32_t>& path) const
+{
+  path.push_back (n);
+  const node& nd = nodes[n];
+  for (int i = 0; i < nd.count; i++)
+  {
+    if (nd.leaf)
+    {
+      if (nd.child[i] == id)
+        return true;
+    }
+    else if (nd.rc[i].xmin <= b.xmin && nd.rc[i].ymin <= b.ymin && nd.rc[i].xmax >= b.xmax
+             && nd.rc[i].ymax >= b.ymax && find_leaf (nd.child[i], b, id, path))
+      return true;
+  }
+  path.pop_back ();
+  return false;
+}
+
+// Collect all borders in subtree of node `n` and free the subtree nodes
+void BorderSet::collect (uint32_t n, std::vector<uint32_t>& ids)
+{
+  const node& nd = nodes[n];
+  for (int i = 0; i < nd.count; i++)
+  {
+    if (nd.leaf)
+      ids.push_back (nd.child[i]);
+    else
+      collect (nd.child[i], ids);
+  }
+  free_nodes.push_back (n);
+}
+
+} // namespace mlib
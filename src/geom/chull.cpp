@@ -17,58 +17,8 @@
 #include <mlib/mlib.h>
 #pragma hdrstop
 
-#include <stdlib.h>
-
-
 namespace mlib {
 
-static int ccw (dpoint* P, int i, int j, int k)
-{
-  double a = (P + i)->x - (P + j)->x, b = (P + i)->y - (P + j)->y, c = (P + k)->x - (P + j)->x,
-         d = (P + k)->y - (P + j)->y;
-  return a * d - b * c <= 0; /* true if points i, j, k counterclockwise */
-}
-
-static int cmpl (const void* a, const void* b)
-{
-  double v;
-  v = reinterpret_cast<const dpoint*> (a)->x - reinterpret_cast<const dpoint*> (b)->x;
-  if (v > 0)
-    return 1;
-  if (v < 0)
-    return -1;
-  v = reinterpret_cast<const dpoint*> (a)->y - reinterpret_cast<const dpoint*> (b)->y;
-  if (v > 0)
-    return 1;
-  if (v < 0)
-    return -1;
-  return 0;
-}
-
-static int cmph (const void* a, const void* b)
-{
-  return cmpl (b, a);
-}
-
-static int make_chain (dpoint* V, int n, int (*cmp) (const void*, const void*))
-{
-  int i, j, s = 1;
-  dpoint t;
-
-  qsort (V, n, sizeof (dpoint), cmp);
-  for (i = 2; i < n; i++)
-  {
-    for (j = s; j >= 1 && ccw (V, i, j, j - 1); j--)
-    {
-    }
-    s = j + 1;
-    t = V[s];
-    V[s] = V[i];
-    V[i] = t;
-  }
-  return s;
-}
-
 /*!
   Find convex hull for an array of points
   \param P points array
@@ -88,13 +38,13 @@ static int make_chain (dpoint* V, int n, int (*cmp) (const void*, const void*))
  The results should be "robust", and not return a wildly wrong hull, despite
  using floating point.
 
+ This function uses the template version of convex_hull() that works with any
+ type of points and can use multiple threads.
+
 */
 int convex_hull (dpoint* P, int n)
 {
-  int u = make_chain (P, n, cmpl); /* make lower hull */
-  if (!u)
-    return 0;
-  return u + make_chain (P + u, n - u + 1, cmph); /* make upper hull */
+  return (int)convex_hull (P, (size_t)n, 1);
 }
 
 } // namespace mlib
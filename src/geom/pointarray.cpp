@@ -0,0 +1,163 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+#include <mlib/mlib.h>
+#pragma hdrstop
+#include <algorithm>
+#include <math.h>
+
+#include "../simd.h"
+
+namespace mlib::detail {
+
+/// Distances from (rx, ry) to each point
+void pa_distance (const double* x, const double* y, size_t n, double rx, double ry, double* out)
+{
+  size_t i = 0;
+#if defined(MLIB_SIMD)
+  vd vx = vset (rx), vy = vset (ry);
+  for (; i + MLIB_SIMD <= n; i += MLIB_SIMD)
+  {
+    vd dx = vsub (vload (x + i), vx), dy = vsub (vload (y + i), vy);
+    vstore (out + i, vsqrt (vadd (vmul (dx, dx), vmul (dy, dy))));
+  }
+#endif
+  for (; i < n; i++)
+    out[i] = hypot (x[i] - rx, y[i] - ry);
+}
+
+/*
+  Azimuths from (rx, ry) to each point.
+
+  The vectorized code computes `atan2` from the arctangent of the ratio between
+  the smaller and the larger of the absolute coordinate differences, followed
+  by quadrant corrections. The conventions of Point::azimuth() are kept: points
+  closer than the tolerance have an azimuth of 0 and other results are in
+  the interval (0, 2*PI].
+*/
+void pa_azimuth (const double* x, const double* y, size_t n, double rx, double ry, double* out)
+{
+  const double tol = point_traits<double>::tolerance ();
+  size_t i = 0;
+#if defined(MLIB_SIMD)
+  const vd vx = vset (rx), vy = vset (ry), zero = vset (0.), sign = vset (-0.);
+  const vd pi = vset (M_PI), half_pi = vset (M_PI / 2), two_pi = vset (2 * M_PI);
+  const vd tol2 = vset (tol * tol);
+  for (; i + MLIB_SIMD <= n; i += MLIB_SIMD)
+  {
+    vd dx = vsub (vload (x + i), vx), dy = vsub (vload (y + i), vy);
+    vd ax = vandnot (sign, dx), ay = vandnot (sign, dy);
+    vd swap = vgt (ax, ay);
+    vd t = vatan01 (vdiv (vmin (ax, ay), vmax (ax, ay)));
+    t = vselect (swap, vsub (half_pi, t), t);       // atan2 (|dx|, |dy|)
+    t = vselect (vlt (dy, zero), vsub (pi, t), t);  // atan2 (|dx|, dy)
+    t = vxor (t, vand (vlt (dx, zero), sign));      // atan2 (dx, dy)
+    t = vselect (vgt (t, zero), t, vadd (two_pi, t));
+    // coincident points have azimuth 0
+    vd same = vlt (vadd (vmul (dx, dx), vmul (dy, dy)), tol2);
+    vstore (out + i, vandnot (same, t));
+  }
+#endif
+  for (; i < n; i++)
+  {
+    if (hypot (x[i] - rx, y[i] - ry) < tol)
+      out[i] = 0.;
+    else
+    {
+      double t = atan2 (x[i] - rx, y[i] - ry);
+      out[i] = (t > 0) ? t : 2 * M_PI + t;
+    }
+  }
+}
+
+/// Bounding box of all points. Array must not be empty.
+void pa_bbox (const double* x, const double* y, size_t n, double& xmin, double& ymin, double& xmax,
+              double& ymax)
+{
+  size_t i = 0;
+  xmin = xmax = x[0];
+  ymin = ymax = y[0];
+#if defined(MLIB_SIMD)
+  if (n >= MLIB_SIMD)
+  {
+    vd x0 = vload (x), y0 = vload (y), x1 = x0, y1 = y0;
+    for (i = MLIB_SIMD; i + MLIB_SIMD <= n; i += MLIB_SIMD)
+    {
+      vd vx = vload (x + i), vy = vload (y + i);
+      x0 = vmin (x0, vx);
+      x1 = vmax (x1, vx);
+      y0 = vmin (y0, vy);
+      y1 = vmax (y1, vy);
+    }
+    double r[4][MLIB_SIMD];
+    vstore (r[0], x0);
+    vstore (r[1], y0);
+    vstore (r[2], x1);
+    vstore (r[3], y1);
+    for (int k = 0; k < MLIB_SIMD; k++)
+    {
+      xmin = (std::min) (xmin, r[0][k]);
+      ymin = (std::min) (ymin, r[1][k]);
+      xmax = (std::max) (xmax, r[2][k]);
+      ymax = (std::max) (ymax, r[3][k]);
+    }
+  }
+#endif
+  for (; i < n; i++)
+  {
+    xmin = (std::min) (xmin, x[i]);
+    ymin = (std::min) (ymin, y[i]);
+    xmax = (std::max) (xmax, x[i]);
+    ymax = (std::max) (ymax, y[i]);
+  }
+}
+
+/// Index of first point closest to (rx, ry). Array must not be empty.
+size_t pa_nearest (const double* x, const double* y, size_t n, double rx, double ry)
+{
+  size_t i = 0, best = 0;
+  double dmin = HUGE_VAL;
+#if defined(MLIB_SIMD)
+  if (n >= MLIB_SIMD)
+  {
+    // each lane keeps its own minimum and the index where it was found
+    const vd vx = vset (rx), vy = vset (ry), step = vset (MLIB_SIMD);
+    vd vmin_d = vset (HUGE_VAL), vmin_i = vset (0.), idx = vindex (0);
+    for (; i + MLIB_SIMD <= n; i += MLIB_SIMD)
+    {
+      vd dx = vsub (vload (x + i), vx), dy = vsub (vload (y + i), vy);
+      vd d = vadd (vmul (dx, dx), vmul (dy, dy));
+      vd lt = vlt (d, vmin_d);
+      vmin_d = vselect (lt, d, vmin_d);
+      vmin_i = vselect (lt, idx, vmin_i);
+      idx = vadd (idx, step);
+    }
+    double dl[MLIB_SIMD], il[MLIB_SIMD];
+    vstore (dl, vmin_d);
+    vstore (il, vmin_i);
+    for (int k = 0; k < MLIB_SIMD; k++)
+    {
+      if (dl[k] < dmin || (dl[k] == dmin && (size_t)il[k] < best))
+      {
+        dmin = dl[k];
+        best = (size_t)il[k];
+      }
+    }
+  }
+#endif
+  for (; i < n; i++)
+  {
+    double dx = x[i] - rx, dy = y[i] - ry;
+    double d = dx * dx + dy * dy;
+    if (d < dmin)
+    {
+      dmin = d;
+      best = i;
+    }
+  }
+  return best;
+}
+
+} // namespace mlib::detail
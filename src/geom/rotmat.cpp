@@ -6,9 +6,34 @@
 #include <mlib/mlib.h>
 #pragma hdrstop
 #include <math.h>
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define ROTMAT_AVX
+#endif
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)                                     \
+  || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ROTMAT_SSE2
+#endif
 
 namespace mlib {
 
+/*!
+  \class RotMat
+  \ingroup geom
+
+  Besides rotating individual points, a RotMat object can rotate large sets of
+  points stored either as consecutive x, y, z triplets (array of structures) or
+  as separate arrays of coordinates (structure of arrays). The batch functions
+  use SSE2 or AVX instructions if available.
+
+  Rotations that are always applied together, like a sensor mounting rotation
+  followed by vessel attitude, should be combined in one matrix using the
+  multiplication operator.
+*/
+
 RotMat::RotMat ()
   : r{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}
 {}
@@ -29,6 +54,14 @@ RotMat::RotMat (double rx, double ry, double rz)
   x_rotation (rx);
 }
 
+/// Create rotation object from a 3x3 rotation matrix
+RotMat::RotMat (const double m[3][3])
+{
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 3; j++)
+      r[i][j] = m[i][j];
+}
+
 void RotMat::x_rotation (double angle)
 {
   double rx[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
@@ -55,15 +88,126 @@ void RotMat::z_rotation (double angle)
 
 void RotMat::rotate (double* vec) const
 {
-  double t[3];
-  for (int i = 0; i < 3; i++)
+  double t0 = r[0][0] * vec[0] + r[0][1] * vec[1] + r[0][2] * vec[2];
+  double t1 = r[1][0] * vec[0] + r[1][1] * vec[1] + r[1][2] * vec[2];
+  double t2 = r[2][0] * vec[0] + r[2][1] * vec[1] + r[2][2] * vec[2];
+  vec[0] = t0;
+  vec[1] = t1;
+  vec[2] = t2;
+}
+
+/*!
+  \param xyz array of `3*n` values with coordinates of each point
+  \param n number of points
+
+  Points are rotated in place.
+*/
+void RotMat::rotate (double* xyz, size_t n) const
+{
+  size_t i = 0;
+#if defined(ROTMAT_SSE2)
+  // Two points at a time: deinterleave to x, y, z vectors, rotate and
+  // interleave back.
+  __m128d m[3][3];
+  for (int k = 0; k < 3; k++)
+    for (int l = 0; l < 3; l++)
+      m[k][l] = _mm_set1_pd (r[k][l]);
+  for (; i + 2 <= n; i += 2)
   {
-    t[i] = 0;
-    for (int j = 0; j < 3; j++)
-      t[i] += vec[j] * r[i][j];
+    double* p = xyz + 3 * i;
+    __m128d a = _mm_loadu_pd (p), b = _mm_loadu_pd (p + 2), c = _mm_loadu_pd (p + 4);
+    __m128d x = _mm_shuffle_pd (a, b, 2), y = _mm_shuffle_pd (a, c, 1),
+            z = _mm_shuffle_pd (b, c, 2);
+    __m128d v[3];
+    for (int k = 0; k < 3; k++)
+      v[k] = _mm_add_pd (_mm_add_pd (_mm_mul_pd (m[k][0], x), _mm_mul_pd (m[k][1], y)),
+                         _mm_mul_pd (m[k][2], z));
+    _mm_storeu_pd (p, _mm_shuffle_pd (v[0], v[1], 0));
+    _mm_storeu_pd (p + 2, _mm_shuffle_pd (v[2], v[0], 2));
+    _mm_storeu_pd (p + 4, _mm_shuffle_pd (v[1], v[2], 3));
+  }
+#endif
+  for (; i < n; i++)
+    rotate (xyz + 3 * i);
+}
+
+/*!
+  \param x X coordinates
+  \param y Y coordinates
+  \param z Z coordinates
+
+  Points are rotated in place. The number of points is the size of the
+  shortest span.
+*/
+void RotMat::rotate (std::span<double> x, std::span<double> y, std::span<double> z) const
+{
+  size_t n = (std::min) ({x.size (), y.size (), z.size ()});
+  double *px = x.data (), *py = y.data (), *pz = z.data ();
+  size_t i = 0;
+#if defined(ROTMAT_AVX)
+  __m256d m[3][3];
+  for (int k = 0; k < 3; k++)
+    for (int l = 0; l < 3; l++)
+      m[k][l] = _mm256_set1_pd (r[k][l]);
+  for (; i + 4 <= n; i += 4)
+  {
+    __m256d vx = _mm256_loadu_pd (px + i), vy = _mm256_loadu_pd (py + i),
+            vz = _mm256_loadu_pd (pz + i);
+    __m256d v[3];
+    for (int k = 0; k < 3; k++)
+      v[k] = _mm256_add_pd (
+        _mm256_add_pd (_mm256_mul_pd (m[k][0], vx), _mm256_mul_pd (m[k][1], vy)),
+        _mm256_mul_pd (m[k][2], vz));
+    _mm256_storeu_pd (px + i, v[0]);
+    _mm256_storeu_pd (py + i, v[1]);
+    _mm256_storeu_pd (pz + i, v[2]);
+  }
+#elif defined(ROTMAT_SSE2)
+  __m128d m[3][3];
+  for (int k = 0; k < 3; k++)
+    for (int l = 0; l < 3; l++)
+      m[k][l] = _mm_set1_pd (r[k][l]);
+  for (; i + 2 <= n; i += 2)
+  {
+    __m128d vx = _mm_loadu_pd (px + i), vy = _mm_loadu_pd (py + i), vz = _mm_loadu_pd (pz + i);
+    __m128d v[3];
+    for (int k = 0; k < 3; k++)
+      v[k] = _mm_add_pd (_mm_add_pd (_mm_mul_pd (m[k][0], vx), _mm_mul_pd (m[k][1], vy)),
+                         _mm_mul_pd (m[k][2], vz));
+    _mm_storeu_pd (px + i, v[0]);
+    _mm_storeu_pd (py + i, v[1]);
+    _mm_storeu_pd (pz + i, v[2]);
   }
+#endif
+  for (; i < n; i++)
+  {
+    double t[3] = {px[i], py[i], pz[i]};
+    rotate (t);
+    px[i] = t[0];
+    py[i] = t[1];
+    pz[i] = t[2];
+  }
+}
+
+/*!
+  The result is the rotation obtained by applying first `other` and then
+  this rotation.
+*/
+RotMat RotMat::operator* (const RotMat& other) const
+{
+  RotMat t (r);
+  t.multiply (other.r);
+  return t;
+}
+
+/// The inverse of a rotation matrix is its transpose
+RotMat RotMat::transpose () const
+{
+  RotMat t;
   for (int i = 0; i < 3; i++)
-    vec[i] = t[i];
+    for (int j = 0; j < 3; j++)
+      t.r[i][j] = r[j][i];
+  return t;
 }
 
 void RotMat::rotate (double& x, double& y, double& z) const
@@ -78,21 +222,207 @@ void RotMat::rotate (double& x, double& y, double& z) const
   z = t[2];
 }
 
-void RotMat::multiply (double m[3][3])
+void RotMat::multiply (const double m[3][3])
 {
   double t[3][3];
 
   for (int i = 0; i < 3; i++)
-    for (int j = 0; j < 3; j++)
-    {
-      t[i][j] = 0;
-      for (int k = 0; k < 3; k++)
-        t[i][j] += r[i][k] * m[k][j];
-    }
+  {
+    t[i][0] = r[i][0] * m[0][0] + r[i][1] * m[1][0] + r[i][2] * m[2][0];
+    t[i][1] = r[i][0] * m[0][1] + r[i][1] * m[1][1] + r[i][2] * m[2][1];
+    t[i][2] = r[i][0] * m[0][2] + r[i][1] * m[1][2] + r[i][2] * m[2][2];
+  }
 
   for (int i = 0; i < 3; i++)
     for (int j = 0; j < 3; j++)
       r[i][j] = t[i][j];
 }
 
+/*!
+  \class Quaternion
+  \ingroup geom
+
+  Quaternions are a compact representation of rotations (4 values instead of
+  9) that can be combined and, most importantly, interpolated smoothly. A
+  typical use is to find the attitude of a vessel at the time of each sonar
+  ping by interpolating between attitude samples and then convert the result
+  to a RotMat object to rotate the ping points.
+
+  The rotation represented by a quaternion is the same as that of the matrix
+  produced by rotmat() function.
+*/
+
+/// Identity rotation
+Quaternion::Quaternion ()
+  : w (1)
+  , x (0)
+  , y (0)
+  , z (0)
+{}
+
+/// The quaternion is not normalized
+Quaternion::Quaternion (double w_, double x_, double y_, double z_)
+  : w (w_)
+  , x (x_)
+  , y (y_)
+  , z (z_)
+{}
+
+/*!
+  \param rx rotation around X-axis (radians)
+  \param ry rotation around Y-axis (radians)
+  \param rz rotation around Z-axis (radians)
+
+  The rotation is the same as the one of RotMat object with the same
+  arguments.
+*/
+Quaternion::Quaternion (double rx, double ry, double rz)
+{
+  double cx = cos (rx / 2), sx = sin (rx / 2);
+  double cy = cos (ry / 2), sy = sin (ry / 2);
+  double cz = cos (rz / 2), sz = sin (rz / 2);
+  w = cz * cy * cx + sz * sy * sx;
+  x = cz * cy * sx - sz * sy * cx;
+  y = cz * sy * cx + sz * cy * sx;
+  z = sz * cy * cx - cz * sy * sx;
+}
+
+/// Uses Shepperd's method for numerical stability
+Quaternion::Quaternion (const RotMat& m)
+{
+  auto& r = m.matrix ();
+  double tr = r[0][0] + r[1][1] + r[2][2];
+  if (tr > 0)
+  {
+    double s = 2 * sqrt (tr + 1);
+    w = s / 4;
+    x = (r[2][1] - r[1][2]) / s;
+    y = (r[0][2] - r[2][0]) / s;
+    z = (r[1][0] - r[0][1]) / s;
+  }
+  else if (r[0][0] > r[1][1] && r[0][0] > r[2][2])
+  {
+    double s = 2 * sqrt (1 + r[0][0] - r[1][1] - r[2][2]);
+    w = (r[2][1] - r[1][2]) / s;
+    x = s / 4;
+    y = (r[0][1] + r[1][0]) / s;
+    z = (r[0][2] + r[2][0]) / s;
+  }
+  else if (r[1][1] > r[2][2])
+  {
+    double s = 2 * sqrt (1 + r[1][1] - r[0][0] - r[2][2]);
+    w = (r[0][2] - r[2][0]) / s;
+    x = (r[0][1] + r[1][0]) / s;
+    y = s / 4;
+    z = (r[1][2] + r[2][1]) / s;
+  }
+  else
+  {
+    double s = 2 * sqrt (1 + r[2][2] - r[0][0] - r[1][1]);
+    w = (r[1][0] - r[0][1]) / s;
+    x = (r[0][2] + r[2][0]) / s;
+    y = (r[1][2] + r[2][1]) / s;
+    z = s / 4;
+  }
+}
+
+RotMat Quaternion::rotmat () const
+{
+  double m[3][3] = {{1 - 2 * (y * y + z * z), 2 * (x * y - w * z), 2 * (x * z + w * y)},
+                    {2 * (x * y + w * z), 1 - 2 * (x * x + z * z), 2 * (y * z - w * x)},
+                    {2 * (x * z - w * y), 2 * (y * z + w * x), 1 - 2 * (x * x + y * y)}};
+  return RotMat (m);
+}
+
+/// Hamilton product of quaternions
+Quaternion Quaternion::operator* (const Quaternion& o) const
+{
+  return {w * o.w - x * o.x - y * o.y - z * o.z, w * o.x + x * o.w + y * o.z - z * o.y,
+          w * o.y - x * o.z + y * o.w + z * o.x, w * o.z + x * o.y - y * o.x + z * o.w};
+}
+
+Quaternion Quaternion::conjugate () const
+{
+  return {w, -x, -y, -z};
+}
+
+void Quaternion::normalize ()
+{
+  double n = sqrt (w * w + x * x + y * y + z * z);
+  if (n > 0)
+  {
+    w /= n;
+    x /= n;
+    y /= n;
+    z /= n;
+  }
+}
+
+/*!
+  For rotating many points it is faster to convert the quaternion to a
+  rotation matrix and use the RotMat batch functions.
+*/
+void Quaternion::rotate (double& px, double& py, double& pz) const
+{
+  // t = 2 * (u x p); p' = p + w * t + u x t
+  double tx = 2 * (y * pz - z * py);
+  double ty = 2 * (z * px - x * pz);
+  double tz = 2 * (x * py - y * px);
+  double rx = px + w * tx + (y * tz - z * ty);
+  double ry = py + w * ty + (z * tx - x * tz);
+  double rz = pz + w * tz + (x * ty - y * tx);
+  px = rx;
+  py = ry;
+  pz = rz;
+}
+
+/*!
+  \param q0 first rotation
+  \param q1 second rotation
+  \param t interpolation parameter; 0 returns `q0` and 1 returns `q1`
+
+  The interpolated rotation moves at constant angular speed on the shortest
+  path between `q0` and `q1`. When the rotations are very close, the function
+  switches to nlerp() to avoid division by a very small number.
+*/
+Quaternion slerp (const Quaternion& q0, const Quaternion& q1, double t)
+{
+  double d = q0.w * q1.w + q0.x * q1.x + q0.y * q1.y + q0.z * q1.z;
+  double sign = 1;
+  if (d < 0)
+  {
+    // q and -q are the same rotation; take the shortest path
+    d = -d;
+    sign = -1;
+  }
+  if (d > 0.9995)
+    return nlerp (q0, q1, t);
+
+  double theta = acos (d);
+  double s = sin (theta);
+  double a = sin ((1 - t) * theta) / s;
+  double b = sign * sin (t * theta) / s;
+  return {a * q0.w + b * q1.w, a * q0.x + b * q1.x, a * q0.y + b * q1.y, a * q0.z + b * q1.z};
+}
+
+/*!
+  \param q0 first rotation
+  \param q1 second rotation
+  \param t interpolation parameter; 0 returns `q0` and 1 returns `q1`
+
+  Interpolates linearly the quaternion components and normalizes the result.
+  This is much faster than slerp() and, for the small angles between
+  consecutive attitude samples, the results are practically the same.
+*/
+Quaternion nlerp (const Quaternion& q0, const Quaternion& q1, double t)
+{
+  double d = q0.w * q1.w + q0.x * q1.x + q0.y * q1.y + q0.z * q1.z;
+  double a = 1 - t;
+  double b = d < 0 ? -t : t;
+  Quaternion q (a * q0.w + b * q1.w, a * q0.x + b * q1.x, a * q0.y + b * q1.y,
+                a * q0.z + b * q1.z);
+  q.normalize ();
+  return q;
+}
+
 } // namespace mlib
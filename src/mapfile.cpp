@@ -0,0 +1,100 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <errno.h>
+#include <utf8/utf8.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mlib {
+
+/*!
+  \class mapped_file
+
+  The whole file is mapped in memory for reading. If the file cannot be
+  opened or mapped, the `error` member contains the system error code.
+  Empty files are not mapped: `data` is `nullptr` and `size` is 0.
+*/
+
+#ifdef _WIN32
+mapped_file::mapped_file (const std::string& fname)
+  : data (nullptr)
+  , size (0)
+  , error (0)
+  , map (NULL)
+{
+  file = CreateFileW (utf8::widen (fname).c_str (), GENERIC_READ, FILE_SHARE_READ, NULL,
+                      OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  LARGE_INTEGER sz;
+  if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx (file, &sz))
+  {
+    error = GetLastError ();
+    return;
+  }
+  size = (size_t)sz.QuadPart;
+  if (!size)
+    return; // empty files cannot be mapped
+  map = CreateFileMappingW (file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!map || !(data = (const char*)MapViewOfFile (map, FILE_MAP_READ, 0, 0, 0)))
+  {
+    error = GetLastError ();
+    size = 0;
+  }
+}
+
+mapped_file::~mapped_file ()
+{
+  if (data)
+    UnmapViewOfFile (data);
+  if (map)
+    CloseHandle (map);
+  if (file != INVALID_HANDLE_VALUE)
+    CloseHandle (file);
+}
+#else
+mapped_file::mapped_file (const std::string& fname)
+  : data (nullptr)
+  , size (0)
+  , error (0)
+{
+  struct stat st;
+  fd = open (fname.c_str (), O_RDONLY);
+  if (fd < 0 || fstat (fd, &st))
+  {
+    error = errno;
+    return;
+  }
+  size = (size_t)st.st_size;
+  if (!size)
+    return; // empty files cannot be mapped
+  void* p = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (p == MAP_FAILED)
+  {
+    error = errno;
+    size = 0;
+    return;
+  }
+  madvise (p, size, MADV_SEQUENTIAL);
+  data = (const char*)p;
+}
+
+mapped_file::~mapped_file ()
+{
+  if (data)
+    munmap ((void*)data, size);
+  if (fd >= 0)
+    close (fd);
+}
+#endif
+
+} // namespace mlib
@@ -7,15 +7,26 @@
 #pragma hdrstop
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string_view>
+#include <algorithm>
+#include <charconv>
+#include <bit>
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NMEA_SSE2
+#endif
 
 namespace mlib::nmea {
 
 // some handy parsing macros
 #define NEXT_TOKEN(A, B)                                                                           \
-  if ((A = ctx.token ()) == NULL)                                                                  \
+  if (!ctx.token (A))                                                                              \
   return B
 #define NEXT_VALIDTOKEN(A, B)                                                                      \
-  if ((A = ctx.token ()) == NULL || !strlen (A))                                                   \
+  if (!ctx.token (A) || A.empty ())                                                                \
   return B
 #define IFPAR(par, exp)                                                                            \
   if (par)                                                                                         \
@@ -31,52 +42,208 @@ class parse_context
 {
 public:
   parse_context (const char* buf);
-  ~parse_context ();
-  char* token ();
+  bool token (std::string_view& tok);
 
 private:
-  char* lcl;     // local copy of string to parse
-  char* toparse; // parsing position in local string
-  char saved;    // char replaced with NULL
+  const char* toparse; // parsing position
+  bool done;           // end of sentence reached
 };
 
 /// Constructor for a parsing context
 inline parse_context::parse_context (const char* buf)
+  : toparse (buf)
+  , done (false)
+{}
+
+/*
+    Retrieve next token of a NMEA sentence.
+
+    Tokens are delimited by ',', \<CR\>, \<LF\>, '*' or end of string. Returned token
+    is a view inside the original string; the string is not copied or modified.
+    We don't skip over consecutive empty fields.
+
+    Returns `false` if the end of the sentence has been reached.
+*/
+bool parse_context::token (std::string_view& tok)
 {
-  toparse = lcl = strdup (buf);
-  saved = 0;
-};
+  if (done)
+    return false;
+
+  const char* start = toparse;
+  while (*toparse && *toparse != ',' && *toparse != '\r' && *toparse != '\n' && *toparse != '*')
+    toparse++;
+  tok = std::string_view (start, toparse - start);
+  if (*toparse == ',')
+    toparse++;
+  else
+    done = true;
+  return true;
+}
+
+// Return first character of a token or 0 if token is empty
+static inline char chr (std::string_view tok)
+{
+  return tok.empty () ? 0 : tok[0];
+}
 
-inline parse_context::~parse_context ()
+// Check if first token of a sentence ($ttFFF) has the given formatter
+static inline bool formatter (std::string_view tok, const char* fmt)
 {
-  free (lcl);
+  return tok.size () >= 6 && !tok.compare (3, 3, fmt);
+}
+
+// Numerical value of a token
+static inline double to_double (std::string_view tok)
+{
+  return decimal (tok);
+}
+
+// Integer value of a token. Like atoi, conversion stops at first non-digit.
+static inline int to_int (std::string_view tok)
+{
+  size_t i = 0;
+  bool neg = false;
+  if (i < tok.size () && (tok[i] == '-' || tok[i] == '+'))
+    neg = (tok[i++] == '-');
+  int val = 0;
+  for (; i < tok.size () && tok[i] >= '0' && tok[i] <= '9'; i++)
+    val = val * 10 + (tok[i] - '0');
+  return neg ? -val : val;
+}
+
+// Powers of 10 used by fixed-point decoders (at most 15 decimals)
+static const double dbl_pow10[] = {1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                   1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+static const uint64_t int_pow10[] = {1ULL,
+                                     10ULL,
+                                     100ULL,
+                                     1000ULL,
+                                     10000ULL,
+                                     100000ULL,
+                                     1000000ULL,
+                                     10000000ULL,
+                                     100000000ULL,
+                                     1000000000ULL,
+                                     10000000000ULL,
+                                     100000000000ULL,
+                                     1000000000000ULL,
+                                     10000000000000ULL,
+                                     100000000000000ULL,
+                                     1000000000000000ULL};
+
+// Result of scanning a fixed-point number
+struct fixed_scan
+{
+  uint64_t mant; // all digits as an integer
+  int digits;    // number of digits
+  int decimals;  // number of digits after decimal point
+  bool neg;      // negative sign
+  bool exact;    // mant / 10^decimals is the exact value of the field
 };
 
 /*
-    Return next token of a NMEA sentence.
+  Scan a field with the format [+-]ddd[.ddd] in a single pass.
+  Like atof, scanning stops at the first character that is not part of the
+  number.
+*/
+static fixed_scan scan (std::string_view fld)
+{
+  fixed_scan r{0, 0, 0, false, true};
+  size_t i = 0, n = fld.size ();
+  while (i < n && fld[i] == ' ')
+    i++;
+  if (i < n && (fld[i] == '-' || fld[i] == '+'))
+    r.neg = (fld[i++] == '-');
+  for (; i < n && fld[i] >= '0' && fld[i] <= '9'; i++, r.digits++)
+    r.mant = r.mant * 10 + (fld[i] - '0');
+  if (i < n && fld[i] == '.')
+  {
+    for (i++; i < n && fld[i] >= '0' && fld[i] <= '9'; i++, r.digits++, r.decimals++)
+      r.mant = r.mant * 10 + (fld[i] - '0');
+  }
+  // more than 15 digits may exceed 2^53; exponents are not handled here
+  if (r.digits > 15 || (i < n && (fld[i] == 'e' || fld[i] == 'E')))
+    r.exact = false;
+  return r;
+}
+
+// Slow path for numbers that cannot be converted exactly by fixed-point scanning
+static double slow_decimal (std::string_view fld)
+{
+  while (!fld.empty () && (fld[0] == ' ' || fld[0] == '+'))
+    fld.remove_prefix (1);
+  double val = 0;
+  std::from_chars (fld.data (), fld.data () + fld.size (), val);
+  return val;
+}
+
+/*!
+  \param fld field to decode
+  \param val integer value of field with decimal point removed
+  \param decimals number of digits after decimal point
+  \return `true` if successful or `false` if field is empty or has more
+          than 18 digits.
+
+  Value of field is `val / 10^decimals`.
+*/
+bool fixed (std::string_view fld, int64_t& val, int& decimals)
+{
+  auto r = scan (fld);
+  if (!r.digits || r.digits > 18)
+    return false;
+  val = r.neg ? -(int64_t)r.mant : (int64_t)r.mant;
+  decimals = r.decimals;
+  return true;
+}
 
-    Tokens are delimited by ',', \<CR\>, '*' or end of string.
-    We cannot use strtok directly because we want to leave the string unchanged
-    and we don't want to skip over consecutive empty fields.
+/*!
+  The field is parsed in a single pass as a fixed-point number. The result is
+  identical to the one returned by `atof` but it doesn't depend on current
+  locale. An empty field is decoded as 0.
+*/
+double decimal (std::string_view fld)
+{
+  auto r = scan (fld);
+  if (!r.exact)
+    return slow_decimal (fld);
+  // both terms are exact so result is correctly rounded
+  double val = (double)r.mant / dbl_pow10[r.decimals];
+  return r.neg ? -val : val;
+}
+
+/*!
+  Degrees and minutes are split using integer arithmetic, before any
+  rounding takes place, hence the result is more precise than
+  `DM2rad (atof (fld))`.
+*/
+double latlon (std::string_view fld)
+{
+  auto r = scan (fld);
+  if (!r.exact)
+    return DM2rad (slow_decimal (fld));
+  uint64_t scale = int_pow10[r.decimals];
+  uint64_t deg = r.mant / scale / 100;
+  double min = (double)(r.mant - deg * 100 * scale) / dbl_pow10[r.decimals];
+  double val = (deg + min / 60.) * D2R;
+  return r.neg ? -val : val;
+}
 
+/*!
+  An empty field is decoded as 0.
 */
-char* parse_context::token ()
+double hms (std::string_view fld)
 {
-  char* ret;
-  if (saved)
+  auto r = scan (fld);
+  if (!r.exact)
   {
-    *toparse = saved;
-    if (saved != ',')
-      return NULL;
-    toparse++;
+    double t = slow_decimal (fld);
+    int hhmm = (int)(t / 100.);
+    return (hhmm / 100) * 3600. + (hhmm % 100) * 60. + (t - hhmm * 100.);
   }
-  ret = toparse;
-  while (*toparse && *toparse != ',' && *toparse != '\r' && *toparse != '*')
-    toparse++;
-
-  saved = *toparse;
-  *toparse = 0;
-  return ret;
+  uint64_t scale = int_pow10[r.decimals];
+  uint64_t hhmmss = r.mant / scale;
+  uint64_t secs = (hhmmss / 10000) * 3600 + (hhmmss / 100 % 100) * 60 + hhmmss % 100;
+  return (double)(secs * scale + r.mant % scale) / dbl_pow10[r.decimals];
 }
 
 /*!
@@ -115,6 +282,124 @@ bool checksum (const char* buf)
   }
 }
 
+// Value of a hexadecimal digit or -1 if not a valid digit
+static int hex (char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+/*
+  XOR all characters from p up to the first '*', CR or LF character. On return
+  p points to the delimiter, or to end if no delimiter was found.
+
+  With SSE2, characters are processed 16 at a time: the delimiter search and
+  the XOR reduction are both done on whole vectors.
+*/
+static unsigned char xor_scan (const char*& p, const char* end)
+{
+  unsigned char cks = 0;
+#ifdef NMEA_SSE2
+  // 16 bytes of ones followed by 16 bytes of zeroes: loading from
+  // (prefix_mask + 16 - k) gives a mask for the first k bytes
+  alignas (16) static const char prefix_mask[32] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
+  const __m128i star = _mm_set1_epi8 ('*');
+  const __m128i cr = _mm_set1_epi8 ('\r');
+  const __m128i lf = _mm_set1_epi8 ('\n');
+  __m128i acc = _mm_setzero_si128 ();
+  bool found = false;
+  while (end - p >= 16)
+  {
+    __m128i v = _mm_loadu_si128 ((const __m128i*)p);
+    __m128i hit = _mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (v, star), _mm_cmpeq_epi8 (v, cr)),
+                                _mm_cmpeq_epi8 (v, lf));
+    unsigned int m = _mm_movemask_epi8 (hit);
+    if (m)
+    {
+      int k = std::countr_zero (m);
+      __m128i keep = _mm_loadu_si128 ((const __m128i*)(prefix_mask + 16 - k));
+      acc = _mm_xor_si128 (acc, _mm_and_si128 (v, keep));
+      p += k;
+      found = true;
+      break;
+    }
+    acc = _mm_xor_si128 (acc, v);
+    p += 16;
+  }
+  acc = _mm_xor_si128 (acc, _mm_srli_si128 (acc, 8));
+  acc = _mm_xor_si128 (acc, _mm_srli_si128 (acc, 4));
+  acc = _mm_xor_si128 (acc, _mm_srli_si128 (acc, 2));
+  acc = _mm_xor_si128 (acc, _mm_srli_si128 (acc, 1));
+  cks = (unsigned char)_mm_cvtsi128_si32 (acc);
+  if (found)
+    return cks;
+#endif
+  while (p < end && *p != '*' && *p != '\r' && *p != '\n')
+    cks ^= *p++;
+  return cks;
+}
+
+/*!
+  Validate checksums of all sentences in a buffer
+
+  \param buf buffer with one or more sentences
+  \param len buffer length
+  \param results validation result for each sentence
+  \return number of valid sentences
+
+  Sentences are separated by CR and/or LF characters. The last sentence in
+  buffer doesn't need to be terminated. Empty lines are skipped; any other
+  line produces a result entry. A sentence is valid if it starts with '$' or
+  '!' and, if it has a checksum field, the checksum is correct. The checksum
+  field must contain exactly 2 hexadecimal digits (upper or lower case) and it
+  must be followed by the line terminator.
+
+  The search for delimiters and the XOR reduction use SSE2 instructions if
+  they are available, and a scalar loop otherwise.
+*/
+size_t checksum (const char* buf, size_t len, std::vector<checksum_result>& results)
+{
+  const char* end = buf + len;
+  const char* p = buf;
+  size_t nvalid = 0;
+
+  results.clear ();
+  while (p < end)
+  {
+    if (*p == '\r' || *p == '\n')
+    {
+      p++;
+      continue;
+    }
+    const char* start = p++;
+    bool ok = (*start == '$' || *start == '!');
+    unsigned char cks = xor_scan (p, end);
+    bool present = (p < end && *p == '*');
+    if (present)
+    {
+      const char* fld = ++p;
+      while (p < end && *p != '\r' && *p != '\n')
+        p++;
+      if (p - fld != 2)
+        ok = false; // truncated field or garbage after checksum
+      else
+      {
+        int hi = hex (fld[0]), lo = hex (fld[1]);
+        ok = ok && hi >= 0 && lo >= 0 && ((hi << 4) | lo) == cks;
+      }
+    }
+    results.push_back ({(size_t)(start - buf), (size_t)(p - start), present, ok});
+    nvalid += ok;
+  }
+  return nvalid;
+}
+
 /*!
   NMEA-0183 DBS sentence.
 
@@ -134,35 +419,35 @@ int dbs (const char* buf, double* depth)
   ft = mt = fh = false;
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "DBS", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "DBS"))
     return 0;
   NEXT_TOKEN (tok, 0);
-  if (*tok)
+  if (!tok.empty ())
   {
-    feet = atof (tok);
+    feet = to_double (tok);
     ft = true;
   }
   NEXT_TOKEN (tok, 0);
-  if (*tok && *tok != 'f')
+  if (!tok.empty () && chr (tok) != 'f')
     return 0;
   NEXT_TOKEN (tok, 0);
-  if (*tok)
+  if (!tok.empty ())
   {
-    meters = atof (tok);
+    meters = to_double (tok);
     mt = true;
   }
   NEXT_TOKEN (tok, 0);
-  if (*tok && *tok != 'M')
+  if (!tok.empty () && chr (tok) != 'M')
     return 0;
   NEXT_TOKEN (tok, 0);
-  if (*tok)
+  if (!tok.empty ())
   {
-    fathoms = atof (tok);
+    fathoms = to_double (tok);
     fh = true;
   }
   NEXT_TOKEN (tok, 0);
-  if (*tok && *tok != 'F')
+  if (!tok.empty () && chr (tok) != 'F')
     return 0;
 
   if (depth)
@@ -200,35 +485,35 @@ int dbt (const char* buf, double* depth)
   ft = mt = fh = false;
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "DBT", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "DBT"))
     return 0;
   NEXT_TOKEN (tok, 0);
-  if (*tok)
+  if (!tok.empty ())
   {
-    feet = atof (tok);
+    feet = to_double (tok);
     ft = true;
   }
   NEXT_TOKEN (tok, 0);
-  if (*tok && *tok != 'f')
+  if (!tok.empty () && chr (tok) != 'f')
     return 0;
   NEXT_TOKEN (tok, 0);
-  if (*tok)
+  if (!tok.empty ())
   {
-    meters = atof (tok);
+    meters = to_double (tok);
     mt = true;
   }
   NEXT_TOKEN (tok, 0);
-  if (*tok && *tok != 'M')
+  if (!tok.empty () && chr (tok) != 'M')
     return 0;
   NEXT_TOKEN (tok, 0);
-  if (*tok)
+  if (!tok.empty ())
   {
-    fathoms = atof (tok);
+    fathoms = to_double (tok);
     fh = true;
   }
   NEXT_TOKEN (tok, 0);
-  if (*tok && *tok != 'F')
+  if (!tok.empty () && chr (tok) != 'F')
     return 0;
 
   if (depth)
@@ -254,15 +539,15 @@ int dpt (const char* buf, double* depth, double* offset, double* range)
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "DPT", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "DPT"))
     return 0;
   NEXT_VALIDTOKEN (tok, 0);
-  IFPAR (depth, atof (tok));
+  IFPAR (depth, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (offset, atof (tok));
+  IFPAR (offset, to_double (tok));
   NEXT_TOKEN (tok, 2);
-  IFPAR (range, atof (tok));
+  IFPAR (range, to_double (tok));
   return 3;
 }
 
@@ -281,41 +566,41 @@ int gga (const char* buf, double* lat, double* lon, double* time, double* height
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "GGA", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "GGA"))
     return 0;
 
   NEXT_VALIDTOKEN (tok, 0);
-  IFPAR (time, atof (tok));
+  IFPAR (time, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (lat, DM2rad (atof (tok)));
+  IFPAR (lat, latlon (tok));
   NEXT_TOKEN (tok, 0);
-  if (lat && *tok && *tok == 'S')
+  if (lat && chr (tok) == 'S')
     *lat *= -1.;
   NEXT_TOKEN (tok, 0);
-  IFPAR (lon, DM2rad (atof (tok)));
+  IFPAR (lon, latlon (tok));
   NEXT_TOKEN (tok, 0);
-  if (lon && *tok && *tok == 'W')
+  if (lon && chr (tok) == 'W')
     *lon *= -1.;
   NEXT_TOKEN (tok, 0);
-  IFPAR (mode, atoi (tok));
+  IFPAR (mode, to_int (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (sat, atoi (tok));
+  IFPAR (sat, to_int (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (dop, atof (tok));
+  IFPAR (dop, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (height, atof (tok));
+  IFPAR (height, to_double (tok));
   NEXT_TOKEN (tok, 0); //'M'
   NEXT_TOKEN (tok, 0);
-  double val = atof (tok);
+  double val = to_double (tok);
   IFPAR (undul, val);
   if (height)
     *height += val;
   NEXT_TOKEN (tok, 0); //'M'
   NEXT_TOKEN (tok, 2);
-  IFPAR (age, atof (tok));
+  IFPAR (age, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (station, atoi (tok));
+  IFPAR (station, to_int (tok));
   return 3;
 }
 
@@ -337,36 +622,36 @@ int ggk (const char* buf, double* lat, double* lon, double* time, double* height
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "GGK", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "GGK"))
     return 0;
 
   NEXT_VALIDTOKEN (tok, 0);
-  IFPAR (time, atof (tok));
+  IFPAR (time, to_double (tok));
   NEXT_TOKEN (tok, 0); // date
   NEXT_TOKEN (tok, 0);
-  IFPAR (lat, DM2rad (atof (tok)));
+  IFPAR (lat, latlon (tok));
   NEXT_TOKEN (tok, 0);
-  if (lat && *tok && *tok == 'S')
+  if (lat && chr (tok) == 'S')
     *lat *= -1.;
   NEXT_TOKEN (tok, 0);
-  IFPAR (lon, DM2rad (atof (tok)));
+  IFPAR (lon, latlon (tok));
   NEXT_TOKEN (tok, 0);
-  if (lon && *tok && *tok == 'W')
+  if (lon && chr (tok) == 'W')
     *lon *= -1.;
   NEXT_TOKEN (tok, 0);
-  IFPAR (mode, atoi (tok));
+  IFPAR (mode, to_int (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (sat, atoi (tok));
+  IFPAR (sat, to_int (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (dop, atof (tok));
+  IFPAR (dop, to_double (tok));
   NEXT_TOKEN (tok, 1); // height is optional
   if (height)
   {
     // POS MV sends ellipsoidal height prefixed with "EHT"
-    if (!strncmp (tok, "EHT", 3))
-      tok += 3;
-    *height = atof (tok);
+    if (tok.starts_with ("EHT"))
+      tok.remove_prefix (3);
+    *height = to_double (tok);
   }
   return 1;
 }
@@ -386,29 +671,29 @@ int gll (const char* buf, double* lat, double* lon, double* time, int* mode)
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "GLL", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "GLL"))
     return 0;
 
   NEXT_TOKEN (tok, 0);
-  IFPAR (lat, DM2rad (atof (tok)));
+  IFPAR (lat, latlon (tok));
   NEXT_TOKEN (tok, 0);
-  if (lat && *tok && *tok == 'S')
+  if (lat && chr (tok) == 'S')
     *lat *= -1.;
   NEXT_TOKEN (tok, 0);
-  IFPAR (lon, DM2rad (atof (tok)));
+  IFPAR (lon, latlon (tok));
   NEXT_TOKEN (tok, 0);
-  if (lon && *tok && *tok == 'W')
+  if (lon && chr (tok) == 'W')
     *lon *= -1.;
   NEXT_TOKEN (tok, 1);
-  IFPAR (time, atof (tok));
+  IFPAR (time, to_double (tok));
   NEXT_TOKEN (tok, 0);
   NEXT_TOKEN (tok, 2);
   if (mode)
   {
-    if (*tok == 'A')
+    if (chr (tok) == 'A')
       *mode = 1;
-    else if (*tok == 'D')
+    else if (chr (tok) == 'D')
       *mode = 2;
     else
       *mode = 0;
@@ -431,42 +716,42 @@ int gns (const char* buf, double* time, double* lat, double* lon, int* mode, int
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "GNS", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "GNS"))
     return 0;
 
   NEXT_VALIDTOKEN (tok, 0);
-  IFPAR (time, atof (tok));
+  IFPAR (time, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (lat, DM2rad (atof (tok)));
+  IFPAR (lat, latlon (tok));
   NEXT_TOKEN (tok, 0);
-  if (lat && *tok && *tok == 'S')
+  if (lat && chr (tok) == 'S')
     *lat *= -1.;
   NEXT_TOKEN (tok, 0);
-  IFPAR (lon, DM2rad (atof (tok)));
+  IFPAR (lon, latlon (tok));
   NEXT_TOKEN (tok, 0);
-  if (lon && *tok && *tok == 'W')
+  if (lon && chr (tok) == 'W')
     *lon *= -1.;
   NEXT_TOKEN (tok, 0);
-  IFPAR (mode, atoi (tok));
+  IFPAR (mode, to_int (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (sat, atoi (tok));
+  IFPAR (sat, to_int (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (dop, atof (tok));
+  IFPAR (dop, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (height, atof (tok));
+  IFPAR (height, to_double (tok));
   NEXT_TOKEN (tok, 0); //'M'
   NEXT_TOKEN (tok, 0);
   if (height)
   {
-    double undul = atof (tok);
+    double undul = to_double (tok);
     *height += undul;
   }
   NEXT_TOKEN (tok, 0); //'M'
   NEXT_TOKEN (tok, 2);
-  IFPAR (age, atof (tok));
+  IFPAR (age, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (station, atoi (tok));
+  IFPAR (station, to_int (tok));
   return 3;
 }
 
@@ -494,28 +779,28 @@ int gsa (const char* buf, int* hmode, int* fmode, int* sv, double* pdop, double*
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "GSA", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "GSA"))
     return 0;
 
   NEXT_TOKEN (tok, 0);
-  IFPAR (hmode, (*tok == 'A') ? 1 : (*tok == 'M') ? 2 : 0);
+  IFPAR (hmode, (chr (tok) == 'A') ? 1 : (chr (tok) == 'M') ? 2 : 0);
   NEXT_TOKEN (tok, 0);
-  IFPAR (fmode, atoi (tok));
+  IFPAR (fmode, to_int (tok));
   if (sv)
   {
     for (int i = 0; i < 12; i++)
     {
       NEXT_TOKEN (tok, 0);
-      sv[i] = atoi (tok);
+      sv[i] = to_int (tok);
     }
   }
   NEXT_TOKEN (tok, 0);
-  IFPAR (pdop, atof (tok));
+  IFPAR (pdop, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (hdop, atof (tok));
+  IFPAR (hdop, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (vdop, atof (tok));
+  IFPAR (vdop, to_double (tok));
   return 3;
 }
 
@@ -529,25 +814,25 @@ int gst (const char* buf, double* time, double* rms, double* smaj, double* smin,
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "GST", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "GST"))
     return 0;
   NEXT_VALIDTOKEN (tok, 0);
-  IFPAR (time, atof (tok));
+  IFPAR (time, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (rms, atof (tok));
+  IFPAR (rms, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (smaj, atof (tok));
+  IFPAR (smaj, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (smin, atof (tok));
+  IFPAR (smin, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (orient, atof (tok));
+  IFPAR (orient, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (stdlat, atof (tok));
+  IFPAR (stdlat, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (stdlon, atof (tok));
+  IFPAR (stdlon, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (stdh, atof (tok));
+  IFPAR (stdh, to_double (tok));
   return 3;
 }
 
@@ -573,33 +858,33 @@ int gsv (const char* buf, int* tmsg, int* msg, int* count, int* sv, int* az, int
   parse_context ctx (buf);
 
   int nmsg;
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "GSV", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "GSV"))
     return 0;
 
   NEXT_TOKEN (tok, 0);
-  IFPAR (tmsg, atoi (tok));
+  IFPAR (tmsg, to_int (tok));
   NEXT_TOKEN (tok, 0);
-  nmsg = atoi (tok) - 1;
+  nmsg = to_int (tok) - 1;
   if (nmsg < 0 || nmsg > 8)
     return 0;
   IFPAR (msg, nmsg + 1);
   NEXT_TOKEN (tok, 0);
-  IFPAR (count, atoi (tok));
+  IFPAR (count, to_int (tok));
   for (int i = 0; i < 4; i++)
   {
     NEXT_TOKEN (tok, 1);
     if (sv)
-      sv[nmsg * 4 + i] = atoi (tok);
+      sv[nmsg * 4 + i] = to_int (tok);
     NEXT_TOKEN (tok, 0);
     if (elev)
-      elev[nmsg * 4 + i] = atoi (tok);
+      elev[nmsg * 4 + i] = to_int (tok);
     NEXT_TOKEN (tok, 0);
     if (az)
-      az[nmsg * 4 + i] = atoi (tok);
+      az[nmsg * 4 + i] = to_int (tok);
     NEXT_TOKEN (tok, 0);
     if (snr)
-      snr[nmsg * 4 + i] = atoi (tok);
+      snr[nmsg * 4 + i] = to_int (tok);
   }
 
   return 1;
@@ -617,24 +902,24 @@ int gxp (const char* buf, double* lat, double* lon, double* time, int* wp)
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "GXP", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "GXP"))
     return 0;
 
   NEXT_VALIDTOKEN (tok, 0);
-  IFPAR (time, atof (tok));
+  IFPAR (time, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (lat, DM2rad (atof (tok)));
+  IFPAR (lat, latlon (tok));
   NEXT_TOKEN (tok, 0);
-  if (lat && *tok && *tok == 'S')
+  if (lat && chr (tok) == 'S')
     *lat *= -1.;
   NEXT_TOKEN (tok, 0);
-  IFPAR (lon, DM2rad (atof (tok)));
+  IFPAR (lon, latlon (tok));
   NEXT_TOKEN (tok, 0);
-  if (lon && *tok && *tok == 'W')
+  if (lon && chr (tok) == 'W')
     *lon *= -1.;
   NEXT_TOKEN (tok, 0);
-  IFPAR (wp, atoi (tok));
+  IFPAR (wp, to_int (tok));
   return 1;
 }
 
@@ -650,20 +935,20 @@ int hdg (const char* buf, double* head, double* dev, double* var)
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "HDG", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "HDG"))
     return 0;
   NEXT_VALIDTOKEN (tok, 0);
-  IFPAR (head, atof (tok) * D2R);
+  IFPAR (head, to_double (tok) * D2R);
   NEXT_TOKEN (tok, 0);
-  IFPAR (dev, atof (tok) * D2R);
+  IFPAR (dev, to_double (tok) * D2R);
   NEXT_TOKEN (tok, 0);
-  if (dev && *tok == 'W')
+  if (dev && chr (tok) == 'W')
     *dev *= -1.;
   NEXT_TOKEN (tok, 0);
-  IFPAR (var, atof (tok) * D2R);
+  IFPAR (var, to_double (tok) * D2R);
   NEXT_TOKEN (tok, 0);
-  if (var && *tok == 'W')
+  if (var && chr (tok) == 'W')
     *var *= -1.;
   return 3;
 }
@@ -680,13 +965,13 @@ int hdm (const char* buf, double* head)
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "HDM", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "HDM"))
     return 0;
   NEXT_VALIDTOKEN (tok, 0);
-  IFPAR (head, atof (tok) * D2R);
+  IFPAR (head, to_double (tok) * D2R);
   NEXT_TOKEN (tok, 0);
-  if (*tok && *tok != 'M')
+  if (!tok.empty () && chr (tok) != 'M')
     return 0;
   return 2;
 }
@@ -702,13 +987,13 @@ int hdt (const char* buf, double* head)
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "HDT", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "HDT"))
     return 0;
   NEXT_VALIDTOKEN (tok, 0);
-  IFPAR (head, atof (tok) * D2R);
+  IFPAR (head, to_double (tok) * D2R);
   NEXT_TOKEN (tok, 0);
-  if (*tok && *tok != 'T')
+  if (!tok.empty () && chr (tok) != 'T')
     return 0;
   return 2;
 }
@@ -742,33 +1027,33 @@ int llq (const char* buf, double* time, double* x, double* y, int* mode, int* sa
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "LLQ", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "LLQ"))
     return 0;
 
   NEXT_TOKEN (tok, 0);
-  IFPAR (time, atof (tok));
+  IFPAR (time, to_double (tok));
   NEXT_TOKEN (tok, 0);
   NEXT_TOKEN (tok, 0); // date
-  IFPAR (x, atof (tok));
+  IFPAR (x, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  if (*tok != 'M')
+  if (chr (tok) != 'M')
     return 0;
   NEXT_TOKEN (tok, 0);
-  IFPAR (y, atof (tok));
+  IFPAR (y, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  if (*tok != 'M')
+  if (chr (tok) != 'M')
     return 0;
   NEXT_TOKEN (tok, 0);
-  IFPAR (mode, atoi (tok));
+  IFPAR (mode, to_int (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (sat, atoi (tok));
+  IFPAR (sat, to_int (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (dop, atof (tok));
+  IFPAR (dop, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (height, atof (tok));
+  IFPAR (height, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  if (*tok != 'M')
+  if (chr (tok) != 'M')
     return 0;
   return 1;
 }
@@ -819,31 +1104,31 @@ int pashr (const char* buf, double* time, double* hdg, double* pitch, double* ro
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok, "$PASHR", 6))
+  std::string_view tok;
+  if (!ctx.token (tok) || !tok.starts_with ("$PASHR"))
     return 0;
   NEXT_TOKEN (tok, 0);
-  IFPAR (time, atof (tok));
+  IFPAR (time, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (hdg, atof (tok) * D2R);
+  IFPAR (hdg, to_double (tok) * D2R);
   NEXT_TOKEN (tok, 0); // T
   NEXT_TOKEN (tok, 0);
-  IFPAR (roll, atof (tok) * D2R);
+  IFPAR (roll, to_double (tok) * D2R);
   NEXT_TOKEN (tok, 0);
-  IFPAR (pitch, atof (tok) * D2R);
+  IFPAR (pitch, to_double (tok) * D2R);
   NEXT_TOKEN (tok, 0);
-  IFPAR (heave, atof (tok));
+  IFPAR (heave, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (roll_std, atof (tok) * D2R);
+  IFPAR (roll_std, to_double (tok) * D2R);
   NEXT_TOKEN (tok, 0);
-  IFPAR (pitch_std, atof (tok) * D2R);
+  IFPAR (pitch_std, to_double (tok) * D2R);
   NEXT_TOKEN (tok, 0);
-  IFPAR (hdg_std, atof (tok) * D2R);
+  IFPAR (hdg_std, to_double (tok) * D2R);
 
   NEXT_TOKEN (tok, 0);
-  IFPAR (flag_h, atoi (tok));
+  IFPAR (flag_h, to_int (tok));
   NEXT_TOKEN (tok, 1);
-  IFPAR (flag_i, atoi (tok));
+  IFPAR (flag_i, to_int (tok));
   return 3;
 }
 
@@ -860,24 +1145,24 @@ int psathpr (const char* buf, double* time, double* head, double* pitch, double*
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok, "$PSAT", 5))
+  std::string_view tok;
+  if (!ctx.token (tok) || !tok.starts_with ("$PSAT"))
     return 0;
   NEXT_TOKEN (tok, 0);
-  if (memcmp (tok, "HPR", 3))
+  if (!tok.starts_with ("HPR"))
     return 0;
   NEXT_VALIDTOKEN (tok, 0);
-  IFPAR (time, atof (tok));
+  IFPAR (time, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (head, atof (tok) * D2R);
+  IFPAR (head, to_double (tok) * D2R);
   NEXT_TOKEN (tok, 0);
-  if (strlen (tok))
-    IFPAR (pitch, atof (tok));
+  if (!tok.empty ())
+    IFPAR (pitch, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  if (strlen (tok))
-    IFPAR (roll, atof (tok));
+  if (!tok.empty ())
+    IFPAR (roll, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (type, tok[0]);
+  IFPAR (type, chr (tok));
   return 3;
 }
 
@@ -926,35 +1211,35 @@ int ptnlggk (const char* buf, double* lat, double* lon, double* time, double* he
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok, "$PTNL", 5))
+  std::string_view tok;
+  if (!ctx.token (tok) || !tok.starts_with ("$PTNL"))
     return 0;
   NEXT_TOKEN (tok, 0);
-  if (memcmp (tok, "GGK", 3))
+  if (!tok.starts_with ("GGK"))
     return 0;
   NEXT_VALIDTOKEN (tok, 0);
-  IFPAR (time, atof (tok));
+  IFPAR (time, to_double (tok));
   NEXT_TOKEN (tok, 0); // date
   NEXT_TOKEN (tok, 0);
-  IFPAR (lat, DM2rad (atof (tok)));
+  IFPAR (lat, latlon (tok));
   NEXT_TOKEN (tok, 0);
-  if (lat && *tok && *tok == 'S')
+  if (lat && chr (tok) == 'S')
     *lat *= -1.;
   NEXT_TOKEN (tok, 0);
-  IFPAR (lon, DM2rad (atof (tok)));
+  IFPAR (lon, latlon (tok));
   NEXT_TOKEN (tok, 0);
-  if (lon && *tok && *tok == 'W')
+  if (lon && chr (tok) == 'W')
     *lon *= -1.;
   NEXT_TOKEN (tok, 0);
-  IFPAR (mode, atoi (tok));
+  IFPAR (mode, to_int (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (sat, atoi (tok));
+  IFPAR (sat, to_int (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (dop, atof (tok));
+  IFPAR (dop, to_double (tok));
   NEXT_TOKEN (tok, 1);
-  if (memcmp (tok, "EHT", 3))
+  if (!tok.starts_with ("EHT"))
     return 0;
-  IFPAR (height, atof (tok + 3));
+  IFPAR (height, to_double (tok.substr (3)));
   return 1;
 }
 
@@ -968,30 +1253,30 @@ int ptnlqa (const char* buf, double* sigman, double* sigmae, double* smaj, doubl
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok, "$PTNL", 5))
+  std::string_view tok;
+  if (!ctx.token (tok) || !tok.starts_with ("$PTNL"))
     return 0;
   NEXT_TOKEN (tok, 0);
-  if (memcmp (tok, "QA", 2))
+  if (!tok.starts_with ("QA"))
     return 0;
   NEXT_TOKEN (tok, 0); // time??
   NEXT_TOKEN (tok, 0);
-  IFPAR (sigman, atof (tok));
+  IFPAR (sigman, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (sigmae, atof (tok));
+  IFPAR (sigmae, to_double (tok));
   NEXT_TOKEN (tok, 0); // what?
   NEXT_TOKEN (tok, 0);
-  double unit = atof (tok);
+  double unit = to_double (tok);
   if (sigman)
     *sigman *= unit;
   if (sigmae)
     *sigmae *= unit;
   NEXT_TOKEN (tok, 0);
-  IFPAR (smaj, atof (tok));
+  IFPAR (smaj, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (smin, atof (tok));
+  IFPAR (smin, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (orient, atof (tok));
+  IFPAR (orient, to_double (tok));
   return 1;
 }
 
@@ -1005,103 +1290,85 @@ int rmc (const char* buf, double* lat, double* lon, double* time, double* speed,
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "RMC", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "RMC"))
     return 0;
 
   NEXT_VALIDTOKEN (tok, 0);
-  IFPAR (time, atof (tok));
+  IFPAR (time, to_double (tok));
   NEXT_TOKEN (tok, 0); // status
-  if (*tok && *tok != 'A' && *tok != 'V')
+  if (!tok.empty () && chr (tok) != 'A' && chr (tok) != 'V')
     return 0;
   NEXT_TOKEN (tok, 0);
-  IFPAR (lat, DM2rad (atof (tok)));
+  IFPAR (lat, latlon (tok));
   NEXT_TOKEN (tok, 0);
-  if (lat && *tok && *tok == 'S')
+  if (lat && chr (tok) == 'S')
     *lat *= -1.;
   NEXT_TOKEN (tok, 0);
-  IFPAR (lon, DM2rad (atof (tok)));
+  IFPAR (lon, latlon (tok));
   NEXT_TOKEN (tok, 0);
-  if (lon && *tok && *tok == 'W')
+  if (lon && chr (tok) == 'W')
     *lon *= -1.;
   NEXT_TOKEN (tok, 0);
-  IFPAR (speed, atof (tok));
+  IFPAR (speed, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (head, atof (tok) * D2R);
+  IFPAR (head, to_double (tok) * D2R);
   NEXT_TOKEN (tok, 0);
-  IFPAR (date, atoi (tok));
+  IFPAR (date, to_int (tok));
   NEXT_TOKEN (tok, 0); // skip magnetic variation
   NEXT_TOKEN (tok, 0);
-  if (*tok && *tok != 'E' && *tok != 'W')
+  if (!tok.empty () && chr (tok) != 'E' && chr (tok) != 'W')
     return 0;
   NEXT_TOKEN (tok, 2);
-  IFPAR (mode, (*tok == 'A')   ? 1
-               : (*tok == 'D') ? 2
-               : (*tok == 'P') ? 3
-               : (*tok == 'R') ? 4
-               : (*tok == 'F') ? 5
+  IFPAR (mode, (chr (tok) == 'A')   ? 1
+               : (chr (tok) == 'D') ? 2
+               : (chr (tok) == 'P') ? 3
+               : (chr (tok) == 'R') ? 4
+               : (chr (tok) == 'F') ? 5
                                : 0);
   return 3;
 }
 
-/*!
-  NMEA-0183 TTM sentence (Tracked Target message).
-
-  $xxTTM,num,dist,brg,relbrg,speed,course,relcog,cpa,tcpa,units,name,status,ref,hhmmss.ss,acq*hh
-  - num = target number
-  - dist = target distance relative to own ship
-  - brg = target bearing
-  - relbrg = 'T' for true bearing, 'R' for relative
-  - speed = target speed
-  - course = target course
-  - relcog = true/relative course
-  - cpa = distance to closest point of approach
-  - tca = time to CPA
-  - units = speed/distance units ('K' or 'N' or 'S')
-  - name = target name
-  - status = 'L' lost, 'Q' query, 'T' tracking
-  - ref = reference target
-  - hhmmss = UTC time
-  - acq = acquisition status
-*/
-int ttm (const char* buf, double* utc, int* num, char* name, double* dist, double* brg, int* relbrg,
-         double* speed, double* cog, int* relcog, double* cpa, double* tcpa, int* stat)
+// TTM parser with a bounded target name buffer
+static int ttm_parse (const char* buf, double* utc, int* num, char* name, size_t namesz,
+                      double* dist, double* brg, int* relbrg, double* speed, double* cog,
+                      int* relcog, double* cpa, double* tcpa, int* stat)
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "TTM", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "TTM"))
     return 0;
 
   NEXT_TOKEN (tok, 0);
-  if (atoi (tok) < 0)
+  if (to_int (tok) < 0)
     return 0; // garbage
-  IFPAR (num, atoi (tok));
+  IFPAR (num, to_int (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (dist, atof (tok));
+  IFPAR (dist, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (brg, atof (tok));
+  IFPAR (brg, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (relbrg, (*tok == 'R' ? 1 : 0));
+  IFPAR (relbrg, (chr (tok) == 'R' ? 1 : 0));
   NEXT_TOKEN (tok, 0);
-  IFPAR (speed, atof (tok));
+  IFPAR (speed, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (cog, atof (tok));
+  IFPAR (cog, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (relcog, (*tok == 'R' ? 1 : 0));
+  IFPAR (relcog, (chr (tok) == 'R' ? 1 : 0));
   NEXT_TOKEN (tok, 0);
-  IFPAR (cpa, atof (tok));
+  IFPAR (cpa, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  IFPAR (tcpa, atof (tok));
+  IFPAR (tcpa, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  if (*tok == 'K')
+  if (chr (tok) == 'K')
   {
     if (dist)
       *dist *= 1000;
     if (speed)
       *speed /= 3.6;
   }
-  else if (*tok == 'N')
+  else if (chr (tok) == 'N')
   {
     if (dist)
       *dist *= 1852;
@@ -1110,17 +1377,48 @@ int ttm (const char* buf, double* utc, int* num, char* name, double* dist, doubl
   }
   NEXT_TOKEN (tok, 0);
   if (name)
-    strcpy (name, tok);
+  {
+    size_t len = (std::min) (tok.size (), namesz - 1);
+    tok.copy (name, len);
+    name[len] = 0;
+  }
   NEXT_TOKEN (tok, 0);
   if (stat)
-    *stat = (*tok == 'L') ? 1 : (*tok == 'Q') ? 2 : 0;
+    *stat = (chr (tok) == 'L') ? 1 : (chr (tok) == 'Q') ? 2 : 0;
   NEXT_TOKEN (tok, 0); // reference target;
   NEXT_TOKEN (tok, 0);
-  IFPAR (utc, atof (tok));
+  IFPAR (utc, to_double (tok));
 
   return 1;
 }
 
+/*!
+  NMEA-0183 TTM sentence (Tracked Target message).
+
+  $xxTTM,num,dist,brg,relbrg,speed,course,relcog,cpa,tcpa,units,name,status,ref,hhmmss.ss,acq*hh
+  - num = target number
+  - dist = target distance relative to own ship
+  - brg = target bearing
+  - relbrg = 'T' for true bearing, 'R' for relative
+  - speed = target speed
+  - course = target course
+  - relcog = true/relative course
+  - cpa = distance to closest point of approach
+  - tca = time to CPA
+  - units = speed/distance units ('K' or 'N' or 'S')
+  - name = target name
+  - status = 'L' lost, 'Q' query, 'T' tracking
+  - ref = reference target
+  - hhmmss = UTC time
+  - acq = acquisition status
+*/
+int ttm (const char* buf, double* utc, int* num, char* name, double* dist, double* brg, int* relbrg,
+         double* speed, double* cog, int* relcog, double* cpa, double* tcpa, int* stat)
+{
+  return ttm_parse (buf, utc, num, name, SIZE_MAX, dist, brg, relbrg, speed, cog, relcog, cpa, tcpa,
+                    stat);
+}
+
 /*!
   NMEA-0183 VTG sentence.
 
@@ -1133,41 +1431,41 @@ int vtg (const char* buf, double* speed, double* head)
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
+  std::string_view tok;
   bool th, sk;
   th = sk = false;
-  if (!tok || memcmp (tok + 3, "VTG", 3))
+  if (!ctx.token (tok) || !formatter (tok, "VTG"))
     return 0;
 
   NEXT_VALIDTOKEN (tok, 0);
   if (head)
   {
-    *head = atof (tok) * D2R;
+    *head = to_double (tok) * D2R;
     th = true;
   }
   NEXT_TOKEN (tok, 0);
-  if (*tok && *tok != 'T')
+  if (!tok.empty () && chr (tok) != 'T')
     return 0;
   NEXT_TOKEN (tok, 0);
-  if (head && !th && *tok)
-    *head = atof (tok) * D2R;
+  if (head && !th && !tok.empty ())
+    *head = to_double (tok) * D2R;
   NEXT_TOKEN (tok, 0);
-  if (*tok && *tok != 'M')
+  if (!tok.empty () && chr (tok) != 'M')
     return 0;
   NEXT_TOKEN (tok, 0);
-  if (speed && *tok)
+  if (speed && !tok.empty ())
   {
-    *speed = atof (tok);
+    *speed = to_double (tok);
     sk = true;
   }
   NEXT_TOKEN (tok, 0);
-  if (*tok && *tok != 'N')
+  if (!tok.empty () && chr (tok) != 'N')
     return 0;
   NEXT_TOKEN (tok, 0);
-  if (speed && !sk && *tok)
-    *speed = atof (tok) * 0.539957;
+  if (speed && !sk && !tok.empty ())
+    *speed = to_double (tok) * 0.539957;
   NEXT_TOKEN (tok, 0);
-  if (*tok && *tok != 'K')
+  if (!tok.empty () && chr (tok) != 'K')
     return 0;
   return 3;
 }
@@ -1184,26 +1482,747 @@ int zda (const char* buf, double* time, unsigned short* day, unsigned short* mon
 {
   parse_context ctx (buf);
 
-  char* tok = ctx.token ();
-  if (!tok || memcmp (tok + 3, "ZDA", 3))
+  std::string_view tok;
+  if (!ctx.token (tok) || !formatter (tok, "ZDA"))
     return 0;
 
   NEXT_VALIDTOKEN (tok, 0);
-  IFPAR (time, atof (tok));
+  IFPAR (time, to_double (tok));
   NEXT_TOKEN (tok, 0);
-  if (!strlen (tok))
+  if (tok.empty ())
     return 0;
-  IFPAR (day, (unsigned short)atoi (tok));
+  IFPAR (day, (unsigned short)to_int (tok));
   NEXT_TOKEN (tok, 0);
-  if (!strlen (tok))
+  if (tok.empty ())
     return 0;
-  IFPAR (month, (unsigned short)atoi (tok));
+  IFPAR (month, (unsigned short)to_int (tok));
   NEXT_TOKEN (tok, 0);
-  if (!strlen (tok))
+  if (tok.empty ())
     return 0;
-  IFPAR (year, (unsigned short)atoi (tok));
+  IFPAR (year, (unsigned short)to_int (tok));
   return 3;
 }
 
+// Pack a 3-letter sentence formatter into an integer
+static constexpr unsigned fmt_code (const char* f)
+{
+  return ((unsigned)(unsigned char)f[0] << 16) | ((unsigned)(unsigned char)f[1] << 8)
+         | (unsigned char)f[2];
+}
+
+/*!
+  Identify and parse a NMEA-0183 sentence.
+
+  \param buf sentence to parse
+  \return a record with the sentence data or `std::monostate` if sentence
+          type is not supported or the sentence is invalid.
+
+  Sentence type is identified by a single `switch` on the 3-letter formatter
+  (`$ttFFF`) or, for proprietary sentences, on the manufacturer code. The
+  talker ID is not checked. Data is decoded by the parsing function for that
+  sentence type so values and units are the same as those returned by that
+  function.
+
+  Sentence checksum is not verified; use nmea::checksum() for that.
+
+  The sentence must end with \<CR\>, \<LF\> or a null character. Parsing
+  stops at the first of them, so the function can be used directly on the
+  sentences returned by nmea::framer.
+
+  Example:
+\code
+  auto s = nmea::parse (line);
+  if (auto pos = std::get_if<nmea::GGA> (&s))
+    process_position (pos->lat, pos->lon, pos->height);
+  else if (auto hdt = std::get_if<nmea::HDT> (&s))
+    process_heading (hdt->head);
+\endcode
+*/
+sentence parse (const char* buf)
+{
+  if (*buf != '$')
+    return {};
+  // check sentence is long enough without reading past its terminator
+  for (int i = 1; i < 6; i++)
+  {
+    if (!buf[i] || buf[i] == '\r' || buf[i] == '\n' || buf[i] == '*'
+        || (buf[i] == ',' && i < 5))
+      return {};
+  }
+
+  if (buf[1] == 'P')
+  {
+    // proprietary sentences
+    switch (fmt_code (buf + 2))
+    {
+    case fmt_code ("ASH"):
+      if (buf[5] == 'R')
+      {
+        PASHR r{};
+        if (pashr (buf, &r.time, &r.hdg, &r.pitch, &r.roll, &r.heave, &r.roll_std, &r.pitch_std,
+                   &r.hdg_std, &r.flag_h, &r.flag_i))
+          return r;
+      }
+      break;
+
+    case fmt_code ("SAT"):
+    {
+      PSATHPR r{};
+      if (psathpr (buf, &r.time, &r.head, &r.pitch, &r.roll, &r.type))
+        return r;
+      break;
+    }
+
+    case fmt_code ("TNL"):
+      if (buf[5] == ',' && buf[6] == 'G')
+      {
+        PTNLGGK r{};
+        if (ptnlggk (buf, &r.lat, &r.lon, &r.time, &r.height, &r.dop, &r.sat, &r.mode))
+          return r;
+      }
+      else if (buf[5] == ',' && buf[6] == 'Q')
+      {
+        PTNLQA r{};
+        if (ptnlqa (buf, &r.sigman, &r.sigmae, &r.smaj, &r.smin, &r.orient))
+          return r;
+      }
+      break;
+    }
+    return {};
+  }
+
+  switch (fmt_code (buf + 3))
+  {
+  case fmt_code ("DBS"):
+  {
+    DBS r{};
+    if (dbs (buf, &r.depth))
+      return r;
+    break;
+  }
+  case fmt_code ("DBT"):
+  {
+    DBT r{};
+    if (dbt (buf, &r.depth))
+      return r;
+    break;
+  }
+  case fmt_code ("DPT"):
+  {
+    DPT r{};
+    if (dpt (buf, &r.depth, &r.offset, &r.range))
+      return r;
+    break;
+  }
+  case fmt_code ("GGA"):
+  {
+    GGA r{};
+    if (gga (buf, &r.lat, &r.lon, &r.time, &r.height, &r.undul, &r.dop, &r.sat, &r.mode, &r.age,
+             &r.station))
+      return r;
+    break;
+  }
+  case fmt_code ("GGK"):
+  {
+    GGK r{};
+    if (ggk (buf, &r.lat, &r.lon, &r.time, &r.height, &r.dop, &r.sat, &r.mode))
+      return r;
+    break;
+  }
+  case fmt_code ("GLL"):
+  {
+    GLL r{};
+    if (gll (buf, &r.lat, &r.lon, &r.time, &r.mode))
+      return r;
+    break;
+  }
+  case fmt_code ("GNS"):
+  {
+    GNS r{};
+    if (gns (buf, &r.time, &r.lat, &r.lon, &r.mode, &r.sat, &r.dop, &r.height, &r.age,
+             &r.station))
+      return r;
+    break;
+  }
+  case fmt_code ("GSA"):
+  {
+    GSA r{};
+    if (gsa (buf, &r.hmode, &r.fmode, r.sv, &r.pdop, &r.hdop, &r.vdop))
+      return r;
+    break;
+  }
+  case fmt_code ("GST"):
+  {
+    GST r{};
+    if (gst (buf, &r.time, &r.rms, &r.smaj, &r.smin, &r.orient, &r.stdlat, &r.stdlon, &r.stdh))
+      return r;
+    break;
+  }
+  case fmt_code ("GSV"):
+  {
+    // gsv() stores satellite data at an offset given by message number
+    GSV r{};
+    int sv[36]{}, az[36]{}, elev[36]{}, snr[36]{};
+    if (gsv (buf, &r.tmsg, &r.msg, &r.count, sv, az, elev, snr))
+    {
+      int off = (r.msg - 1) * 4;
+      for (int i = 0; i < 4; i++)
+      {
+        r.sv[i] = sv[off + i];
+        r.az[i] = az[off + i];
+        r.elev[i] = elev[off + i];
+        r.snr[i] = snr[off + i];
+      }
+      return r;
+    }
+    break;
+  }
+  case fmt_code ("GXP"):
+  {
+    GXP r{};
+    if (gxp (buf, &r.lat, &r.lon, &r.time, &r.wp))
+      return r;
+    break;
+  }
+  case fmt_code ("HDG"):
+  {
+    HDG r{};
+    if (hdg (buf, &r.head, &r.dev, &r.var))
+      return r;
+    break;
+  }
+  case fmt_code ("HDM"):
+  {
+    HDM r{};
+    if (hdm (buf, &r.head))
+      return r;
+    break;
+  }
+  case fmt_code ("HDT"):
+  {
+    HDT r{};
+    if (hdt (buf, &r.head))
+      return r;
+    break;
+  }
+  case fmt_code ("LLQ"):
+  {
+    LLQ r{};
+    if (llq (buf, &r.time, &r.x, &r.y, &r.mode, &r.sat, &r.dop, &r.height))
+      return r;
+    break;
+  }
+  case fmt_code ("RMC"):
+  {
+    RMC r{};
+    if (rmc (buf, &r.lat, &r.lon, &r.time, &r.speed, &r.head, &r.date, &r.mode))
+      return r;
+    break;
+  }
+  case fmt_code ("TTM"):
+  {
+    TTM r{};
+    if (ttm_parse (buf, &r.utc, &r.num, r.name, sizeof (r.name), &r.dist, &r.brg, &r.relbrg,
+                   &r.speed, &r.cog, &r.relcog, &r.cpa, &r.tcpa, &r.stat))
+      return r;
+    break;
+  }
+  case fmt_code ("VTG"):
+  {
+    VTG r{};
+    if (vtg (buf, &r.speed, &r.head))
+      return r;
+    break;
+  }
+  case fmt_code ("ZDA"):
+  {
+    ZDA r{};
+    if (zda (buf, &r.time, &r.day, &r.month, &r.year))
+      return r;
+    break;
+  }
+  }
+  return {};
+}
+
+// Formatting of NMEA sentences in a caller supplied buffer
+class sentence_writer
+{
+public:
+  sentence_writer (char* buf, size_t sz, const char* talker, const char* fmt);
+  void sep ();
+  void chr (char c);
+  void uint (uint64_t val, int width);
+  void count (long long val, int width, long long maxval);
+  void fixed (double val, int decimals, int width = 1);
+  void time (double hhmmss);
+  void latlon (double rad, int degw, char pos, char neg);
+  size_t finish ();
+
+private:
+  char* start;
+  char* ptr;
+  char* end;
+  bool overflow;
+};
+
+// Start a sentence with the '$', talker ID and formatter
+sentence_writer::sentence_writer (char* buf, size_t sz, const char* talker, const char* fmt)
+  : start (buf)
+  , ptr (buf)
+  , end (buf + sz)
+  , overflow (false)
+{
+  chr ('$');
+  chr (talker[0]);
+  chr (talker[1]);
+  while (*fmt)
+    chr (*fmt++);
+}
+
+// Append a field separator
+inline void sentence_writer::sep ()
+{
+  chr (',');
+}
+
+inline void sentence_writer::chr (char c)
+{
+  if (ptr < end)
+    *ptr++ = c;
+  else
+    overflow = true;
+}
+
+// Append an unsigned integer zero-padded to the given width
+void sentence_writer::uint (uint64_t val, int width)
+{
+  char digits[20];
+  int n = 0;
+  do
+  {
+    digits[n++] = '0' + val % 10;
+    val /= 10;
+  } while (val);
+  while (width-- > n)
+    chr ('0');
+  while (n)
+    chr (digits[--n]);
+}
+
+// Append an integer value. Values outside [0, maxval] interval leave the field empty.
+void sentence_writer::count (long long val, int width, long long maxval)
+{
+  if (val >= 0 && val <= maxval)
+    uint ((uint64_t)val, width);
+}
+
+// Append a fixed-point number. Values that cannot be represented leave the field empty.
+void sentence_writer::fixed (double val, int decimals, int width)
+{
+  if (!(fabs (val) < 1e15 / dbl_pow10[decimals]))
+    return; // NaN, infinite or too large
+  uint64_t n = (uint64_t)llround (fabs (val) * dbl_pow10[decimals]);
+  if (val < 0 && n)
+    chr ('-');
+  uint (n / int_pow10[decimals], width);
+  if (decimals)
+  {
+    chr ('.');
+    uint (n % int_pow10[decimals], decimals);
+  }
+}
+
+/*
+  Append a time value (HHMMSS.sss) as HHMMSS.ss. Rounding is done in
+  centiseconds of day so that it carries into seconds, minutes and hours.
+  Invalid values leave the field empty.
+*/
+void sentence_writer::time (double hhmmss)
+{
+  if (!(hhmmss >= 0 && hhmmss < 240000.))
+    return;
+  int hhmm = (int)(hhmmss / 100.);
+  double secs = (hhmm / 100) * 3600. + (hhmm % 100) * 60. + (hhmmss - hhmm * 100.);
+  uint64_t cs = (uint64_t)llround (secs * 100.) % 8640000; // wrap at midnight
+  uint (cs / 360000, 2);
+  uint (cs / 6000 % 60, 2);
+  uint (cs / 100 % 60, 2);
+  chr ('.');
+  uint (cs % 100, 2);
+}
+
+// Append latitude or longitude as DDMM.mmmmmmm and hemisphere letter
+void sentence_writer::latlon (double rad, int degw, char pos, char neg)
+{
+  const int decimals = 7;
+  double deg = fabs (rad) / D2R;
+  if (!(deg <= 180.))
+  {
+    sep ();
+    return;
+  }
+  // work in units of 10^-7 minutes so rounding carries into degrees
+  uint64_t scale = int_pow10[decimals] * 60;
+  uint64_t n = (uint64_t)llround (deg * scale);
+  uint (n / scale, degw);
+  n %= scale;
+  uint (n / int_pow10[decimals], 2);
+  chr ('.');
+  uint (n % int_pow10[decimals], decimals);
+  sep ();
+  chr (rad < 0 ? neg : pos);
+}
+
+// Add checksum, line terminator and NUL character
+size_t sentence_writer::finish ()
+{
+  static const char hex_digits[] = "0123456789ABCDEF";
+  unsigned char cks = 0;
+  for (char* p = start + 1; p < ptr; p++)
+    cks ^= *p;
+  chr ('*');
+  chr (hex_digits[cks >> 4]);
+  chr (hex_digits[cks & 0x0f]);
+  chr ('\r');
+  chr ('\n');
+  chr ('\0');
+  if (overflow)
+  {
+    if (end > start)
+      *start = 0;
+    return 0;
+  }
+  return ptr - start - 1;
+}
+
+// Heading in degrees, in [0, 360) interval
+static double heading_deg (double rad)
+{
+  double deg = fmod (rad / D2R, 360.);
+  return deg < 0 ? deg + 360. : deg;
+}
+
+/*!
+  \defgroup NMEA-0183-encoders NMEA-0183 sentence encoders
+  \ingroup NMEA-0183
+
+  Encoders produce the sentences understood by the corresponding parsing
+  functions. Sentences are written in the buffer supplied by the caller,
+  without any heap allocation, and are terminated by checksum, \<CR\>\<LF\>
+  and a NUL character.
+
+  All encoders have the same parameters:
+  \param buf    output buffer
+  \param sz     size of output buffer
+  \param r      sentence data in the same units as returned by the parsing
+                function
+  \param talker 2-letter talker ID
+  \return length of sentence (without the terminating NUL) or 0 if buffer is
+          too small
+
+  Latitudes and longitudes are written with 7 decimals of minutes (about
+  0.2 mm). Times are rounded to hundredths of a second. Fields that cannot be
+  represented, such as NaN values or negative counts, are left empty.
+*/
+
+/*!
+  \ingroup NMEA-0183-encoders
+  $ttGGA,hhmmss.ss,llll.lllllll,a,yyyyy.yyyyyyy,a,q,ss,d.d,h.hhh,M,u.uuu,M,[age],[sta]*hh
+
+  Age of differential corrections and station ID are written only if age is
+  not 0.
+*/
+size_t encode (char* buf, size_t sz, const GGA& r, const char* talker)
+{
+  sentence_writer w (buf, sz, talker, "GGA");
+  w.sep ();
+  w.time (r.time);
+  w.sep ();
+  w.latlon (r.lat, 2, 'N', 'S');
+  w.sep ();
+  w.latlon (r.lon, 3, 'E', 'W');
+  w.sep ();
+  w.count (r.mode, 1, 9);
+  w.sep ();
+  w.count (r.sat, 2, 99);
+  w.sep ();
+  w.fixed (r.dop, 1);
+  w.sep ();
+  w.fixed (r.height - r.undul, 3);
+  w.sep ();
+  w.chr ('M');
+  w.sep ();
+  w.fixed (r.undul, 3);
+  w.sep ();
+  w.chr ('M');
+  w.sep ();
+  if (r.age)
+  {
+    w.fixed (r.age, 1);
+    w.sep ();
+    w.count (r.station, 4, 9999);
+  }
+  else
+    w.sep ();
+  return w.finish ();
+}
+
+/*!
+  \ingroup NMEA-0183-encoders
+  $ttHDT,hhh.hh,T*hh
+*/
+size_t encode (char* buf, size_t sz, const HDT& r, const char* talker)
+{
+  sentence_writer w (buf, sz, talker, "HDT");
+  w.sep ();
+  w.fixed (heading_deg (r.head), 2);
+  w.sep ();
+  w.chr ('T');
+  return w.finish ();
+}
+
+/*!
+  \ingroup NMEA-0183-encoders
+  $ttRMC,hhmmss.ss,s,llll.lllllll,a,yyyyy.yyyyyyy,a,x.xxx,x.xx,ddmmyy,,,m*hh
+
+  Status is 'A' if mode is not 0 and 'V' otherwise. Mode letter is generated
+  from the numerical mode value (1 = 'A', 2 = 'D', 3 = 'P', 4 = 'R', 5 = 'F',
+  others = 'N').
+*/
+size_t encode (char* buf, size_t sz, const RMC& r, const char* talker)
+{
+  static const char modes[] = "NADPRF";
+  sentence_writer w (buf, sz, talker, "RMC");
+  w.sep ();
+  w.time (r.time);
+  w.sep ();
+  w.chr (r.mode ? 'A' : 'V');
+  w.sep ();
+  w.latlon (r.lat, 2, 'N', 'S');
+  w.sep ();
+  w.latlon (r.lon, 3, 'E', 'W');
+  w.sep ();
+  w.fixed (r.speed, 3);
+  w.sep ();
+  w.fixed (heading_deg (r.head), 2);
+  w.sep ();
+  w.count (r.date, 6, 311299);
+  w.sep ();
+  w.sep ();
+  w.sep ();
+  w.chr (r.mode > 0 && r.mode < 6 ? modes[r.mode] : 'N');
+  return w.finish ();
+}
+
+/*!
+  \ingroup NMEA-0183-encoders
+  $ttVTG,hhh.hh,T,,M,x.xxx,N,x.xxx,K*hh
+*/
+size_t encode (char* buf, size_t sz, const VTG& r, const char* talker)
+{
+  sentence_writer w (buf, sz, talker, "VTG");
+  w.sep ();
+  w.fixed (heading_deg (r.head), 2);
+  w.sep ();
+  w.chr ('T');
+  w.sep ();
+  w.sep ();
+  w.chr ('M');
+  w.sep ();
+  w.fixed (r.speed, 3);
+  w.sep ();
+  w.chr ('N');
+  w.sep ();
+  w.fixed (r.speed * 1.852, 3);
+  w.sep ();
+  w.chr ('K');
+  return w.finish ();
+}
+
+/*!
+  \ingroup NMEA-0183-encoders
+  $ttZDA,hhmmss.ss,dd,mm,yyyy,,*hh
+*/
+size_t encode (char* buf, size_t sz, const ZDA& r, const char* talker)
+{
+  sentence_writer w (buf, sz, talker, "ZDA");
+  w.sep ();
+  w.time (r.time);
+  w.sep ();
+  w.count (r.day, 2, 31);
+  w.sep ();
+  w.count (r.month, 2, 12);
+  w.sep ();
+  w.count (r.year, 4, 9999);
+  w.sep ();
+  w.sep ();
+  return w.finish ();
+}
+
+/*!
+  \class framer
+
+  The framer accepts data in chunks of arbitrary size, as they are received
+  from a serial port, a socket or a file, and splits them into sentences.
+  A sentence starts with a '$' or '!' character and ends with \<CR\> and/or
+  \<LF\>. Any bytes outside a sentence are discarded. If a start character
+  is found inside a sentence, the incomplete sentence is discarded and the
+  framer resynchronizes on the new start character.
+
+  Sentences with an incorrect checksum and sentences longer than the maximum
+  length are discarded. The framer keeps counters for discarded data.
+
+  Returned sentences do not include the line terminator. If a sentence is
+  completely contained in one chunk, the returned view points inside that
+  chunk and no data is copied. Otherwise the sentence is assembled in an
+  internal buffer. In both cases, the view is followed by a line terminator
+  so its data can be passed directly to any of the parsing functions.
+
+  Example:
+\code
+  nmea::framer fr;
+  char buf[1024];
+  size_t len;
+  while ((len = s.recv (buf, sizeof (buf))) > 0)
+  {
+    fr.push (buf, len);
+    std::string_view sentence;
+    while (fr.next (sentence))
+      process (nmea::parse (sentence.data ()));
+  }
+\endcode
+*/
+
+/*!
+  \param max_length maximum sentence length, excluding line terminator
+  \param need_checksum if `true` sentences without a checksum are discarded
+
+  NMEA-0183 standard limits sentences to 82 characters, including line
+  terminator, but many proprietary sentences are longer than that.
+*/
+framer::framer (size_t max_length, bool need_checksum)
+  : chunk (nullptr)
+  , chunk_len (0)
+  , pos (0)
+  , seg (0)
+  , in_sentence (false)
+  , maxlen (max_length)
+  , need_cks (need_checksum)
+  , st{}
+{}
+
+/*!
+  Sentences returned by previous calls to next() must have been processed
+  before calling this function. The data chunk must remain valid until next()
+  returns `false`.
+*/
+void framer::push (const char* data, size_t len)
+{
+  chunk = data;
+  chunk_len = len;
+  pos = seg = 0;
+}
+
+/*!
+  \param sentence view of next sentence
+  \return `true` if a sentence was found or `false` if more data is needed
+
+  Returned view is valid until the next call to push() or next().
+*/
+bool framer::next (std::string_view& sentence)
+{
+  while (pos < chunk_len)
+  {
+    if (!in_sentence)
+    {
+      // look for start of sentence
+      while (pos < chunk_len && chunk[pos] != '$' && chunk[pos] != '!')
+      {
+        if (chunk[pos] != '\r' && chunk[pos] != '\n')
+          st.dropped++;
+        pos++;
+      }
+      if (pos == chunk_len)
+        return false;
+      in_sentence = true;
+      partial.clear ();
+      seg = pos++;
+    }
+
+    // look for end of sentence
+    while (pos < chunk_len)
+    {
+      char c = chunk[pos];
+      if (c == '\r' || c == '\n')
+        break;
+      if (c == '$' || c == '!')
+      {
+        // resynchronize on new start character
+        st.dropped += partial.size () + pos - seg;
+        partial.clear ();
+        seg = pos;
+      }
+      else if (partial.size () + pos - seg >= maxlen)
+      {
+        st.overlong++;
+        st.dropped += partial.size () + pos - seg;
+        in_sentence = false;
+        break;
+      }
+      pos++;
+    }
+    if (!in_sentence)
+      continue;
+    if (pos == chunk_len)
+    {
+      // sentence continues in next chunk
+      partial.append (chunk + seg, pos - seg);
+      return false;
+    }
+
+    in_sentence = false;
+    if (partial.empty ())
+      sentence = std::string_view (chunk + seg, pos - seg);
+    else
+    {
+      partial.append (chunk + seg, pos - seg);
+      partial.push_back ('\r');
+      sentence = std::string_view (partial.data (), partial.size () - 1);
+    }
+    pos++;
+    if (valid (sentence))
+    {
+      st.sentences++;
+      return true;
+    }
+    st.bad_checksum++;
+  }
+  return false;
+}
+
+void framer::reset ()
+{
+  chunk = nullptr;
+  chunk_len = pos = seg = 0;
+  in_sentence = false;
+  partial.clear ();
+  st = stats{};
+}
+
+// Verify sentence checksum
+bool framer::valid (std::string_view s) const
+{
+  const char* end = s.data () + s.size ();
+  const char* p = s.data () + 1;
+  unsigned char cks = xor_scan (p, end);
+  if (p == end)
+    return !need_cks;
+  if (*p != '*' || end - p != 3)
+    return false;
+  int hi = hex (p[1]), lo = hex (p[2]);
+  return hi >= 0 && lo >= 0 && ((hi << 4) | lo) == cks;
+}
+
 /// @}
 } // namespace mlib
@@ -0,0 +1,338 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <math.h>
+
+namespace mlib::nmea {
+
+/*! \addtogroup NMEA-0183
+ @{
+*/
+
+// Convert HHMMSS.sss to seconds since midnight
+static double hms2sec (double hhmmss)
+{
+  int hhmm = (int)(hhmmss / 100.);
+  return (hhmm / 100) * 3600. + (hhmm % 100) * 60. + (hhmmss - hhmm * 100.);
+}
+
+/*
+  Difference in milliseconds between two times of day, taking into account
+  midnight rollover. Times are compared in whole milliseconds so that epochs
+  exactly one tolerance apart are not affected by round-off errors.
+*/
+static long long time_diff (double t1, double t2)
+{
+  long long d = llround ((t1 - t2) * 1000.);
+  if (d < -43200000)
+    d += 86400000;
+  else if (d > 43200000)
+    d -= 86400000;
+  return d;
+}
+
+/*!
+  \class epoch_assembler
+
+  Sentences produced by a GNSS receiver for one epoch (GGA, GST, GSA, HDT,
+  PASHR and ZDA) are merged in a single nmea::fix record. Sentences that carry
+  a UTC time (GGA, GST, PASHR and ZDA) are assigned to an epoch if their time
+  differs from the epoch time by less than the tolerance. Sentences without
+  time (GSA and HDT) are assigned to the epoch being assembled. If there is no
+  such epoch because the previous one has just been produced, they are
+  counted as untimed and ignored. Only at the beginning of data, a sentence
+  without time starts a new epoch.
+
+  An epoch is produced as soon as all expected sentence types have been
+  received, or when a sentence for a newer epoch arrives. Sentences that
+  arrive after their epoch has been produced are counted as late and
+  ignored.
+
+  Sentences can be added by multiple producer threads (for instance one for
+  each data stream). Produced fixes are placed in a bounded lock-free queue
+  from where they can be retrieved by any number of consumer threads. If the
+  queue is full, new fixes are dropped and counted as overflow.
+
+  Example:
+\code
+  nmea::epoch_assembler ea (nmea::fix::gga | nmea::fix::gst | nmea::fix::hdt);
+  // producer thread
+  while (fr.next (sentence))
+    ea.add (sentence.data ());
+
+  // consumer thread
+  nmea::fix f;
+  while (ea.next (f))
+    process (f);
+\endcode
+*/
+
+/*!
+  \param expected_ combination of fix::source flags for sentences expected in
+                   each epoch
+  \param tolerance_ time difference (in seconds) between sentences of the same
+                   epoch must be less than this value
+  \param queue_size size of output queue. It is rounded up to a power of 2.
+
+  The tolerance must be less than half of the interval between epochs. To
+  keep the default value usable with fast receivers, the tolerance is also
+  limited to half of the observed interval between the last two epochs.
+*/
+epoch_assembler::epoch_assembler (unsigned int expected_, double tolerance_, size_t queue_size)
+  : expected (expected_)
+  , tolerance (tolerance_)
+  , pending (false)
+  , current{}
+  , epoch_secs (NAN)
+  , last_secs (NAN)
+  , interval (0)
+  , st{}
+  , total_latency (0)
+  , enqueue_pos (0)
+  , dequeue_pos (0)
+{
+  size_t sz = 2;
+  while (sz < queue_size)
+    sz <<= 1;
+  cells.reset (new cell[sz]);
+  for (size_t i = 0; i < sz; i++)
+    cells[i].seq.store (i, std::memory_order_relaxed);
+  mask = sz - 1;
+}
+
+/*!
+  Sentences types other than GGA, GST, GSA, HDT, PASHR and ZDA are ignored.
+*/
+void epoch_assembler::add (const sentence& s)
+{
+  double t = NAN;
+  unsigned int src;
+  if (auto r = std::get_if<GGA> (&s))
+    t = r->time, src = fix::gga;
+  else if (auto r = std::get_if<GST> (&s))
+    t = r->time, src = fix::gst;
+  else if (auto r = std::get_if<PASHR> (&s))
+    t = r->time, src = fix::pashr;
+  else if (auto r = std::get_if<ZDA> (&s))
+    t = r->time, src = fix::zda;
+  else if (std::holds_alternative<GSA> (s))
+    src = fix::gsa;
+  else if (std::holds_alternative<HDT> (s))
+    src = fix::hdt;
+  else
+    return;
+
+  std::lock_guard<std::mutex> guard (lock);
+  long long limit = llround (tolerance * 1000.);
+  if (interval)
+    limit = (std::min) (limit, interval / 2);
+  if (!isnan (t))
+  {
+    double secs = hms2sec (t);
+    if (!isnan (last_secs) && time_diff (secs, last_secs) < limit)
+    {
+      st.late++;
+      return;
+    }
+    if (!pending)
+      open (secs);
+    else if (isnan (epoch_secs))
+      epoch_secs = secs; // epoch was opened by a sentence without time
+    else
+    {
+      long long d = time_diff (secs, epoch_secs);
+      if (d >= limit)
+      {
+        emit ();
+        open (secs);
+      }
+      else if (d <= -limit)
+      {
+        st.late++;
+        return;
+      }
+    }
+    if (!(current.have & (fix::gga | fix::zda)) || src == fix::gga)
+      current.time = t;
+  }
+  else if (!pending)
+  {
+    if (!isnan (last_secs))
+    {
+      st.untimed++; // belongs to the epoch just produced
+      return;
+    }
+    open (NAN);
+  }
+
+  current.have |= src;
+  switch (src)
+  {
+  case fix::gga:
+  {
+    auto& r = std::get<GGA> (s);
+    current.lat = r.lat;
+    current.lon = r.lon;
+    current.height = r.height;
+    current.undul = r.undul;
+    current.dop = r.dop;
+    current.age = r.age;
+    current.sat = r.sat;
+    current.mode = r.mode;
+    current.station = r.station;
+    break;
+  }
+  case fix::gst:
+  {
+    auto& r = std::get<GST> (s);
+    current.rms = r.rms;
+    current.smaj = r.smaj;
+    current.smin = r.smin;
+    current.orient = r.orient;
+    current.stdlat = r.stdlat;
+    current.stdlon = r.stdlon;
+    current.stdh = r.stdh;
+    break;
+  }
+  case fix::gsa:
+  {
+    auto& r = std::get<GSA> (s);
+    current.fmode = r.fmode;
+    memcpy (current.sv, r.sv, sizeof (current.sv));
+    current.pdop = r.pdop;
+    current.hdop = r.hdop;
+    current.vdop = r.vdop;
+    break;
+  }
+  case fix::hdt:
+    current.heading = std::get<HDT> (s).head;
+    break;
+  case fix::pashr:
+  {
+    auto& r = std::get<PASHR> (s);
+    if (!(current.have & fix::hdt))
+      current.heading = r.hdg;
+    current.pitch = r.pitch;
+    current.roll = r.roll;
+    current.heave = r.heave;
+    break;
+  }
+  case fix::zda:
+  {
+    auto& r = std::get<ZDA> (s);
+    current.day = r.day;
+    current.month = r.month;
+    current.year = r.year;
+    break;
+  }
+  }
+
+  if ((current.have & expected) == expected && !isnan (epoch_secs))
+    emit ();
+}
+
+void epoch_assembler::add (const char* buf)
+{
+  add (parse (buf));
+}
+
+/*!
+  Call this function at the end of data, or if no data has been received for
+  a while, to produce the last epoch.
+*/
+void epoch_assembler::flush ()
+{
+  std::lock_guard<std::mutex> guard (lock);
+  emit ();
+}
+
+/*!
+  \param f next fix
+  \return `false` if there are no fixes available
+
+  This function can be called concurrently from multiple threads.
+*/
+bool epoch_assembler::next (fix& f)
+{
+  cell* c;
+  size_t pos = dequeue_pos.load (std::memory_order_relaxed);
+  for (;;)
+  {
+    c = &cells[pos & mask];
+    size_t seq = c->seq.load (std::memory_order_acquire);
+    auto diff = (intptr_t)seq - (intptr_t)(pos + 1);
+    if (diff == 0)
+    {
+      if (dequeue_pos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+      return false; // queue is empty
+    else
+      pos = dequeue_pos.load (std::memory_order_relaxed);
+  }
+  f = c->data;
+  c->seq.store (pos + mask + 1, std::memory_order_release);
+  return true;
+}
+
+epoch_assembler::stats epoch_assembler::statistics () const
+{
+  std::lock_guard<std::mutex> guard (lock);
+  stats s = st;
+  s.latency = st.epochs ? total_latency / st.epochs : 0;
+  return s;
+}
+
+// Start a new epoch. Must be called with lock held.
+void epoch_assembler::open (double secs)
+{
+  pending = true;
+  current = fix{};
+  epoch_secs = secs;
+  first_arrival = clock::now ();
+}
+
+// Produce current epoch. Must be called with lock held.
+void epoch_assembler::emit ()
+{
+  if (!pending)
+    return;
+  current.latency = std::chrono::duration<double> (clock::now () - first_arrival).count ();
+  st.epochs++;
+  if ((current.have & expected) == expected)
+    st.complete++;
+  total_latency += current.latency;
+  if (current.latency > st.max_latency)
+    st.max_latency = current.latency;
+  if (!push (current))
+    st.overflow++;
+  if (!isnan (epoch_secs))
+  {
+    if (!isnan (last_secs) && time_diff (epoch_secs, last_secs) > 0)
+      interval = time_diff (epoch_secs, last_secs);
+    last_secs = epoch_secs;
+  }
+  pending = false;
+}
+
+// Place a fix in the output queue. There is only one producer at a time.
+bool epoch_assembler::push (const fix& f)
+{
+  size_t pos = enqueue_pos.load (std::memory_order_relaxed);
+  cell& c = cells[pos & mask];
+  if (c.seq.load (std::memory_order_acquire) != pos)
+    return false; // queue is full
+  c.data = f;
+  c.seq.store (pos + 1, std::memory_order_release);
+  enqueue_pos.store (pos + 1, std::memory_order_relaxed);
+  return true;
+}
+
+///@}
+} // namespace mlib::nmea
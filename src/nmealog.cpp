@@ -0,0 +1,331 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <algorithm>
+#include <chrono>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <utf8/utf8.h>
+#include <variant>
+
+namespace mlib::nmea {
+
+/*! \addtogroup NMEA-0183
+ @{
+*/
+
+// Decoding results for one chunk of a log file
+struct chunk_result
+{
+  log_table tbl;
+  size_t decoded = 0;
+  size_t invalid = 0;
+  framer::stats st{};
+  bool timed = false;     // found a sentence with time
+  double last_time = NAN; // time of last sentence with time
+  size_t leading_hdt = 0; // HDT sentences before first sentence with time
+};
+
+/*
+  Store a parsed sentence in the table. HDT sentences are stored with the time
+  of the most recent sentence that has a time field.
+*/
+static bool store (chunk_result& res, const sentence& s)
+{
+  auto& tbl = res.tbl;
+  std::visit (
+    [&res] (auto& r) {
+      if constexpr (requires { r.time; })
+      {
+        res.timed = true;
+        res.last_time = r.time;
+      }
+    },
+    s);
+
+  if (auto r = std::get_if<GGA> (&s))
+  {
+    auto& c = tbl.gga;
+    c.time.push_back (r->time);
+    c.lat.push_back (r->lat);
+    c.lon.push_back (r->lon);
+    c.height.push_back (r->height);
+    c.undul.push_back (r->undul);
+    c.dop.push_back (r->dop);
+    c.age.push_back (r->age);
+    c.quality.push_back (r->mode);
+    c.sat.push_back (r->sat);
+    c.station.push_back (r->station);
+  }
+  else if (auto r = std::get_if<GST> (&s))
+  {
+    auto& c = tbl.gst;
+    c.time.push_back (r->time);
+    c.rms.push_back (r->rms);
+    c.smaj.push_back (r->smaj);
+    c.smin.push_back (r->smin);
+    c.orient.push_back (r->orient);
+    c.stdlat.push_back (r->stdlat);
+    c.stdlon.push_back (r->stdlon);
+    c.stdh.push_back (r->stdh);
+  }
+  else if (auto r = std::get_if<HDT> (&s))
+  {
+    tbl.hdt.time.push_back (res.last_time);
+    tbl.hdt.head.push_back (r->head);
+    if (!res.timed)
+      res.leading_hdt++;
+  }
+  else
+    return false;
+  return true;
+}
+
+// Decode all sentences in a chunk of data
+static void decode_chunk (const char* data, size_t len, const std::string& tail,
+                          chunk_result& res)
+{
+  framer fr (256);
+  std::string_view s;
+  auto drain = [&] () {
+    while (fr.next (s))
+    {
+      auto rec = parse (s.data ());
+      if (rec.index () == 0)
+        res.invalid++;
+      else if (store (res, rec))
+        res.decoded++;
+    }
+  };
+
+  fr.push (data, len);
+  drain ();
+  if (!tail.empty ())
+  {
+    fr.push (tail.data (), tail.size ());
+    drain ();
+  }
+  res.st = fr.statistics ();
+}
+
+/*!
+  \param fname    name of log file
+  \param tbl      table where decoded data is appended
+  \param stats    pointer to decoding statistics (can be `nullptr`)
+  \param nthreads number of worker threads. If 0, the number of hardware
+                  threads is used.
+  \return error code if file cannot be opened
+
+  The log file is memory-mapped and split at line boundaries into chunks that
+  are decoded in parallel. Each sentence is validated, identified and parsed
+  using nmea::framer and nmea::parse(). Data from GGA, GST and HDT sentences is
+  appended to the table columns in the same order as in the file. Other
+  sentence types are counted but ignored. HDT sentences don't have a time
+  field; their time column is filled with the time of the most recent sentence
+  that has one, or NaN if there is no such sentence.
+
+  Example:
+\code
+  nmea::log_table tbl;
+  nmea::log_stats st;
+  nmea::decode_log ("survey.nmea", tbl, &st);
+  printf ("%zu positions, %.0f sentences/sec\n", tbl.gga.time.size (), st.rate ());
+\endcode
+*/
+erc decode_log (const std::string& fname, log_table& tbl, log_stats* stats,
+                unsigned int nthreads)
+{
+  auto t0 = std::chrono::steady_clock::now ();
+  mapped_file mf (fname);
+  if (mf.error)
+    return erc (mf.error);
+
+  if (!nthreads)
+    nthreads = (std::max) (std::thread::hardware_concurrency (), 1u);
+
+  // Don't bother splitting small files
+  const size_t min_chunk = 1024 * 1024;
+  size_t nchunks = (std::min) ((size_t)nthreads, mf.size / min_chunk + 1);
+
+  // Split at line boundaries
+  std::vector<size_t> bounds{0};
+  for (size_t i = 1; i < nchunks; i++)
+  {
+    size_t b = (std::max) (mf.size * i / nchunks, bounds.back ());
+    while (b < mf.size && mf.data[b] != '\n')
+      b++;
+    if (b < mf.size)
+      b++;
+    bounds.push_back (b);
+  }
+  bounds.push_back (mf.size);
+
+  // An unterminated last line is copied with a terminator so it can be decoded
+  size_t end = mf.size;
+  while (end > bounds[nchunks - 1] && mf.data[end - 1] != '\n' && mf.data[end - 1] != '\r')
+    end--;
+  std::string tail;
+  if (end < mf.size)
+  {
+    tail.assign (mf.data + end, mf.size - end);
+    tail.push_back ('\n');
+    bounds[nchunks] = end;
+  }
+
+  std::vector<chunk_result> results (nchunks);
+  std::vector<std::thread> workers;
+  static const std::string no_tail;
+  for (size_t i = 0; i < nchunks; i++)
+  {
+    workers.emplace_back (decode_chunk, mf.data + bounds[i], bounds[i + 1] - bounds[i],
+                          std::cref (i == nchunks - 1 ? tail : no_tail), std::ref (results[i]));
+  }
+  for (auto& w : workers)
+    w.join ();
+
+  log_stats st{};
+  double last_time = NAN;
+  for (auto& r : results)
+  {
+    // HDT sentences at beginning of chunk get time from previous chunks
+    std::fill_n (r.tbl.hdt.time.begin (), r.leading_hdt, last_time);
+    if (r.timed)
+      last_time = r.last_time;
+    tbl.append (r.tbl);
+    st.sentences += r.st.sentences;
+    st.bad_checksum += r.st.bad_checksum + r.st.overlong;
+    st.dropped += r.st.dropped;
+    st.decoded += r.decoded;
+    st.invalid += r.invalid;
+  }
+  st.seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - t0).count ();
+  if (stats)
+    *stats = st;
+  return erc::success;
+}
+
+void log_table::clear ()
+{
+  *this = log_table ();
+}
+
+// Append a column at the end of another one
+template <typename T>
+static void append_column (std::vector<T>& to, const std::vector<T>& from)
+{
+  to.insert (to.end (), from.begin (), from.end ());
+}
+
+void log_table::append (const log_table& other)
+{
+  append_column (gga.time, other.gga.time);
+  append_column (gga.lat, other.gga.lat);
+  append_column (gga.lon, other.gga.lon);
+  append_column (gga.height, other.gga.height);
+  append_column (gga.undul, other.gga.undul);
+  append_column (gga.dop, other.gga.dop);
+  append_column (gga.age, other.gga.age);
+  append_column (gga.quality, other.gga.quality);
+  append_column (gga.sat, other.gga.sat);
+  append_column (gga.station, other.gga.station);
+
+  append_column (gst.time, other.gst.time);
+  append_column (gst.rms, other.gst.rms);
+  append_column (gst.smaj, other.gst.smaj);
+  append_column (gst.smin, other.gst.smin);
+  append_column (gst.orient, other.gst.orient);
+  append_column (gst.stdlat, other.gst.stdlat);
+  append_column (gst.stdlon, other.gst.stdlon);
+  append_column (gst.stdh, other.gst.stdh);
+
+  append_column (hdt.time, other.hdt.time);
+  append_column (hdt.head, other.hdt.head);
+}
+
+static const char log_magic[8] = {'N', 'M', 'E', 'A', 'C', 'O', 'L', '2'};
+
+// Call a function for each column of a table
+template <class T, class F>
+static bool for_columns (T& tbl, F f)
+{
+  return f (tbl.gga.time) && f (tbl.gga.lat) && f (tbl.gga.lon) && f (tbl.gga.height)
+         && f (tbl.gga.undul) && f (tbl.gga.dop) && f (tbl.gga.age) && f (tbl.gga.quality)
+         && f (tbl.gga.sat) && f (tbl.gga.station) && f (tbl.gst.time) && f (tbl.gst.rms)
+         && f (tbl.gst.smaj) && f (tbl.gst.smin) && f (tbl.gst.orient) && f (tbl.gst.stdlat)
+         && f (tbl.gst.stdlon) && f (tbl.gst.stdh) && f (tbl.hdt.time) && f (tbl.hdt.head);
+}
+
+/*!
+  The file contains a signature followed by each column stored as a 64-bit
+  element count and the raw values in native byte order.
+*/
+erc log_table::write (const std::string& fname) const
+{
+#ifdef _WIN32
+  FILE* f = utf8::fopen (fname, "wb");
+#else
+  FILE* f = fopen (fname.c_str (), "wb");
+#endif
+  if (!f)
+    return erc (errno);
+
+  bool ok = fwrite (log_magic, sizeof (log_magic), 1, f) == 1
+            && for_columns (*this, [f] (const auto& col) {
+                 uint64_t n = col.size ();
+                 return fwrite (&n, sizeof (n), 1, f) == 1
+                        && (!n || fwrite (col.data (), sizeof (col[0]), n, f) == n);
+               });
+  ok = !fclose (f) && ok;
+  return ok ? erc::success : erc (EIO);
+}
+
+/*!
+  Previous content of table is replaced by data from file. If the file is not
+  a valid table file, or it is truncated, the function returns EINVAL and the
+  table is left empty.
+*/
+erc log_table::read (const std::string& fname)
+{
+#ifdef _WIN32
+  FILE* f = utf8::fopen (fname, "rb");
+#else
+  FILE* f = fopen (fname.c_str (), "rb");
+#endif
+  if (!f)
+    return erc (errno);
+
+  // file size limits the size of columns
+  long fsize = (!fseek (f, 0, SEEK_END)) ? ftell (f) : -1;
+  rewind (f);
+
+  char magic[sizeof (log_magic)];
+  bool ok = fsize > 0 && fread (magic, sizeof (magic), 1, f) == 1
+            && !memcmp (magic, log_magic, sizeof (magic))
+            && for_columns (*this, [f, fsize] (auto& col) {
+                 uint64_t n;
+                 if (fread (&n, sizeof (n), 1, f) != 1)
+                   return false;
+                 long pos = ftell (f);
+                 if (pos < 0 || n > (uint64_t)(fsize - pos) / sizeof (col[0]))
+                   return false;
+                 col.resize ((size_t)n);
+                 return !n || fread (col.data (), sizeof (col[0]), (size_t)n, f) == n;
+               });
+  fclose (f);
+  if (!ok)
+  {
+    clear ();
+    return erc (EINVAL);
+  }
+  return erc::success;
+}
+
+/// @}
+} // namespace mlib::nmea
@@ -0,0 +1,167 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include "simd.h"
+
+namespace mlib::detail {
+
+#if defined(MLIB_SIMD)
+/*
+  Four vectors of points evaluated together. If N > 0, the number of
+  coefficients is known at compile time, coefficients are already broadcast in
+  `c` and the loop is unrolled completely. Otherwise coefficients are broadcast
+  from `coeff` at each step.
+*/
+template <int N>
+static inline void horner4 (const double* x, const vd* c, const double* coeff, int n, double* out)
+{
+  vd x0 = vload (x), x1 = vload (x + MLIB_SIMD), x2 = vload (x + 2 * MLIB_SIMD),
+     x3 = vload (x + 3 * MLIB_SIMD);
+  vd v0, v1, v2, v3;
+  auto step = [&] (vd ck) {
+    v0 = vadd (vmul (v0, x0), ck);
+    v1 = vadd (vmul (v1, x1), ck);
+    v2 = vadd (vmul (v2, x2), ck);
+    v3 = vadd (vmul (v3, x3), ck);
+  };
+  if constexpr (N > 0)
+  {
+    v0 = v1 = v2 = v3 = c[N - 1];
+    [&]<size_t... K> (std::index_sequence<K...>) {
+      (step (c[N - 2 - K]), ...);
+    }(std::make_index_sequence<N - 1> ());
+  }
+  else
+  {
+    v0 = v1 = v2 = v3 = vset (coeff[n - 1]);
+    for (int k = n - 2; k >= 0; k--)
+      step (vset (coeff[k]));
+  }
+  vstore (out, v0);
+  vstore (out + MLIB_SIMD, v1);
+  vstore (out + 2 * MLIB_SIMD, v2);
+  vstore (out + 3 * MLIB_SIMD, v3);
+}
+
+/// One vector of points
+template <int N>
+static inline void horner1 (const double* x, const vd* c, const double* coeff, int n, double* out)
+{
+  vd x0 = vload (x), v0;
+  if constexpr (N > 0)
+  {
+    v0 = c[N - 1];
+    for (int k = N - 2; k >= 0; k--)
+      v0 = vadd (vmul (v0, x0), c[k]);
+  }
+  else
+  {
+    v0 = vset (coeff[n - 1]);
+    for (int k = n - 2; k >= 0; k--)
+      v0 = vadd (vmul (v0, x0), vset (coeff[k]));
+  }
+  vstore (out, v0);
+}
+#endif
+
+/*
+  Horner's scheme for N coefficients (N = 0 means number of coefficients is
+  known only at runtime).
+
+  Each Horner step depends on the previous one. To keep the floating point
+  units busy, the vectorized loop evaluates four independent vectors of
+  points at the same time. Operations are done in the same order as in the
+  scalar function.
+*/
+template <int N>
+static void horner (const double* x, size_t cnt, const double* coeff, int n, double* out)
+{
+  size_t i = 0;
+#if defined(MLIB_SIMD)
+  vd c[N > 0 ? N : 1];
+  if constexpr (N > 0)
+  {
+    for (int k = 0; k < N; k++)
+      c[k] = vset (coeff[k]);
+  }
+  for (; i + 4 * MLIB_SIMD <= cnt; i += 4 * MLIB_SIMD)
+    horner4<N> (x + i, c, coeff, n, out + i);
+  for (; i + MLIB_SIMD <= cnt; i += MLIB_SIMD)
+    horner1<N> (x + i, c, coeff, n, out + i);
+#endif
+  for (; i < cnt; i++)
+    out[i] = poly (x[i], coeff, n);
+}
+
+/// Values of polynomial with `n` coefficients in `cnt` points
+void poly_eval (const double* x, size_t cnt, const double* coeff, int n, double* out)
+{
+  if (n <= 0)
+  {
+    std::fill (out, out + cnt, 0.);
+    return;
+  }
+
+  // common degrees get completely unrolled loops
+  switch (n)
+  {
+  case 1:
+    std::fill (out, out + cnt, coeff[0]);
+    break;
+  case 2:
+    horner<2> (x, cnt, coeff, n, out);
+    break;
+  case 3:
+    horner<3> (x, cnt, coeff, n, out);
+    break;
+  case 4:
+    horner<4> (x, cnt, coeff, n, out);
+    break;
+  case 5:
+    horner<5> (x, cnt, coeff, n, out);
+    break;
+  case 6:
+    horner<6> (x, cnt, coeff, n, out);
+    break;
+  case 7:
+    horner<7> (x, cnt, coeff, n, out);
+    break;
+  case 8:
+    horner<8> (x, cnt, coeff, n, out);
+    break;
+  case 9:
+    horner<9> (x, cnt, coeff, n, out);
+    break;
+  case 10:
+    horner<10> (x, cnt, coeff, n, out);
+    break;
+  case 11:
+    horner<11> (x, cnt, coeff, n, out);
+    break;
+  case 12:
+    horner<12> (x, cnt, coeff, n, out);
+    break;
+  case 13:
+    horner<13> (x, cnt, coeff, n, out);
+    break;
+  case 14:
+    horner<14> (x, cnt, coeff, n, out);
+    break;
+  case 15:
+    horner<15> (x, cnt, coeff, n, out);
+    break;
+  case 16:
+    horner<16> (x, cnt, coeff, n, out);
+    break;
+  default:
+    horner<0> (x, cnt, coeff, n, out);
+    break;
+  }
+}
+
+} // namespace mlib::detail
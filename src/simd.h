@@ -0,0 +1,148 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+/*
+  Private helpers for functions processing large batches of values: thin
+  wrappers over vector instructions, so that kernels are written only once for
+  AVX and SSE2, and a function splitting a batch between multiple threads.
+
+  MLIB_SIMD is defined as the number of doubles in a vector if AVX or SSE2
+  instructions are available.
+*/
+#pragma once
+
+#include <algorithm>
+#include <math.h>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define MLIB_SIMD 4
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MLIB_SIMD 2
+#endif
+
+namespace mlib {
+
+#if defined(MLIB_SIMD)
+// clang-format off
+#if MLIB_SIMD == 4
+typedef __m256d vd;
+static inline vd vload (const double* p) { return _mm256_loadu_pd (p); }
+static inline void vstore (double* p, vd v) { _mm256_storeu_pd (p, v); }
+static inline vd vset (double v) { return _mm256_set1_pd (v); }
+static inline vd vzero () { return _mm256_setzero_pd (); }
+static inline vd vadd (vd a, vd b) { return _mm256_add_pd (a, b); }
+static inline vd vsub (vd a, vd b) { return _mm256_sub_pd (a, b); }
+static inline vd vmul (vd a, vd b) { return _mm256_mul_pd (a, b); }
+static inline vd vdiv (vd a, vd b) { return _mm256_div_pd (a, b); }
+static inline vd vsqrt (vd a) { return _mm256_sqrt_pd (a); }
+static inline vd vmin (vd a, vd b) { return _mm256_min_pd (a, b); }
+static inline vd vmax (vd a, vd b) { return _mm256_max_pd (a, b); }
+static inline vd vand (vd a, vd b) { return _mm256_and_pd (a, b); }
+static inline vd vandnot (vd a, vd b) { return _mm256_andnot_pd (a, b); }
+static inline vd vor (vd a, vd b) { return _mm256_or_pd (a, b); }
+static inline vd vxor (vd a, vd b) { return _mm256_xor_pd (a, b); }
+static inline vd vlt (vd a, vd b) { return _mm256_cmp_pd (a, b, _CMP_LT_OQ); }
+static inline vd vgt (vd a, vd b) { return _mm256_cmp_pd (a, b, _CMP_GT_OQ); }
+static inline vd veq (vd a, vd b) { return _mm256_cmp_pd (a, b, _CMP_EQ_OQ); }
+static inline int vmask (vd a) { return _mm256_movemask_pd (a); }
+static inline vd vindex (size_t i) { return _mm256_set_pd (i + 3., i + 2., i + 1., (double)i); }
+#else
+typedef __m128d vd;
+static inline vd vload (const double* p) { return _mm_loadu_pd (p); }
+static inline void vstore (double* p, vd v) { _mm_storeu_pd (p, v); }
+static inline vd vset (double v) { return _mm_set1_pd (v); }
+static inline vd vzero () { return _mm_setzero_pd (); }
+static inline vd vadd (vd a, vd b) { return _mm_add_pd (a, b); }
+static inline vd vsub (vd a, vd b) { return _mm_sub_pd (a, b); }
+static inline vd vmul (vd a, vd b) { return _mm_mul_pd (a, b); }
+static inline vd vdiv (vd a, vd b) { return _mm_div_pd (a, b); }
+static inline vd vsqrt (vd a) { return _mm_sqrt_pd (a); }
+static inline vd vmin (vd a, vd b) { return _mm_min_pd (a, b); }
+static inline vd vmax (vd a, vd b) { return _mm_max_pd (a, b); }
+static inline vd vand (vd a, vd b) { return _mm_and_pd (a, b); }
+static inline vd vandnot (vd a, vd b) { return _mm_andnot_pd (a, b); }
+static inline vd vor (vd a, vd b) { return _mm_or_pd (a, b); }
+static inline vd vxor (vd a, vd b) { return _mm_xor_pd (a, b); }
+static inline vd vlt (vd a, vd b) { return _mm_cmplt_pd (a, b); }
+static inline vd vgt (vd a, vd b) { return _mm_cmpgt_pd (a, b); }
+static inline vd veq (vd a, vd b) { return _mm_cmpeq_pd (a, b); }
+static inline int vmask (vd a) { return _mm_movemask_pd (a); }
+static inline vd vindex (size_t i) { return _mm_set_pd (i + 1., (double)i); }
+#endif
+// clang-format on
+
+// Select a where mask is set, b otherwise
+static inline vd vselect (vd mask, vd a, vd b)
+{
+  return vor (vand (mask, a), vandnot (mask, b));
+}
+
+/*
+  Arctangent of r, 0 <= r <= 1.
+
+  Rational approximation from Cephes library (S. L. Moshier). Accurate to
+  about 1 ulp.
+*/
+static inline vd vatan01 (vd r)
+{
+  const vd one = vset (1.);
+  vd big = vgt (r, vset (0.66));
+  vd z = vselect (big, vdiv (vsub (r, one), vadd (r, one)), r);
+  vd zz = vmul (z, z);
+  vd p = vset (-8.750608600031904122785E-1);
+  p = vadd (vmul (p, zz), vset (-1.615753718733365076637E1));
+  p = vadd (vmul (p, zz), vset (-7.500855792314704667340E1));
+  p = vadd (vmul (p, zz), vset (-1.228866684490136173410E2));
+  p = vadd (vmul (p, zz), vset (-6.485021904942025371773E1));
+  vd q = vadd (zz, vset (2.485846490142306297962E1));
+  q = vadd (vmul (q, zz), vset (1.650270098316988542046E2));
+  q = vadd (vmul (q, zz), vset (4.328810604912902668951E2));
+  q = vadd (vmul (q, zz), vset (4.853903996359136964868E2));
+  q = vadd (vmul (q, zz), vset (1.945506571482613964425E2));
+  vd a = vadd (vmul (z, vdiv (vmul (zz, p), q)), z);
+  vd base = vand (big, vset (M_PI / 4));
+  vd more = vand (big, vset (0.5 * 6.123233995736765886130E-17));
+  return vadd (base, vadd (a, more));
+}
+#endif
+
+/*
+  Split a batch of `count` items between threads. `f (first, n)` processes `n`
+  items starting at `first` and returns a count that is summed up. The batch
+  is split only if each thread gets at least `min_count` items. If `nthreads`
+  is 0, the number of hardware threads is used.
+*/
+template <class F>
+static size_t split_batch (size_t count, size_t min_count, unsigned int nthreads, F f)
+{
+  if (!nthreads)
+    nthreads = (std::max) (std::thread::hardware_concurrency (), 1u);
+  size_t nchunks = std::clamp (count / (std::max) (min_count, (size_t)1), (size_t)1,
+                               (size_t)nthreads);
+  if (nchunks == 1)
+    return f (0, count);
+
+  std::vector<size_t> results (nchunks);
+  std::vector<std::thread> workers;
+  size_t chunk = (count + nchunks - 1) / nchunks;
+  chunk = (chunk + 3) & ~(size_t)3; // keep chunks aligned to vector size
+  for (size_t i = 0, start = 0; start < count; i++, start += chunk)
+  {
+    size_t len = (std::min) (chunk, count - start);
+    workers.emplace_back ([&, i, start, len] () { results[i] = f (start, len); });
+  }
+  for (auto& w : workers)
+    w.join ();
+  size_t total = 0;
+  for (auto r : results)
+    total += r;
+  return total;
+}
+
+} // namespace mlib
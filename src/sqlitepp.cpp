@@ -253,6 +253,66 @@ erc Database::flush ()
   return erc::success;
 }
 
+/*!
+  \param name  SQL name of the function
+  \param nargs number of arguments or -1 for any number of arguments
+
+  To remove a function, the name and number of arguments must match those
+  used when the function was created.
+*/
+erc Database::remove_function (const std::string& name, int nargs)
+{
+  assert (db);
+  int rc = sqlite3_create_function_v2 (handle (), name.c_str (), nargs, SQLITE_UTF8, nullptr,
+                                       nullptr, nullptr, nullptr, nullptr);
+  if (rc != SQLITE_OK)
+  {
+    erc err (rc, Database::Errors ());
+    set_erc_message (err, handle ());
+    return err;
+  }
+  return erc::success;
+}
+
+/*
+  Common registration function for scalar, aggregate and window functions.
+  If \p xvalue is not null, the function is registered as a window function.
+
+  If registration fails, \p app is destroyed by SQLITE by calling \p xdestroy.
+*/
+erc Database::register_function (const std::string& name, int nargs, funcflags flags, void* app,
+                                 void (*xfunc) (sqlite3_context*, int, sqlite3_value**),
+                                 void (*xstep) (sqlite3_context*, int, sqlite3_value**),
+                                 void (*xfinal) (sqlite3_context*),
+                                 void (*xvalue) (sqlite3_context*),
+                                 void (*xinverse) (sqlite3_context*, int, sqlite3_value**),
+                                 void (*xdestroy) (void*))
+{
+  if (!db)
+  {
+    if (xdestroy)
+      xdestroy (app);
+    erc err (SQLITE_MISUSE, *sqlite_errors);
+    err.message ("Error " STRINGERIZE (SQLITE_MISUSE) " database is not opened");
+    return err;
+  }
+  int rc;
+  int textrep = SQLITE_UTF8 | static_cast<int> (flags);
+  if (xvalue)
+    rc = sqlite3_create_window_function (handle (), name.c_str (), nargs, textrep, app, xstep,
+                                         xfinal, xvalue, xinverse, xdestroy);
+  else
+    rc = sqlite3_create_function_v2 (handle (), name.c_str (), nargs, textrep, app, xfunc, xstep,
+                                     xfinal, xdestroy);
+  if (rc != SQLITE_OK)
+  {
+    erc err (rc, Database::Errors ());
+    set_erc_message (err, handle ());
+    return err;
+  }
+  return erc::success;
+}
+
 //-----------------------------------------------------------------------------
 /*!
   \class Query
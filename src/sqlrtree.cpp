@@ -0,0 +1,225 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+using namespace std;
+
+namespace mlib {
+
+/// Return an SQL identifier enclosed in double quotes
+static string sql_id (const string& id)
+{
+  string s = "\"";
+  for (auto c : id)
+  {
+    if (c == '"')
+      s += '"';
+    s += c;
+  }
+  return s + '"';
+}
+
+/*!
+  \class RTree
+  \ingroup sqlite
+
+  The class maintains an [R*Tree](https://sqlite.org/rtree.html) virtual
+  table that indexes the bounding boxes of rows in a data table. The index
+  table is named `<table>_rtree` and each entry has the same `rowid` as the
+  corresponding row in the data table. Triggers on the data table keep the
+  index up to date when rows are inserted, updated or deleted.
+
+  The data table can contain points, with X and Y coordinates stored in two
+  columns, or objects described by their bounding box, stored in four columns.
+
+  Example:
+\code
+  Database db ("soundings.db");
+  db.exec ("CREATE TABLE pts (x REAL, y REAL, depth REAL)");
+  RTree idx (db, "pts");
+  idx.create ();
+  // ... insert points
+  Border b ("area.txt");
+  for (auto id : idx.inside (b))
+  {
+    // process point
+  }
+\endcode
+
+  \note The data table must be a `rowid` table (not a `WITHOUT ROWID` table).
+  SQLITE R*Tree tables store coordinates as 32-bit floats, rounded outwards,
+  so results of bounding box queries are a superset of exact results.
+*/
+
+/*!
+  \param db     database connection
+  \param table  name of data table
+  \param x      name of X coordinate column
+  \param y      name of Y coordinate column
+*/
+RTree::RTree (Database& db_, const std::string& table_, const std::string& x,
+              const std::string& y)
+  : db (db_)
+  , table (table_)
+  , index (table_ + "_rtree")
+  , xmin (x)
+  , xmax (x)
+  , ymin (y)
+  , ymax (y)
+{}
+
+/*!
+  \param db     database connection
+  \param table  name of data table
+  \param xmin_  name of column with minimum X coordinate
+  \param xmax_  name of column with maximum X coordinate
+  \param ymin_  name of column with minimum Y coordinate
+  \param ymax_  name of column with maximum Y coordinate
+*/
+RTree::RTree (Database& db_, const std::string& table_, const std::string& xmin_,
+              const std::string& xmax_, const std::string& ymin_, const std::string& ymax_)
+  : db (db_)
+  , table (table_)
+  , index (table_ + "_rtree")
+  , xmin (xmin_)
+  , xmax (xmax_)
+  , ymin (ymin_)
+  , ymax (ymax_)
+{}
+
+/*!
+  Creates the R*Tree virtual table and the triggers that maintain it and
+  populates the index with existing data. If the index already exists, it is
+  left unchanged.
+
+  Rows with `NULL` coordinates are not indexed.
+*/
+erc RTree::create ()
+{
+  string t = sql_id (table), r = sql_id (index);
+  string cols = "new." + sql_id (xmin) + ", new." + sql_id (xmax) + ", new." + sql_id (ymin)
+                + ", new." + sql_id (ymax);
+  string notnull = "new." + sql_id (xmin) + " IS NOT NULL AND new." + sql_id (xmax)
+                   + " IS NOT NULL AND new." + sql_id (ymin) + " IS NOT NULL AND new."
+                   + sql_id (ymax) + " IS NOT NULL";
+  string upd_cols = sql_id (xmin);
+  if (!points ())
+    upd_cols += ", " + sql_id (xmax);
+  upd_cols += ", " + sql_id (ymin);
+  if (!points ())
+    upd_cols += ", " + sql_id (ymax);
+
+  string sql = "CREATE VIRTUAL TABLE IF NOT EXISTS " + r + " USING rtree (id, xmin, xmax, ymin, ymax);"
+               "CREATE TRIGGER IF NOT EXISTS " + sql_id (index + "_ins") + " AFTER INSERT ON " + t
+               + " WHEN " + notnull + " BEGIN INSERT INTO " + r + " VALUES (new.rowid, " + cols
+               + "); END;"
+               "CREATE TRIGGER IF NOT EXISTS " + sql_id (index + "_upd") + " AFTER UPDATE OF "
+               + upd_cols + " ON " + t + " BEGIN DELETE FROM " + r
+               + " WHERE id = old.rowid; INSERT INTO " + r + " SELECT new.rowid, " + cols
+               + " WHERE " + notnull + "; END;"
+               "CREATE TRIGGER IF NOT EXISTS " + sql_id (index + "_del") + " AFTER DELETE ON " + t
+               + " BEGIN DELETE FROM " + r + " WHERE id = old.rowid; END;";
+  erc ret = db.exec (sql);
+  if (ret)
+  {
+    ret.reactivate ();
+    return ret;
+  }
+
+  Query q (db, "SELECT count(*) FROM " + r);
+  q.step ();
+  if (q.column_int64 (0) == 0)
+    return rebuild ();
+  return erc::success;
+}
+
+/*!
+  Deletes all entries in the index table and reinserts them from data table.
+  Use this function if the data table was modified while the triggers were not
+  active.
+*/
+erc RTree::rebuild ()
+{
+  string r = sql_id (index);
+  string x0 = sql_id (xmin), x1 = sql_id (xmax), y0 = sql_id (ymin), y1 = sql_id (ymax);
+  return db.exec ("DELETE FROM " + r + "; INSERT INTO " + r + " SELECT rowid, " + x0 + ", " + x1
+                  + ", " + y0 + ", " + y1 + " FROM " + sql_id (table) + " WHERE " + x0
+                  + " IS NOT NULL AND " + x1 + " IS NOT NULL AND " + y0 + " IS NOT NULL AND "
+                  + y1 + " IS NOT NULL;");
+}
+
+/// The data table is not affected.
+erc RTree::drop ()
+{
+  return db.exec ("DROP TRIGGER IF EXISTS " + sql_id (index + "_ins") + ";"
+                  "DROP TRIGGER IF EXISTS " + sql_id (index + "_upd") + ";"
+                  "DROP TRIGGER IF EXISTS " + sql_id (index + "_del") + ";"
+                  "DROP TABLE IF EXISTS " + sql_id (index) + ";");
+}
+
+/*!
+  \param ll  lower left corner (minimum X and Y coordinates) of search rectangle
+  \param ur  upper right corner (maximum X and Y coordinates) of search rectangle
+  \return Query object ready to be stepped through
+
+  The query returns all columns (`SELECT *`) of matching rows in the data table.
+*/
+Query RTree::query (const dpoint& ll, const dpoint& ur)
+{
+  Query q (db, "SELECT * FROM " + sql_id (table) + " WHERE rowid IN (SELECT id FROM "
+                 + sql_id (index)
+                 + " WHERE xmax >= ?1 AND xmin <= ?2 AND ymax >= ?3 AND ymin <= ?4)");
+  q.bind (1, ll.x).bind (2, ur.x).bind (3, ll.y).bind (4, ur.y);
+  return q;
+}
+
+/*!
+  If the border is empty, the query returns no rows.
+*/
+Query RTree::query (const Border& b)
+{
+  dpoint ll, ur;
+  if (!b.bbox (ll, ur))
+    return query (dpoint (1, 1), dpoint (0, 0)); // empty rectangle
+  return query (ll, ur);
+}
+
+/*!
+  Candidate points are selected using the R*Tree index and are refined
+  using Border::inside() function. If the border is a "hole" border, all points
+  in the data table have to be checked.
+
+  This function can be used only for point tables. For bounding box tables,
+  it returns an empty vector.
+*/
+std::vector<sqlite3_int64> RTree::inside (const Border& b)
+{
+  std::vector<sqlite3_int64> result;
+  dpoint ll, ur;
+  if (!points () || !b.bbox (ll, ur))
+    return result;
+
+  string sql = "SELECT rowid, " + sql_id (xmin) + ", " + sql_id (ymin) + " FROM " + sql_id (table);
+  Query q;
+  if (b.hole ())
+    q = Query (db, sql + " WHERE " + sql_id (xmin) + " IS NOT NULL AND " + sql_id (ymin)
+                     + " IS NOT NULL");
+  else
+  {
+    q = Query (db, sql + " WHERE rowid IN (SELECT id FROM " + sql_id (index)
+                     + " WHERE xmax >= ?1 AND xmin <= ?2 AND ymax >= ?3 AND ymin <= ?4)");
+    q.bind (1, ll.x).bind (2, ur.x).bind (3, ll.y).bind (4, ur.y);
+  }
+  while (q.step () == SQLITE_ROW)
+  {
+    if (b.inside (q.column_double (1), q.column_double (2)))
+      result.push_back (q.column_int64 (0));
+  }
+  return result;
+}
+
+} // namespace mlib
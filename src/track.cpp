@@ -0,0 +1,482 @@
+/*
+  Copyright (c) Mircea Neacsu (2014-2025) Licensed under MIT License.
+  This file is part of MLIB project. See LICENSE file for full license terms.
+*/
+
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <algorithm>
+#include <errno.h>
+#include <filesystem>
+#include <math.h>
+#include <string.h>
+#include <utf8/utf8.h>
+
+namespace mlib {
+
+/*!
+  \defgroup track GNSS Track Storage
+  \brief Compact binary storage of GNSS tracks
+
+  A track file starts with a header containing a signature and the resolution
+  of stored values. It is followed by a sequence of blocks, each one holding
+  a fixed number of points (the last one can be shorter).
+
+  Time, position and height are converted to fixed-point integers using the
+  file resolution. Time and position are encoded as the difference from a
+  linear prediction based on the previous two points, height as the
+  difference from the previous point. Differences are stored as variable
+  length integers. Fix quality and number of satellites are stored only when
+  they change. A 20 Hz track with constant sampling rate needs between 5 and
+  10 bytes per point, compared to 40 bytes for a track_point structure.
+
+  Each block starts with a header containing the number of points, the size
+  of encoded data and the time range of the block. These headers form a
+  sparse index that allows finding a time in a track without decoding all
+  the data. Blocks can be decoded independently.
+
+  New blocks are appended at the end of file. If the file was not properly
+  closed, an incomplete last block is ignored by readers and discarded when
+  the file is reopened for writing.
+
+  Values are stored in native byte order.
+
+  @{
+*/
+
+static const char track_magic[8] = {'M', 'L', 'T', 'R', 'A', 'C', 'K', '1'};
+static const uint32_t block_magic = 0x4B4C4254; //"TBLK"
+
+// File header
+struct file_header
+{
+  char magic[8];
+  double res_time, res_pos, res_height;
+};
+
+// Header of each block of points
+struct block_header
+{
+  uint32_t magic;
+  uint32_t count; // number of points
+  uint32_t size;  // size of encoded data
+  uint32_t reserved;
+  double t_first, t_last;
+};
+
+// Flags showing which optional fields are present in an encoded point
+enum
+{
+  has_quality = 1,
+  has_sat = 2
+};
+
+// Smallest encoded point: flags and four one-byte varints
+static const size_t min_point_size = 5;
+
+static inline uint64_t zigzag (int64_t v)
+{
+  return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t unzigzag (uint64_t v)
+{
+  return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static inline void put_varint (std::vector<uint8_t>& buf, int64_t sv)
+{
+  uint64_t v = zigzag (sv);
+  while (v >= 0x80)
+  {
+    buf.push_back ((uint8_t)(v | 0x80));
+    v >>= 7;
+  }
+  buf.push_back ((uint8_t)v);
+}
+
+// Addition that wraps around instead of overflowing on corrupted data
+static inline int64_t wrap_add (int64_t a, int64_t b)
+{
+  return (int64_t)((uint64_t)a + (uint64_t)b);
+}
+
+// Decode a varint of at most 10 bytes without reading past `end`
+static inline int64_t get_varint (const uint8_t*& p, const uint8_t* end)
+{
+  uint64_t v = 0;
+  for (int shift = 0; p < end && shift < 64; shift += 7)
+  {
+    uint8_t c = *p++;
+    v |= (uint64_t)(c & 0x7f) << shift;
+    if (!(c & 0x80))
+      break;
+  }
+  return unzigzag (v);
+}
+
+static FILE* open_file (const std::string& fname, const char* mode)
+{
+#ifdef _WIN32
+  return utf8::fopen (fname, mode);
+#else
+  return fopen (fname.c_str (), mode);
+#endif
+}
+
+// Read file header. Returns `false` if header is invalid.
+static bool read_header (const char* data, size_t size, track_resolution& res)
+{
+  file_header hdr;
+  if (size < sizeof (hdr))
+    return false;
+  memcpy (&hdr, data, sizeof (hdr));
+  if (memcmp (hdr.magic, track_magic, sizeof (track_magic)) || !(hdr.res_time > 0)
+      || !(hdr.res_pos > 0) || !(hdr.res_height > 0))
+    return false;
+  res.time = hdr.res_time;
+  res.pos = hdr.res_pos;
+  res.height = hdr.res_height;
+  return true;
+}
+
+/*
+  Walk the chain of block headers. Returns the end of last complete block.
+  Each encoded point takes at least min_point_size bytes; blocks whose count
+  cannot fit in their size are corrupt and end the chain.
+*/
+static size_t scan_blocks (const char* data, size_t size, std::vector<track_reader::block>& blocks)
+{
+  size_t off = sizeof (file_header);
+  size_t first = 0;
+  blocks.clear ();
+  while (size - off >= sizeof (block_header))
+  {
+    block_header hdr;
+    memcpy (&hdr, data + off, sizeof (hdr));
+    if (hdr.magic != block_magic || !hdr.count || size - off - sizeof (hdr) < hdr.size
+        || hdr.count > hdr.size / min_point_size)
+      break;
+    auto payload = (const uint8_t*)data + off + sizeof (hdr);
+    blocks.push_back ({payload, payload + hdr.size, hdr.count, first, hdr.t_first, hdr.t_last});
+    first += hdr.count;
+    off += sizeof (hdr) + hdr.size;
+  }
+  return off;
+}
+
+/*!
+  \class track_writer
+
+  Points are accumulated in memory and written to file one block at a time.
+  They must be appended in chronological order.
+
+  Example:
+\code
+  track_writer tw;
+  tw.open ("survey.trk");
+  for (auto& f : fixes)
+    tw.append ({f.time, {f.lon, f.lat}, f.height, f.mode, f.sat});
+  tw.close ();
+\endcode
+*/
+
+track_writer::track_writer ()
+  : f (nullptr)
+  , block_points (1024)
+  , count (0)
+  , t_first (0)
+  , t_last (0)
+  , last_time (-INFINITY)
+{}
+
+track_writer::~track_writer ()
+{
+  if (f)
+    close ().deactivate ();
+}
+
+/*!
+  \param fname name of track file
+  \param res_ resolution of stored values for a new file
+  \param block_points_ number of points in each block
+
+  If the file already exists, new points are appended to it and the
+  resolution stored in file is used instead of the `res_` parameter.
+*/
+erc track_writer::open (const std::string& fname, const track_resolution& res_,
+                        size_t block_points_)
+{
+  if (f)
+  {
+    erc ret = close ();
+    if (ret.code ())
+      return ret;
+  }
+  res = res_;
+  block_points = (std::max) (block_points_, (size_t)1);
+  count = 0;
+  buf.clear ();
+  last_time = -INFINITY;
+
+  std::error_code ec;
+#ifdef _WIN32
+  std::filesystem::path fpath (utf8::widen (fname));
+#else
+  std::filesystem::path fpath (fname);
+#endif
+  if (std::filesystem::exists (fpath, ec) && std::filesystem::file_size (fpath, ec))
+  {
+    size_t valid_end;
+    {
+      mapped_file mf (fname);
+      if (mf.error)
+        return erc (mf.error);
+      if (!read_header (mf.data, mf.size, res))
+        return erc (EINVAL);
+      std::vector<track_reader::block> blocks;
+      valid_end = scan_blocks (mf.data, mf.size, blocks);
+      if (!blocks.empty ())
+        last_time = blocks.back ().t_last;
+      if (valid_end == mf.size)
+        valid_end = 0; // no need to truncate
+    }
+    if (valid_end)
+    {
+      // discard incomplete block
+      std::filesystem::resize_file (fpath, valid_end, ec);
+      if (ec)
+        return erc (ec.value ());
+    }
+    if (!(f = open_file (fname, "ab")))
+      return erc (errno);
+  }
+  else
+  {
+    if (!(res.time > 0) || !(res.pos > 0) || !(res.height > 0))
+      return erc (EINVAL);
+    if (!(f = open_file (fname, "wb")))
+      return erc (errno);
+    file_header hdr;
+    memcpy (hdr.magic, track_magic, sizeof (track_magic));
+    hdr.res_time = res.time;
+    hdr.res_pos = res.pos;
+    hdr.res_height = res.height;
+    if (fwrite (&hdr, sizeof (hdr), 1, f) != 1)
+    {
+      fclose (f);
+      f = nullptr;
+      return erc (EIO);
+    }
+  }
+  return erc::success;
+}
+
+/*!
+  \return EINVAL error if point is older than previous point, EBADF if file is
+  not open or any error produced while writing a block.
+
+  Values must be finite. Quality and number of satellites are truncated to 8
+  bits.
+*/
+erc track_writer::append (const track_point& pt)
+{
+  if (!f)
+    return erc (EBADF);
+  if (pt.time < last_time)
+    return erc (EINVAL);
+  encode (pt);
+  last_time = pt.time;
+  if (count == block_points)
+    return flush ();
+  return erc::success;
+}
+
+void track_writer::encode (const track_point& pt)
+{
+  int64_t v[4] = {llround (pt.time / res.time), llround (pt.pos.x / res.pos),
+                  llround (pt.pos.y / res.pos), llround (pt.height / res.height)};
+  int q = pt.quality & 0xff, s = pt.sat & 0xff;
+  if (!count)
+  {
+    // first point in block is encoded relative to 0
+    memset (prev, 0, sizeof (prev));
+    memset (delta, 0, sizeof (delta));
+    prev_quality = prev_sat = -1;
+    t_first = pt.time;
+  }
+
+  uint8_t flags = (q != prev_quality ? has_quality : 0) | (s != prev_sat ? has_sat : 0);
+  buf.push_back (flags);
+  for (int i = 0; i < 3; i++)
+  {
+    int64_t d = v[i] - prev[i];
+    put_varint (buf, d - delta[i]);
+    delta[i] = count ? d : 0;
+    prev[i] = v[i];
+  }
+  put_varint (buf, v[3] - prev[3]);
+  prev[3] = v[3];
+  if (flags & has_quality)
+    buf.push_back ((uint8_t)q);
+  if (flags & has_sat)
+    buf.push_back ((uint8_t)s);
+  prev_quality = q;
+  prev_sat = s;
+  t_last = pt.time;
+  count++;
+}
+
+/*!
+  Points buffered in the current block are written as a (possibly shorter)
+  block. Next appended point starts a new block.
+*/
+erc track_writer::flush ()
+{
+  if (!f)
+    return erc (EBADF);
+  if (!count)
+    return erc::success;
+
+  block_header hdr{block_magic, count, (uint32_t)buf.size (), 0, t_first, t_last};
+  bool ok = fwrite (&hdr, sizeof (hdr), 1, f) == 1
+            && fwrite (buf.data (), 1, buf.size (), f) == buf.size () && !fflush (f);
+  count = 0;
+  buf.clear ();
+  return ok ? erc::success : erc (EIO);
+}
+
+erc track_writer::close ()
+{
+  if (!f)
+    return erc::success;
+  erc ret = flush ();
+  if (fclose (f) && !ret.code ())
+    ret = erc (EIO);
+  f = nullptr;
+  return ret;
+}
+
+/*!
+  \class track_reader
+
+  The file is memory-mapped and points are decoded directly from the mapping
+  while iterating. Opening a file only walks the chain of block headers to
+  build the sparse index, so even large files open almost instantly.
+
+  Example:
+\code
+  track_reader tr;
+  tr.open ("survey.trk");
+  for (auto p = tr.lower_bound (t0); p != tr.end () && p->time <= t1; ++p)
+    process (*p);
+\endcode
+*/
+
+track_reader::track_reader ()
+  : npoints (0)
+{}
+
+track_reader::~track_reader ()
+{}
+
+erc track_reader::open (const std::string& fname)
+{
+  close ();
+  auto m = std::make_unique<mapped_file> (fname);
+  if (m->error)
+    return erc (m->error);
+  if (!read_header (m->data, m->size, res))
+    return erc (EINVAL);
+  scan_blocks (m->data, m->size, blocks);
+  npoints = blocks.empty () ? 0 : blocks.back ().first + blocks.back ().count;
+  mf = std::move (m);
+  return erc::success;
+}
+
+void track_reader::close ()
+{
+  blocks.clear ();
+  npoints = 0;
+  mf.reset ();
+}
+
+/*!
+  The block containing the time is found using a binary search in the sparse
+  index. Only points in that block are decoded.
+*/
+track_reader::iterator track_reader::lower_bound (double t) const
+{
+  auto b = std::partition_point (blocks.begin (), blocks.end (),
+                                 [t] (const block& b) { return b.t_last < t; });
+  size_t nb = b - blocks.begin ();
+  iterator it (this, nb);
+  if (nb < blocks.size ())
+  {
+    while (it.blk == nb && it->time < t)
+      ++it;
+  }
+  return it;
+}
+
+track_reader::iterator::iterator (const track_reader* r, size_t b)
+  : rdr (r)
+  , blk (b)
+  , idx (0)
+{
+  if (blk < rdr->blocks.size ())
+  {
+    p = rdr->blocks[blk].data;
+    decode ();
+  }
+}
+
+/// Advance to next point
+track_reader::iterator& track_reader::iterator::operator++ ()
+{
+  if (++idx == rdr->blocks[blk].count)
+  {
+    idx = 0;
+    if (++blk == rdr->blocks.size ())
+      return *this; // end of track
+    p = rdr->blocks[blk].data;
+  }
+  decode ();
+  return *this;
+}
+
+/*
+  Decode point at current position. Decoding never goes past the end of block
+  payload; fields missing from a corrupted block are decoded as zero.
+*/
+void track_reader::iterator::decode ()
+{
+  if (!idx)
+  {
+    memset (prev, 0, sizeof (prev));
+    memset (delta, 0, sizeof (delta));
+  }
+  const uint8_t* end = rdr->blocks[blk].end;
+  uint8_t flags = (p < end) ? *p++ : 0;
+  for (int i = 0; i < 3; i++)
+  {
+    int64_t d = wrap_add (delta[i], get_varint (p, end));
+    prev[i] = wrap_add (prev[i], d);
+    delta[i] = idx ? d : 0;
+  }
+  prev[3] = wrap_add (prev[3], get_varint (p, end));
+  if (flags & has_quality)
+    pt.quality = (p < end) ? *p++ : 0;
+  if (flags & has_sat)
+    pt.sat = (p < end) ? *p++ : 0;
+
+  auto& res = rdr->res;
+  pt.time = prev[0] * res.time;
+  pt.pos.x = prev[1] * res.pos;
+  pt.pos.y = prev[2] * res.pos;
+  pt.height = prev[3] * res.height;
+}
+
+///@}
+} // namespace mlib
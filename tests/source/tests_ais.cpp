@@ -0,0 +1,316 @@
+#include <utpp/utpp.h>
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <iostream>
+#include <sstream>
+
+using namespace mlib;
+using namespace std;
+
+SUITE (ais)
+{
+  // Build an AIS payload using an armored bitstream
+  struct builder
+  {
+    stringstream ss;
+    ais::armored_bitstream bs{ss};
+    size_t nbits = 0;
+
+    builder& put (int val, size_t sz)
+    {
+      bs.write (val, sz);
+      nbits += sz;
+      return *this;
+    }
+    builder& text (const char* str, size_t nchars)
+    {
+      for (size_t i = 0; i < nchars; i++)
+      {
+        char c = *str ? *str++ : '@';
+        put (c >= 64 ? c - 64 : c, 6);
+      }
+      return *this;
+    }
+    // bitstream::flush doesn't left-align the last bits; pad them to a full character
+    string armored ()
+    {
+      if (nbits % 6)
+        put (0, 6 - nbits % 6);
+      bs.flush ();
+      return ss.str ();
+    }
+  };
+
+  TEST (armoring)
+  {
+    stringstream ss;
+    ais::armored_bitstream bs (ss);
+    for (int i = 0; i < 64; i++)
+      bs.write (i, 6);
+    bs.flush ();
+    string s = ss.str ();
+    CHECK_EQUAL (64, s.size ());
+    CHECK_EQUAL ("0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVW`abcdefghijklmnopqrstuvw", s);
+
+    ais::payload p;
+    CHECK (p.append (s));
+    CHECK_EQUAL (384, p.size ());
+    for (int i = 0; i < 64; i++)
+      CHECK_EQUAL (i, p.get (i * 6, 6));
+
+    ss.seekg (0);
+    for (int i = 0; i < 64; i++)
+      CHECK_EQUAL (i, bs.read (6));
+    CHECK (!p.append ("ABC\x7f"));
+
+    // characters between 'W' and '`' and after 'w' are invalid
+    CHECK (!p.append ("X"));
+    CHECK (!p.append ("_"));
+    CHECK (!p.append ("x"));
+    CHECK_EQUAL (384, p.size ());
+
+    // failed append doesn't modify payload
+    ais::payload q;
+    CHECK (!q.append ("wwwX"));
+    CHECK_EQUAL (0, q.size ());
+    CHECK (q.append ("0"));
+    CHECK_EQUAL (0, q.get (0, 24));
+
+    stringstream bad ("X_");
+    ais::armored_bitstream bsx (bad);
+    CHECK_EQUAL (0, bsx.read (6));
+    CHECK (bad.fail ());
+  }
+
+  TEST (payload_fields)
+  {
+    builder b;
+    b.put (5, 3).put (-3, 7).put (0x12345, 17).put (1, 1);
+    ais::payload p;
+    p.append (b.armored (), 2);
+    CHECK_EQUAL (28, p.size ());
+    CHECK_EQUAL (5, p.get (0, 3));
+    CHECK_EQUAL (-3, p.sget (3, 7));
+    CHECK_EQUAL (0x12345, p.get (10, 17));
+    CHECK_EQUAL (1, p.get (27, 1));
+  }
+
+  TEST (position_report)
+  {
+    ais::decoder dec;
+    auto m = dec.add ("!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5C");
+    auto r = get_if<ais::position_report> (&m);
+    ABORT_EX (r, "Message type %d instead of position report", (int)m.index ());
+    CHECK_EQUAL (1, r->type);
+    CHECK_EQUAL (477553000u, r->mmsi);
+    CHECK_EQUAL (5, r->status);
+    CHECK_EQUAL (0., r->sog);
+    CHECK_CLOSE (-122.345832_deg, r->lon, 1e-7);
+    CHECK_CLOSE (47.582833_deg, r->lat, 1e-8);
+    CHECK_CLOSE (51_deg, r->cog, 1e-12);
+    CHECK_CLOSE (181_deg, r->heading, 1e-12);
+    CHECK_EQUAL (15, r->second);
+    CHECK (!dec.own ());
+  }
+
+  TEST (static_voyage)
+  {
+    ais::decoder dec;
+    auto m = dec.add (
+      "!AIVDM,2,1,1,A,55?MbV02;H;s<HtKR20EHE:0@T4@Dn2222222216L961O5Gf0NSQEp6ClRp8,0*1C");
+    CHECK (holds_alternative<monostate> (m));
+    m = dec.add ("!AIVDM,2,2,1,A,88888888880,2*25");
+    auto r = get_if<ais::static_voyage> (&m);
+    ABORT_EX (r, "Message type %d instead of static and voyage data", (int)m.index ());
+    CHECK_EQUAL (351759000u, r->mmsi);
+    CHECK_EQUAL (9134270u, r->imo);
+    CHECK_EQUAL ("3FOF8", r->callsign);
+    CHECK_EQUAL ("EVER DIADEM", r->name);
+    CHECK_EQUAL (70, r->shiptype);
+    CHECK_EQUAL ("NEW YORK", r->destination);
+    CHECK_EQUAL (12.2, r->draught);
+    CHECK_EQUAL (2, dec.statistics ().fragments);
+    CHECK_EQUAL (1, dec.statistics ().messages);
+  }
+
+  TEST (missing_fragment)
+  {
+    ais::decoder dec;
+    dec.add ("!AIVDM,2,1,3,A,55?MbV02;H;s<HtKR20EHE:0@T4@Dn2222222216L961O5Gf0NSQEp6ClRp8,0*1C");
+    // first fragment of another message with same ID
+    dec.add ("!AIVDM,2,1,3,A,55?MbV02;H;s<HtKR20EHE:0@T4@Dn2222222216L961O5Gf0NSQEp6ClRp8,0*1C");
+    auto m = dec.add ("!AIVDM,2,2,3,A,88888888880,2*25");
+    CHECK (holds_alternative<ais::static_voyage> (m));
+    CHECK_EQUAL (1, dec.statistics ().incomplete);
+
+    // second fragment without first one
+    m = dec.add ("!AIVDM,2,2,3,A,88888888880,2*25");
+    CHECK (holds_alternative<monostate> (m));
+  }
+
+  TEST (class_b)
+  {
+    builder b;
+    b.put (18, 6).put (0, 2).put (367430530, 30).put (0, 8);
+    b.put (123, 10).put (1, 1).put (-74 * 600000, 28).put (40 * 600000 + 30000, 27);
+    b.put (2345, 12).put (511, 9).put (42, 6).put (0, 2).put (1, 1).put (0, 5).put (1, 1);
+    b.put (0, 20);
+    string s = "!AIVDO,1,1,,B," + b.armored () + ",0*00";
+    ais::decoder dec;
+    auto m = dec.add (s.c_str ());
+    auto r = get_if<ais::class_b_position> (&m);
+    ABORT_EX (r, "Message type %d instead of class B position", (int)m.index ());
+    CHECK_EQUAL (367430530u, r->mmsi);
+    CHECK_EQUAL (12.3, r->sog);
+    CHECK_CLOSE (-74_deg, r->lon, 1e-12);
+    CHECK_CLOSE (40.05_deg, r->lat, 1e-12);
+    CHECK_CLOSE (234.5_deg, r->cog, 1e-12);
+    CHECK (isnan (r->heading));
+    CHECK_EQUAL (42, r->second);
+    CHECK (r->cs);
+    CHECK (r->raim);
+    CHECK (dec.own ());
+  }
+
+  TEST (class_b_extended)
+  {
+    builder b;
+    b.put (19, 6).put (0, 2).put (367430530, 30).put (0, 8);
+    b.put (1023, 10).put (0, 1).put (181 * 600000, 28).put (91 * 600000, 27);
+    b.put (3600, 12).put (90, 9).put (60, 6).put (0, 4);
+    b.text ("SEA BREEZE", 20).put (37, 8).put (10, 9).put (5, 9).put (2, 6).put (3, 6);
+    b.put (1, 4).put (0, 1).put (1, 1).put (0, 1).put (0, 4);
+    string s = "!AIVDM,1,1,,A," + b.armored () + ",0";
+    auto m = ais::decoder ().add (s.c_str ());
+    auto r = get_if<ais::class_b_extended> (&m);
+    ABORT_EX (r, "Message type %d instead of extended class B", (int)m.index ());
+    CHECK (isnan (r->sog));
+    CHECK (isnan (r->lat));
+    CHECK (isnan (r->lon));
+    CHECK (isnan (r->cog));
+    CHECK_CLOSE (90_deg, r->heading, 1e-12);
+    CHECK_EQUAL ("SEA BREEZE", r->name);
+    CHECK_EQUAL (37, r->shiptype);
+    CHECK_EQUAL (10, r->dim.to_bow);
+    CHECK_EQUAL (5, r->dim.to_stern);
+    CHECK_EQUAL (2, r->dim.to_port);
+    CHECK_EQUAL (3, r->dim.to_starboard);
+    CHECK_EQUAL (1, r->epfd);
+  }
+
+  TEST (base_station)
+  {
+    builder b;
+    b.put (4, 6).put (0, 2).put (3669702, 30).put (2007, 14).put (5, 4).put (14, 5);
+    b.put (19, 5).put (57, 6).put (39, 6).put (1, 1).put (-76 * 600000, 28).put (36 * 600000, 27);
+    b.put (7, 4).put (0, 10).put (0, 1).put (0, 19);
+    string s = "!AIVDM,1,1,,A," + b.armored () + ",0";
+    auto m = ais::decoder ().add (s.c_str ());
+    auto r = get_if<ais::base_station> (&m);
+    ABORT_EX (r, "Message type %d instead of base station", (int)m.index ());
+    CHECK_EQUAL (2007, r->year);
+    CHECK_EQUAL (5, r->month);
+    CHECK_EQUAL (14, r->day);
+    CHECK_EQUAL (19, r->hour);
+    CHECK_EQUAL (57, r->minute);
+    CHECK_EQUAL (39, r->second);
+    CHECK_CLOSE (-76_deg, r->lon, 1e-12);
+    CHECK_CLOSE (36_deg, r->lat, 1e-12);
+    CHECK_EQUAL (7, r->epfd);
+  }
+
+  TEST (aid_to_navigation)
+  {
+    builder b;
+    b.put (21, 6).put (0, 2).put (993692028, 30).put (14, 5).text ("NORTH BREAKWATER LIG", 20);
+    b.put (1, 1).put (-70 * 600000, 28).put (42 * 600000, 27).put (0, 30).put (1, 4);
+    b.put (30, 6).put (1, 1).put (0, 8).put (0, 1).put (1, 1).put (0, 1).put (0, 1);
+    b.text ("HT 5", 4);
+    string s = "!AIVDM,1,1,,A," + b.armored () + ",0";
+    auto m = ais::decoder ().add (s.c_str ());
+    auto r = get_if<ais::aid_to_navigation> (&m);
+    ABORT_EX (r, "Message type %d instead of aid to navigation", (int)m.index ());
+    CHECK_EQUAL (14, r->aid_type);
+    CHECK_EQUAL ("NORTH BREAKWATER LIGHT 5", r->name);
+    CHECK (r->off_position);
+    CHECK (r->virtual_aid);
+    CHECK_EQUAL (30, r->second);
+  }
+
+  TEST (static_data)
+  {
+    builder a;
+    a.put (24, 6).put (0, 2).put (271041815, 30).put (0, 2).text ("PROGUY", 20);
+    string s = "!AIVDM,1,1,,A," + a.armored () + ",0";
+    ais::decoder dec;
+    auto m = dec.add (s.c_str ());
+    auto r = get_if<ais::static_data> (&m);
+    ABORT_EX (r, "Message type %d instead of static data", (int)m.index ());
+    CHECK_EQUAL (0, r->part);
+    CHECK_EQUAL ("PROGUY", r->name);
+
+    builder b;
+    b.put (24, 6).put (0, 2).put (271041815, 30).put (1, 2).put (60, 8).text ("1D0", 3);
+    b.put (3, 4).put (12345, 20).text ("TC6163", 7).put (0, 9).put (15, 9).put (0, 6).put (5, 6);
+    b.put (0, 6);
+    s = "!AIVDM,1,1,,A," + b.armored () + ",0";
+    m = dec.add (s.c_str ());
+    r = get_if<ais::static_data> (&m);
+    ABORT_EX (r, "Message type %d instead of static data", (int)m.index ());
+    CHECK_EQUAL (1, r->part);
+    CHECK_EQUAL (60, r->shiptype);
+    CHECK_EQUAL ("1D0", r->vendor);
+    CHECK_EQUAL (3, r->model);
+    CHECK_EQUAL (12345u, r->serial);
+    CHECK_EQUAL ("TC6163", r->callsign);
+    CHECK_EQUAL (15, r->dim.to_stern);
+    CHECK_EQUAL (5, r->dim.to_starboard);
+  }
+
+  TEST (invalid)
+  {
+    ais::decoder dec;
+    CHECK (holds_alternative<monostate> (dec.add ("$GPGGA,123519,4807.038,N")));
+    CHECK (holds_alternative<monostate> (dec.add ("!AIVDM,1,1,,A,,0")));
+    CHECK (holds_alternative<monostate> (dec.add ("!AIVDM,0,1,,A,177KQJ5000G,0")));
+    CHECK (holds_alternative<monostate> (dec.add ("!AIVDM,1,1,,A,177KQJ5000G,0"))); // too short
+    CHECK_EQUAL (4, dec.statistics ().invalid);
+  }
+
+  TEST (decoding_speed)
+  {
+    const int N = 300000;
+    const char* sentences[] = {"!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5C",
+                               "!AIVDM,2,1,1,A,55?MbV02;H;s<HtKR20EHE:0@T4@Dn2222222216L961O5Gf0"
+                               "NSQEp6ClRp8,0*1C",
+                               "!AIVDM,2,2,1,A,88888888880,2*25"};
+    ais::decoder dec;
+    UnitTest::Timer t;
+    t.Start ();
+    for (int i = 0; i < N; i++)
+      dec.add (sentences[i % 3]);
+    auto dt = t.GetTimeInUs ();
+    CHECK_EQUAL (N / 3 * 2, dec.statistics ().messages);
+
+    // bit-by-bit decoding of the same position report with bitstream::read
+    stringstream ss ("177KQJ5000G?tO`K>RA1wUbN0TKH");
+    ais::armored_bitstream bs (ss);
+    int sum = 0;
+    UnitTest::Timer t1;
+    t1.Start ();
+    for (int i = 0; i < N / 3; i++)
+    {
+      ss.clear ();
+      ss.seekg (0);
+      sum += bs.read (6) + bs.read (2) + bs.read (30) + bs.read (4) + bs.read (8, true);
+      sum += bs.read (10) + bs.read (1) + bs.read (28, true) + bs.read (27, true);
+    }
+    auto dt1 = t1.GetTimeInUs ();
+    cout << "AIS decoding speed:" << endl
+         << " ais::decoder - " << (dt ? N * 1000000LL / dt : 0) << " sentences/sec" << endl
+         << " bitstream::read (first 116 bits only) - " << (dt1 ? N / 3 * 1000000LL / dt1 : 0)
+         << " messages/sec" << endl;
+    CHECK (sum != 0);
+  }
+}
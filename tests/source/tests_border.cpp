@@ -0,0 +1,471 @@
+#include <utpp/utpp.h>
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+using namespace mlib;
+using namespace std;
+
+SUITE (border)
+{
+  // Star-shaped polygon with n vertexes and random radii
+  static void star (Border & b, size_t n, unsigned int seed = 1)
+  {
+    std::mt19937 rng (seed);
+    std::uniform_real_distribution<double> rad (0.5, 1.);
+    for (size_t i = 0; i < n; i++)
+    {
+      double a = 2 * M_PI * i / n;
+      double r = rad (rng);
+      b.add (r * cos (a), r * sin (a));
+    }
+  }
+
+  // Coastline-like polygon: a wavy circle with some noise
+  static void coast (Border & b, size_t n, unsigned int seed = 1)
+  {
+    std::mt19937 rng (seed);
+    std::uniform_real_distribution<double> noise (-0.01, 0.01);
+    for (size_t i = 0; i < n; i++)
+    {
+      double a = 2 * M_PI * i / n;
+      double r = 0.75 + 0.15 * sin (5 * a) + 0.05 * sin (37 * a) + noise (rng);
+      b.add (r * cos (a), r * sin (a));
+    }
+  }
+
+  TEST (triangle)
+  {
+    Border b;
+    b.add (0, 0);
+    b.add (10, 0);
+    b.add (0, 10);
+    b.close (1, 1);
+    CHECK (!b.hole ());
+    CHECK (!b.indexed ());
+    CHECK (b.inside (2, 2));
+    CHECK (!b.inside (6, 6));
+    CHECK (!b.inside (-1, 1));
+
+    b.build_index ();
+    CHECK (b.indexed ());
+    CHECK (b.inside (2, 2));
+    CHECK (!b.inside (6, 6));
+    CHECK (!b.inside (-1, 1));
+    CHECK (!b.inside (20, 20));
+  }
+
+  TEST (hole)
+  {
+    Border h;
+    star (h, 1000);
+    h.close (5, 5);
+    CHECK (h.indexed ());
+    CHECK (h.hole ());
+    CHECK (!h.inside (0, 0));
+    CHECK (h.inside (2, 2));
+  }
+
+  TEST (index_dropped)
+  {
+    Border b;
+    star (b, 100);
+    b.close (0, 0);
+    CHECK (b.indexed ());
+    b.add (0.1, 0); // border is modified
+    CHECK (!b.indexed ());
+  }
+
+  // Indexed and non-indexed results must be identical
+  TEST (index_matches_scan)
+  {
+    Border ref, idx;
+    star (ref, 5000);
+    star (idx, 5000);
+    idx.close (0, 0);
+    ABORT_EX (idx.indexed (), "Index not built");
+    ref.close (0, 0);
+    ref.drop_index ();
+
+    std::mt19937 rng (2);
+    std::uniform_real_distribution<double> u (-1.1, 1.1);
+    int n_in = 0;
+    for (int i = 0; i < 100000; i++)
+    {
+      double x = u (rng), y = u (rng);
+      bool r = ref.inside (x, y);
+      CHECK_EQUAL (r, idx.inside (x, y));
+      n_in += r;
+    }
+    CHECK (n_in > 0);
+  }
+
+  // Axis-aligned polygon with vertexes and edges on grid cell centers and boundaries
+  TEST (degenerate)
+  {
+    Border ref, idx;
+    double comb[][2] = {{0, 0}, {8, 0}, {8, 8}, {6, 8}, {6, 2}, {4, 2}, {4, 8},
+                        {2, 8}, {2, 2}, {1, 2}, {1, 8}, {0, 8}};
+    for (auto& p : comb)
+    {
+      ref.add (p[0], p[1]);
+      idx.add (p[0], p[1]);
+    }
+    idx.build_index ();
+    for (double x = -0.75; x < 9; x += 0.25)
+    {
+      for (double y = -0.75; y < 9; y += 0.25)
+        CHECK_EQUAL (ref.inside (x, y), idx.inside (x, y));
+    }
+  }
+
+  // Points on edges and vertexes are classified the same way with or without index
+  TEST (boundary_points)
+  {
+    // 100 vertexes square
+    Border ref, idx;
+    for (int i = 0; i < 100; i++)
+    {
+      double t = (i % 25) * 0.4;
+      double x = (i < 25) ? t : (i < 50) ? 10 : (i < 75) ? 10 - t : 0;
+      double y = (i < 25) ? 0 : (i < 50) ? t : (i < 75) ? 10 : 10 - t;
+      ref.add (x, y);
+      idx.add (x, y);
+    }
+    idx.close (100, 100);
+    ABORT_EX (idx.indexed (), "Index not built");
+    ref.close (100, 100);
+    ref.drop_index ();
+
+    double pts[][2] = {{0, 5},   {5, 0},    {0, 0},   {3.3, 0},  {10, 10},  {10, 0},   {0, 10},
+                       {10, 5},  {5, 10},   {0.4, 0}, {0, 0.4},  {10, 3.3}, {3.3, 10}, {9.6, 10},
+                       {5, 5},   {-1, 5},   {11, 5},  {5, -1},   {5, 11}};
+    for (auto& p : pts)
+      CHECK_EQUAL (ref.inside (p[0], p[1]), idx.inside (p[0], p[1]));
+
+    for (double x = -0.2; x <= 10.2; x += 0.1)
+    {
+      for (double y : {0., 10., x})
+        CHECK_EQUAL (ref.inside (x, y), idx.inside (x, y));
+      CHECK_EQUAL (ref.inside (0, x), idx.inside (0, x));
+      CHECK_EQUAL (ref.inside (10, x), idx.inside (10, x));
+    }
+
+    // vertexes of a random polygon
+    Border sref, sidx;
+    star (sref, 5000);
+    star (sidx, 5000);
+    sidx.close (0, 0);
+    sref.close (0, 0);
+    sref.drop_index ();
+    for (auto& v : sidx.vertexes ())
+      CHECK_EQUAL (sref.inside (v.x, v.y), sidx.inside (v.x, v.y));
+  }
+
+  // Batch results are identical to point by point results
+  TEST (batch)
+  {
+    std::mt19937 rng (4);
+    std::uniform_real_distribution<double> u (-1.1, 1.1);
+    const size_t M = 10001; // not a multiple of vector size
+    std::vector<double> x (M), y (M);
+    for (size_t i = 0; i < M; i++)
+      x[i] = u (rng), y[i] = u (rng);
+    std::vector<uint8_t> res (M);
+
+    for (size_t n : {3, 50, 2000})
+    {
+      for (bool hole : {false, true})
+      {
+        Border b;
+        star (b, n);
+        b.close (hole ? 5 : 0, 0);
+        for (bool index : {false, true})
+        {
+          if (index)
+            b.build_index ();
+          else
+            b.drop_index ();
+          for (unsigned int nthreads : {1, 3})
+          {
+            size_t cnt = b.inside (x, y, res, nthreads);
+            size_t expected = 0;
+            for (size_t i = 0; i < M; i++)
+            {
+              bool r = b.inside (x[i], y[i]);
+              expected += r;
+              CHECK_EQUAL (r, (bool)res[i]);
+            }
+            CHECK_EQUAL (expected, cnt);
+          }
+        }
+      }
+    }
+
+    // points on edges and vertexes
+    for (size_t n : {20, 200})
+    {
+      Border b;
+      for (size_t i = 0; i < n; i++)
+      {
+        // square with vertexes on a 0.5 grid
+        double t = (i % (n / 4)) * 20. / n;
+        double vx = (i < n / 4) ? t : (i < n / 2) ? 5 : (i < 3 * n / 4) ? 5 - t : 0;
+        double vy = (i < n / 4) ? 0 : (i < n / 2) ? t : (i < 3 * n / 4) ? 5 : 5 - t;
+        b.add (vx, vy);
+      }
+      b.close (10, 10);
+      std::vector<double> ex, ey;
+      // repeated to have enough points to be split between threads
+      for (int k = 0; k < 1000; k++)
+      {
+        for (double v = -0.5; v <= 5.5; v += 0.25)
+        {
+          for (double w : {0., 5., v})
+          {
+            ex.push_back (v), ey.push_back (w);
+            ex.push_back (w), ey.push_back (v);
+          }
+        }
+      }
+      std::vector<uint8_t> eres (ex.size ());
+      for (bool index : {false, true})
+      {
+        if (index)
+          b.build_index ();
+        else
+          b.drop_index ();
+        for (unsigned int nthreads : {1, 3})
+        {
+          b.inside (ex, ey, eres, nthreads);
+          b.drop_index ();
+          for (size_t i = 0; i < ex.size (); i++)
+            CHECK_EQUAL (b.inside (ex[i], ey[i]), (bool)eres[i]);
+          if (index)
+            b.build_index ();
+        }
+      }
+    }
+
+    // shortest span determines number of points
+    Border b;
+    star (b, 10);
+    b.close (0, 0);
+    CHECK_EQUAL (0, b.inside (std::span (x.data (), 0), y, res));
+    CHECK (b.inside (std::span (x.data (), 10), y, res) <= 10);
+  }
+
+  TEST (batch_speed)
+  {
+    std::mt19937 rng (5);
+    std::uniform_real_distribution<double> u (-1., 1.);
+    const size_t M = 1000000;
+    std::vector<double> x (M), y (M);
+    for (size_t i = 0; i < M; i++)
+      x[i] = u (rng), y[i] = u (rng);
+    std::vector<uint8_t> res (M);
+
+    cout << "Border::inside batch speed (points/sec):" << endl;
+    for (size_t n : {20, 60, 1000, 100000})
+    {
+      Border b;
+      coast (b, n);
+      b.close (0, 0);
+
+      UnitTest::Timer t;
+      size_t n_loop = 0;
+      t.Start ();
+      for (size_t i = 0; i < M; i++)
+        n_loop += b.inside (x[i], y[i]);
+      auto dt_loop = t.GetTimeInUs ();
+
+      t.Start ();
+      size_t n_one = b.inside (x, y, res, 1);
+      auto dt_one = t.GetTimeInUs ();
+
+      t.Start ();
+      size_t n_all = b.inside (x, y, res);
+      auto dt_all = t.GetTimeInUs ();
+
+      CHECK_EQUAL (n_loop, n_one);
+      CHECK_EQUAL (n_loop, n_all);
+      cout << " " << n << " vertexes" << (b.indexed () ? " (indexed)" : "") << ": loop "
+           << (dt_loop ? M * 1000000LL / dt_loop : 0) << ", batch "
+           << (dt_one ? M * 1000000LL / dt_one : 0) << ", batch all threads "
+           << (dt_all ? M * 1000000LL / dt_all : 0) << endl;
+    }
+  }
+
+  TEST (load_text)
+  {
+    FILE* f = fopen ("border_test.txt", "wb");
+    fputs ("# triangle\n"
+           "0 0\n"
+           "\n"
+           "10,0\r\n"
+           "  +0\t10 extra text\n"
+           "1e0 1.0", // closing point without line terminator
+           f);
+    fclose (f);
+
+    Border b ("border_test.txt");
+    ABORT_EX (b.size () == 3, "Wrong number of vertexes");
+    CHECK_EQUAL (dpoint (10, 0), b.vertexes ()[1]);
+    CHECK_EQUAL (dpoint (0, 10), b.vertexes ()[2]);
+    CHECK_EQUAL (dpoint (1, 1), b.closing_point ());
+    CHECK (!b.hole ());
+    CHECK (b.inside (2, 2));
+    CHECK (!b.inside (6, 6));
+    std::filesystem::remove ("border_test.txt");
+  }
+
+  // Text and binary files read back the same border
+  TEST (save_load)
+  {
+    Border b;
+    coast (b, 1000);
+    b.close (5, 5);
+
+    Border t, u;
+    CHECK_EQUAL (0, b.save ("border_test.txt"));
+    CHECK_EQUAL (0, t.load ("border_test.txt"));
+    CHECK_EQUAL (0, b.save_binary ("border_test.bin"));
+    CHECK_EQUAL (0, u.load ("border_test.bin"));
+    ABORT_EX (t.size () == b.size () && u.size () == b.size (), "Wrong number of vertexes");
+    for (size_t i = 0; i < b.size (); i++)
+    {
+      CHECK_EQUAL (b.vertexes ()[i], t.vertexes ()[i]);
+      CHECK_EQUAL (b.vertexes ()[i], u.vertexes ()[i]);
+    }
+    CHECK_EQUAL (b.closing_point (), u.closing_point ());
+    CHECK (t.hole () && u.hole ());
+    CHECK (t.indexed () && u.indexed ());
+    CHECK_EQUAL (std::filesystem::file_size ("border_test.bin"), 32 + b.size () * sizeof (dpoint));
+    std::filesystem::remove ("border_test.txt");
+    std::filesystem::remove ("border_test.bin");
+  }
+
+  TEST (load_errors)
+  {
+    Border b;
+    erc ret = b.load ("no_such_border.txt");
+    CHECK_EQUAL (ENOENT, ret.code ());
+    ret.deactivate ();
+
+    FILE* f = fopen ("border_test.txt", "wb");
+    fputs ("no numbers here\n", f);
+    fclose (f);
+    ret = b.load ("border_test.txt");
+    CHECK_EQUAL (EINVAL, ret.code ());
+    ret.deactivate ();
+    CHECK_EQUAL (0, b.size ());
+
+    // truncated binary file
+    coast (b, 100);
+    b.close (0, 0);
+    b.save_binary ("border_test.bin");
+    std::filesystem::resize_file ("border_test.bin", 32 + 50 * sizeof (dpoint) + 8);
+    ret = b.load ("border_test.bin");
+    CHECK_EQUAL (EINVAL, ret.code ());
+    ret.deactivate ();
+    std::filesystem::remove ("border_test.txt");
+    std::filesystem::remove ("border_test.bin");
+  }
+
+  TEST (load_speed)
+  {
+    const size_t N = 1000000;
+    Border b;
+    coast (b, N);
+    b.close (0, 0);
+    b.save ("border_speed.txt");
+    b.save_binary ("border_speed.bin");
+
+    UnitTest::Timer t;
+    t.Start ();
+    Border txt ("border_speed.txt");
+    auto dt_txt = t.GetTimeInMs ();
+
+    t.Start ();
+    Border bin ("border_speed.bin");
+    auto dt_bin = t.GetTimeInMs ();
+
+    // old way: one line at a time with fgets and sscanf
+    t.Start ();
+    std::vector<dpoint> v;
+    FILE* f = fopen ("border_speed.txt", "r");
+    char ln[256];
+    dpoint p;
+    while (fgets (ln, sizeof (ln), f))
+      if (sscanf (ln, "%lf%lf", &p.x, &p.y) == 2)
+        v.push_back (p);
+    fclose (f);
+    auto dt_scanf = t.GetTimeInMs ();
+
+    bin.drop_index ();
+    t.Start ();
+    bin.build_index ();
+    auto dt_index = t.GetTimeInMs ();
+
+    CHECK_EQUAL (N, txt.size ());
+    CHECK_EQUAL (N, bin.size ());
+    CHECK_EQUAL (N + 1, v.size ());
+    CHECK (txt.indexed () && bin.indexed ());
+    cout << "Border load - " << N << " vertexes (including " << dt_index << "ms index build):"
+         << endl
+         << " text " << dt_txt << "ms (" << std::filesystem::file_size ("border_speed.txt") / 1024
+         << "kB), binary " << dt_bin << "ms ("
+         << std::filesystem::file_size ("border_speed.bin") / 1024 << "kB), fgets/sscanf parsing " << dt_scanf << "ms" << endl;
+    std::filesystem::remove ("border_speed.txt");
+    std::filesystem::remove ("border_speed.bin");
+  }
+
+  TEST (speed)
+  {
+    std::mt19937 rng (3);
+    std::uniform_real_distribution<double> u (-1., 1.);
+    cout << "Border::inside speed (points/sec):" << endl;
+    for (size_t n : {100, 1000, 10000, 100000})
+    {
+      Border b;
+      coast (b, n);
+      UnitTest::Timer t;
+      t.Start ();
+      b.close (0, 0);
+      auto dt_build = t.GetTimeInUs ();
+
+      const int M = 200000;
+      std::vector<dpoint> pts (M);
+      for (auto& p : pts)
+        p = dpoint (u (rng), u (rng));
+
+      int n_idx = 0;
+      t.Start ();
+      for (auto& p : pts)
+        n_idx += b.inside (p.x, p.y);
+      auto dt_idx = t.GetTimeInUs ();
+
+      // scan is slow for big polygons; use fewer points
+      int m = (int)(std::min) ((size_t)M, 100000000 / n);
+      b.drop_index ();
+      int n_scan = 0, n_check = 0;
+      t.Start ();
+      for (int i = 0; i < m; i++)
+        n_scan += b.inside (pts[i].x, pts[i].y);
+      auto dt_scan = t.GetTimeInUs ();
+
+      b.build_index ();
+      for (int i = 0; i < m; i++)
+        n_check += b.inside (pts[i].x, pts[i].y);
+      CHECK_EQUAL (n_scan, n_check);
+      CHECK (n_idx > 0);
+
+      cout << " " << n << " vertexes: scan " << (dt_scan ? m * 1000000LL / dt_scan : 0)
+           << ", indexed " << (dt_idx ? M * 1000000LL / dt_idx : 0) << " (index built in "
+           << dt_build << "us)" << endl;
+    }
+  }
+}
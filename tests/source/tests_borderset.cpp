@@ -0,0 +1,204 @@
+#include <utpp/utpp.h>
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <iostream>
+#include <random>
+
+using namespace mlib;
+using namespace std;
+
+SUITE (borderset)
+{
+  // Random star-shaped border centered at (cx, cy)
+  static Border area (double cx, double cy, double r, size_t n, std::mt19937& rng)
+  {
+    std::uniform_real_distribution<double> rad (0.5 * r, r);
+    Border b;
+    for (size_t i = 0; i < n; i++)
+    {
+      double a = 2 * M_PI * i / n;
+      double ri = rad (rng);
+      b.add (cx + ri * cos (a), cy + ri * sin (a));
+    }
+    b.close (cx, cy);
+    return b;
+  }
+
+  // Set of many overlapping areas scattered on a 100x100 square
+  struct random_set
+  {
+    random_set (size_t n, unsigned int seed = 1)
+      : rng (seed)
+    {
+      std::uniform_real_distribution<double> pos (0, 100), size (0.5, 5);
+      for (size_t i = 0; i < n; i++)
+      {
+        size_t id = set.insert (area (pos (rng), pos (rng), size (rng), 20, rng));
+        all.push_back (id);
+      }
+    }
+
+    // Borders containing a point, found by checking every border
+    std::vector<size_t> brute (double x, double y)
+    {
+      std::vector<size_t> ids;
+      for (auto id : all)
+      {
+        if (set.contains (id) && set[id].inside (x, y))
+          ids.push_back (id);
+      }
+      std::sort (ids.begin (), ids.end ());
+      return ids;
+    }
+
+    std::mt19937 rng;
+    BorderSet set;
+    std::vector<size_t> all;
+  };
+
+  TEST (find)
+  {
+    random_set rs (2000);
+    CHECK_EQUAL (2000, rs.set.size ());
+    CHECK (rs.set.height () > 2);
+
+    std::uniform_real_distribution<double> u (-5, 105);
+    std::vector<size_t> ids;
+    size_t total = 0;
+    for (int i = 0; i < 10000; i++)
+    {
+      double x = u (rs.rng), y = u (rs.rng);
+      rs.set.find (x, y, ids);
+      CHECK (ids == rs.brute (x, y));
+      total += ids.size ();
+    }
+    CHECK (total > 0);
+  }
+
+  TEST (remove)
+  {
+    random_set rs (1000, 2);
+    CHECK (!rs.set.remove (1000)); // no such border
+
+    // remove borders in random order and check results as we go
+    std::shuffle (rs.all.begin (), rs.all.end (), rs.rng);
+    std::uniform_real_distribution<double> u (0, 100);
+    std::vector<size_t> ids;
+    for (size_t i = 0; i < rs.all.size (); i++)
+    {
+      CHECK (rs.set.remove (rs.all[i]));
+      CHECK (!rs.set.contains (rs.all[i]));
+      if (i % 50 == 0)
+      {
+        for (int j = 0; j < 200; j++)
+        {
+          double x = u (rs.rng), y = u (rs.rng);
+          rs.set.find (x, y, ids);
+          CHECK (ids == rs.brute (x, y));
+        }
+      }
+    }
+    CHECK_EQUAL (0, rs.set.size ());
+    CHECK_EQUAL (0, rs.set.find (50, 50, ids));
+
+    // identifiers are reused
+    size_t id = rs.set.insert (area (50, 50, 1, 10, rs.rng));
+    CHECK (id < 1000);
+    CHECK_EQUAL (1, rs.set.find (50, 50, ids));
+    CHECK_EQUAL (id, ids[0]);
+  }
+
+  TEST (holes)
+  {
+    BorderSet s;
+    std::mt19937 rng (3);
+    Border h = area (0, 0, 1, 10, rng);
+    h.close (10, 10);
+    size_t ih = s.insert (h);
+    size_t ia = s.insert (area (20, 20, 1, 10, rng));
+    Border empty;
+    size_t ie = s.insert (empty);
+    CHECK_EQUAL (3, s.size ());
+
+    std::vector<size_t> ids;
+    CHECK_EQUAL (0, s.find (0, 0, ids)); // inside hole
+    CHECK_EQUAL (2, s.find (20, 20, ids));
+    CHECK_EQUAL (ih, ids[0]);
+    CHECK_EQUAL (ia, ids[1]);
+
+    CHECK (s.remove (ih));
+    CHECK (s.remove (ie));
+    CHECK_EQUAL (1, s.find (20, 20, ids));
+    CHECK_EQUAL (0, s.find (100, 100, ids));
+  }
+
+  // Batch results are identical to point by point results
+  TEST (batch)
+  {
+    random_set rs (500, 4);
+    std::uniform_real_distribution<double> u (0, 100);
+    const size_t M = 20001;
+    std::vector<double> x (M), y (M);
+    for (size_t i = 0; i < M; i++)
+      x[i] = u (rs.rng), y[i] = u (rs.rng);
+
+    for (unsigned int nthreads : {1, 3})
+    {
+      std::vector<size_t> start, ids, one;
+      size_t n = rs.set.find (x, y, start, ids, nthreads);
+      ABORT_EX (start.size () == M + 1, "Wrong size of start vector");
+      CHECK_EQUAL (n, ids.size ());
+      CHECK_EQUAL (n, start[M]);
+      for (size_t i = 0; i < M; i++)
+      {
+        rs.set.find (x[i], y[i], one);
+        CHECK (std::equal (one.begin (), one.end (), ids.begin () + start[i],
+                           ids.begin () + start[i + 1]));
+      }
+    }
+  }
+
+  TEST (speed)
+  {
+    std::uniform_real_distribution<double> u (0, 100);
+    const size_t M = 100000;
+    cout << "BorderSet::find speed (points/sec):" << endl;
+    for (size_t n : {100, 1000, 10000})
+    {
+      UnitTest::Timer t;
+      t.Start ();
+      random_set rs (n, 5);
+      auto dt_build = t.GetTimeInMs ();
+
+      std::vector<double> x (M), y (M);
+      for (size_t i = 0; i < M; i++)
+        x[i] = u (rs.rng), y[i] = u (rs.rng);
+
+      // checking every border is slow for many borders; use fewer points
+      size_t m = (std::min) (M, 10000000 / n);
+      size_t n_brute = 0, n_check = 0;
+      t.Start ();
+      for (size_t i = 0; i < m; i++)
+        n_brute += rs.brute (x[i], y[i]).size ();
+      auto dt_brute = t.GetTimeInUs ();
+
+      std::vector<size_t> ids, start;
+      t.Start ();
+      for (size_t i = 0; i < M; i++)
+        rs.set.find (x[i], y[i], ids);
+      auto dt_find = t.GetTimeInUs ();
+
+      t.Start ();
+      rs.set.find (x, y, start, ids);
+      auto dt_batch = t.GetTimeInUs ();
+
+      n_check = start[m];
+      CHECK_EQUAL (n_brute, n_check);
+      cout << " " << n << " borders: all borders " << (dt_brute ? m * 1000000LL / dt_brute : 0)
+           << ", R-tree " << (dt_find ? M * 1000000LL / dt_find : 0) << ", batch "
+           << (dt_batch ? M * 1000000LL / dt_batch : 0) << " (set built in " << dt_build
+           << "ms, tree height " << rs.set.height () << ")" << endl;
+    }
+  }
+}
@@ -0,0 +1,183 @@
+#include <utpp/utpp.h>
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <iostream>
+#include <random>
+
+using namespace mlib;
+using namespace std;
+
+SUITE (chull)
+{
+  // Check that hull is convex, counterclockwise and contains all points
+  template <typename T>
+  static bool is_hull (const std::vector<Point<T>>& pts, const Point<T>* h, size_t n)
+  {
+    if (n < 3)
+      return false;
+    for (size_t i = 0; i < n; i++)
+    {
+      const Point<T>& a = h[i];
+      const Point<T>& b = h[(i + 1) % n];
+      if (detail::hull_orient (a, b, h[(i + 2) % n]) <= 0)
+        return false; // not strictly convex
+      for (auto& p : pts)
+        if (detail::hull_orient (a, b, p) < 0)
+          return false; // point outside
+    }
+    return true;
+  }
+
+  TEST (square)
+  {
+    dpoint pts[] = {{1, 1}, {0, 0}, {2, 0}, {0.5, 1.5}, {2, 2}, {0, 2}, {1, 0}};
+    int n = convex_hull (pts, (int)std::size (pts));
+    CHECK_EQUAL (4, n);
+    CHECK_EQUAL (dpoint (0, 0), pts[0]);
+    CHECK_EQUAL (dpoint (2, 0), pts[1]);
+    CHECK_EQUAL (dpoint (2, 2), pts[2]);
+    CHECK_EQUAL (dpoint (0, 2), pts[3]);
+  }
+
+  TEST (small)
+  {
+    dpoint p1[] = {{1, 1}};
+    CHECK_EQUAL (1, convex_hull (p1, 1));
+    dpoint p2[] = {{1, 1}, {0, 0}};
+    CHECK_EQUAL (2, convex_hull (p2, 2));
+    CHECK_EQUAL (dpoint (0, 0), p2[0]);
+    dpoint p3[] = {{0, 0}, {2, 2}, {1, 1}}; // collinear points
+    CHECK_EQUAL (2, convex_hull (p3, 3));
+    CHECK_EQUAL (0, convex_hull (p3, 0));
+  }
+
+  // Integer and float points
+  TEST (types)
+  {
+    std::mt19937 rng (1);
+    std::uniform_int_distribution<int> ui (-1000, 1000);
+    std::vector<Point<int>> ip (1000);
+    for (auto& p : ip)
+      p = Point<int> (ui (rng), ui (rng));
+    auto iv = ip;
+    size_t n = convex_hull (iv.data (), iv.size ());
+    CHECK (is_hull (ip, iv.data (), n));
+
+    std::normal_distribution<float> uf;
+    std::vector<Point<float>> fp (1000);
+    for (auto& p : fp)
+      p = Point<float> (uf (rng), uf (rng));
+    auto fv = fp;
+    n = convex_hull (fv.data (), fv.size ());
+    CHECK (is_hull (fp, fv.data (), n));
+  }
+
+  // Parallel and sequential versions find the same hull
+  TEST (parallel)
+  {
+    std::mt19937 rng (2);
+    std::normal_distribution<double> u;
+    std::vector<dpoint> pts (500000);
+    for (auto& p : pts)
+      p = dpoint (u (rng), u (rng));
+
+    auto seq = pts, par = pts;
+    size_t ns = convex_hull (seq.data (), seq.size ());
+    size_t np = convex_hull (par.data (), par.size (), 4);
+    CHECK (is_hull (pts, seq.data (), ns));
+    ABORT_EX (ns == np, "Different hull sizes");
+    for (size_t i = 0; i < ns; i++)
+      CHECK_EQUAL (seq[i], par[i]);
+
+    // array is still a permutation of input points
+    auto lower = [] (const dpoint& a, const dpoint& b) {
+      return a.x < b.x || (a.x == b.x && a.y < b.y);
+    };
+    std::sort (par.begin (), par.end (), lower);
+    std::sort (pts.begin (), pts.end (), lower);
+    CHECK (par == pts);
+  }
+
+  TEST (online)
+  {
+    std::mt19937 rng (3);
+    std::normal_distribution<double> u;
+    std::vector<dpoint> pts;
+    OnlineHull<double> oh;
+    CHECK (oh.hull ().empty ());
+    for (int i = 0; i < 20000; i++)
+    {
+      dpoint p (u (rng), u (rng));
+      pts.push_back (p);
+      oh.add (p);
+      if (i % 997 == 0 && i > 10)
+      {
+        auto v = pts;
+        size_t n = convex_hull (v.data (), v.size ());
+        auto& h = oh.hull ();
+        ABORT_EX (h.size () == n, "Different hull sizes");
+        for (size_t k = 0; k < n; k++)
+          CHECK_EQUAL (v[k], h[k]);
+      }
+    }
+    CHECK_EQUAL (20000, oh.count ());
+    CHECK (oh.inside (dpoint (0, 0)));
+    CHECK (!oh.inside (dpoint (100, 0)));
+    CHECK (oh.area () > 0);
+
+    oh.clear ();
+    oh.add (dpoint (0, 0));
+    oh.add (dpoint (1, 0));
+    oh.add (dpoint (1, 1));
+    oh.add (dpoint (0, 1));
+    oh.add (dpoint (0.5, 0.5));
+    CHECK_CLOSE (1., oh.area (), 1e-12);
+    CHECK_EQUAL (4, oh.hull ().size ());
+    CHECK (oh.inside (dpoint (1, 0.5))); // on boundary
+  }
+
+  TEST (speed)
+  {
+    std::mt19937 rng (4);
+    std::normal_distribution<double> u;
+    const size_t N = 2000000;
+    std::vector<dpoint> pts (N);
+    for (auto& p : pts)
+      p = dpoint (u (rng), u (rng));
+
+    // original implementation with qsort
+    static auto cmpl = [] (const void* a, const void* b) -> int {
+      auto pa = (const dpoint*)a, pb = (const dpoint*)b;
+      return pa->x < pb->x ? -1 : pa->x > pb->x ? 1 : pa->y < pb->y ? -1 : pa->y > pb->y;
+    };
+    auto v = pts;
+    UnitTest::Timer t;
+    t.Start ();
+    qsort (v.data (), v.size (), sizeof (dpoint), cmpl);
+    auto dt_qsort = t.GetTimeInMs ();
+
+    v = pts;
+    t.Start ();
+    size_t n1 = convex_hull (v.data (), v.size ());
+    auto dt_one = t.GetTimeInMs ();
+
+    v = pts;
+    t.Start ();
+    size_t n_all = convex_hull (v.data (), v.size (), 0);
+    auto dt_all = t.GetTimeInMs ();
+    CHECK_EQUAL (n1, n_all);
+
+    OnlineHull<double> oh;
+    t.Start ();
+    for (auto& p : pts)
+      oh.add (p);
+    auto h = oh.hull ();
+    auto dt_online = t.GetTimeInMs ();
+    CHECK_EQUAL (n1, h.size ());
+
+    cout << "Convex hull of " << N << " points (" << n1 << " hull points):" << endl
+         << " qsort only " << dt_qsort << "ms, one thread " << dt_one << "ms, all threads "
+         << dt_all << "ms, online " << dt_online << "ms" << endl;
+  }
+}
@@ -2,7 +2,11 @@
 #include <mlib/mlib.h>
 #pragma hdrstop
 
+#include <iostream>
+#include <random>
+
 using namespace mlib;
+using namespace std;
 
 SUITE (Convert)
 {
@@ -46,6 +50,11 @@ SUITE (Convert)
     CHECK_CLOSE (12.3456, atodeg ("12.3456"), 1e-4);
     CHECK_CLOSE (-12.3456, atodeg ("-12.3456"), 1e-4);
     CHECK_CLOSE (-12.3456, atodeg ("12.3456W"), 1e-4);
+
+    //blanks
+    CHECK_EQUAL (45.5, atodeg (" 45.5N"));
+    CHECK_EQUAL (-130.5, atodeg ("130.5 W"));
+    CHECK_EQUAL (-DMS (12, 34, 56) / D2R, atodeg (u8"\t12° 34' 56\" S "));
   }
 
   TEST (degtoa)
@@ -57,4 +66,174 @@ SUITE (Convert)
     CHECK_EQUAL (u8"012.3457°E", degtoa (12.345678, deg_fmt::degrees, false, 4));
     CHECK_EQUAL (u8"12.3457°N", degtoa (12.345678, deg_fmt::degrees, true, 4));
   }
-}
\ No newline at end of file
+
+  TEST (degtoa_buffer)
+  {
+    char buf[32];
+    auto r = degtoa (buf, buf + sizeof (buf), DMS (12, 34, 56) / D2R, deg_fmt::seconds, true, 2);
+    CHECK (r.ec == std::errc ());
+    CHECK_EQUAL (u8"12°34'56.00\"N", std::string (buf, r.ptr));
+
+    // rounding carries into minutes and degrees
+    r = degtoa (buf, buf + sizeof (buf), DMS (12, 59, 59.999) / D2R, deg_fmt::seconds, true, 2);
+    CHECK_EQUAL (u8"13°00'00.00\"N", std::string (buf, r.ptr));
+    r = degtoa (buf, buf + sizeof (buf), -DM (179, 59.9999) / D2R, deg_fmt::minutes, false, 3);
+    CHECK_EQUAL (u8"180°00.000'W", std::string (buf, r.ptr));
+    r = degtoa (buf, buf + sizeof (buf), 45.5, deg_fmt::degrees, false, 0);
+    CHECK_EQUAL (u8"046°E", std::string (buf, r.ptr));
+
+    // buffer too small
+    r = degtoa (buf, buf + 10, 12.5, deg_fmt::seconds, true, 2);
+    CHECK (r.ec == std::errc::value_too_large);
+    CHECK (r.ptr == buf + 10);
+
+    // non-finite values
+    r = degtoa (buf, buf + sizeof (buf), NAN, deg_fmt::degrees, true, 2);
+    CHECK (r.ec == std::errc::invalid_argument);
+    CHECK_EQUAL ("", degtoa (INFINITY, deg_fmt::degrees, true, 2));
+  }
+
+  TEST (atodeg_buffer)
+  {
+    const char* str = u8"12°34'56.78\"S rest";
+    double val = 0;
+    auto r = atodeg (str, str + strlen (str), val);
+    CHECK (r.ec == std::errc ());
+    CHECK_EQUAL (-DMS (12, 34, 56.78) / D2R, val);
+    CHECK_EQUAL ("rest", r.ptr);
+
+    // trailing blanks are consumed
+    str = "130.5 W  ,";
+    r = atodeg (str, str + strlen (str), val);
+    CHECK_EQUAL (-130.5, val);
+    CHECK_EQUAL (",", r.ptr);
+
+    // only the given range is parsed
+    str = "12.5E";
+    r = atodeg (str, str + 3, val);
+    CHECK_EQUAL (12., val);
+    CHECK (r.ptr == str + 3);
+
+    // invalid input leaves value unchanged
+    str = "abc";
+    r = atodeg (str, str + 3, val);
+    CHECK (r.ec == std::errc::invalid_argument);
+    CHECK (r.ptr == str);
+    CHECK_EQUAL (12., val);
+  }
+
+  // Every arc-second of longitude converts back to the same value
+  TEST (round_trip_exhaustive)
+  {
+    char buf[32];
+    int errors = 0;
+    for (int s = -180 * 3600; s <= 180 * 3600; s++)
+    {
+      double deg = s / 3600.;
+      auto r = degtoa (buf, buf + sizeof (buf), deg, deg_fmt::seconds, false, 0);
+      double val;
+      atodeg (buf, r.ptr, val);
+      if (fabs (val - deg) > 1e-12)
+        errors++;
+    }
+    CHECK_EQUAL (0, errors);
+  }
+
+  // Random values, all formats and precisions, are within half a unit of the last digit
+  TEST (round_trip_random)
+  {
+    std::mt19937 rng (1);
+    std::uniform_real_distribution<double> lat (-90, 90), lon (-180, 180);
+    char buf[32];
+    for (auto fmt : {deg_fmt::degrees, deg_fmt::minutes, deg_fmt::seconds})
+    {
+      double scale = (fmt == deg_fmt::seconds) ? 3600 : (fmt == deg_fmt::minutes) ? 60 : 1;
+      for (int prec = 0; prec <= 6; prec++)
+      {
+        double tol = 0.5 / scale / pow (10, prec) + 1e-12;
+        int errors = 0;
+        for (int i = 0; i < 10000; i++)
+        {
+          bool is_lat = i % 2;
+          double deg = is_lat ? lat (rng) : lon (rng);
+          auto r = degtoa (buf, buf + sizeof (buf), deg, fmt, is_lat, prec);
+          double val;
+          atodeg (buf, r.ptr, val);
+          if (fabs (val - deg) > tol || std::string (buf, r.ptr) != degtoa (deg, fmt, is_lat, prec))
+            errors++;
+        }
+        CHECK_EQUAL (0, errors);
+      }
+    }
+  }
+
+  TEST (batch)
+  {
+    std::vector<double> in{12.5, -45.25, 0, 179.999, -0.5}, out (5);
+    char buf[128];
+    auto r = degtoa (buf, buf + sizeof (buf), in, deg_fmt::minutes, false, 2);
+    CHECK (r.ec == std::errc ());
+    CHECK_EQUAL (u8"012°30.00'E\n045°15.00'W\n000°00.00'E\n179°59.94'E\n000°30.00'W\n",
+                 std::string (buf, r.ptr));
+    CHECK_EQUAL (5, atodeg (buf, r.ptr, out));
+    for (size_t i = 0; i < in.size (); i++)
+      CHECK_CLOSE (in[i], out[i], 1e-9);
+
+    // stops after last value that fits
+    r = degtoa (buf, buf + 30, in, deg_fmt::minutes, false, 2);
+    CHECK (r.ec == std::errc::value_too_large);
+    CHECK_EQUAL (u8"012°30.00'E\n045°15.00'W\n", std::string (buf, r.ptr));
+
+    // invalid fields produce NaN
+    const char* str = "12.5N,xyz,-3";
+    CHECK_EQUAL (3, atodeg (str, str + strlen (str), out, ','));
+    CHECK_EQUAL (12.5, out[0]);
+    CHECK (isnan (out[1]));
+    CHECK_EQUAL (-3., out[2]);
+
+    // separator that could be part of a value
+    str = "12.5 xyz 7.5 W";
+    CHECK_EQUAL (4, atodeg (str, str + strlen (str), out, ' '));
+    CHECK_EQUAL (12.5, out[0]);
+    CHECK (isnan (out[1]));
+    CHECK_EQUAL (7.5, out[2]);
+    CHECK (isnan (out[3]));
+  }
+
+  // Batch versions don't allocate memory. Formatting is faster than with the string
+  // versions; parsing takes about the same time because it is dominated by number
+  // conversions.
+  TEST (speed)
+  {
+    const size_t N = 1000000;
+    std::mt19937 rng (2);
+    std::uniform_real_distribution<double> lon (-180, 180);
+    std::vector<double> in (N), out (N);
+    for (auto& v : in)
+      v = lon (rng);
+    std::vector<std::string> strs (N);
+    std::vector<char> buf (N * 20);
+    UnitTest::Timer t;
+
+    t.Start ();
+    for (size_t i = 0; i < N; i++)
+      strs[i] = degtoa (in[i], deg_fmt::seconds, false, 3);
+    auto dt_str = t.GetTimeInMs ();
+    t.Start ();
+    auto r = degtoa (buf.data (), buf.data () + buf.size (), in, deg_fmt::seconds, false, 3);
+    auto dt_buf = t.GetTimeInMs ();
+    CHECK (r.ec == std::errc ());
+
+    t.Start ();
+    for (size_t i = 0; i < N; i++)
+      out[i] = atodeg (strs[i]);
+    auto dt_atostr = t.GetTimeInMs ();
+    t.Start ();
+    CHECK_EQUAL (N, atodeg (buf.data (), r.ptr, out));
+    auto dt_atobuf = t.GetTimeInMs ();
+
+    cout << "Conversion of " << N << " longitude values (ms):" << endl
+         << " degtoa - string " << dt_str << ", buffer " << dt_buf << endl
+         << " atodeg - string " << dt_atostr << ", buffer " << dt_atobuf << endl;
+  }
+}
@@ -0,0 +1,157 @@
+#include <utpp/utpp.h>
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <iostream>
+#include <random>
+
+using namespace mlib;
+using namespace std;
+
+SUITE (geodesy)
+{
+  // Random coordinates with some special cases at the beginning
+  struct pairs
+  {
+    pairs (size_t n, unsigned int seed)
+      : lat1 (n)
+      , lon1 (n)
+      , lat2 (n)
+      , lon2 (n)
+    {
+      std::mt19937 rng (seed);
+      std::uniform_real_distribution<double> lat (-M_PI / 2, M_PI / 2), lon (-M_PI, M_PI);
+      for (size_t i = 0; i < n; i++)
+      {
+        lat1[i] = lat (rng);
+        lon1[i] = lon (rng);
+        lat2[i] = lat (rng);
+        lon2[i] = lon (rng);
+      }
+      lat2[0] = lat1[0]; // coincident
+      lon2[0] = lon1[0];
+      lat1[1] = 90_deg; // from North pole
+      lon1[2] = 179_deg; // across antimeridian
+      lon2[2] = -179_deg;
+      lat2[3] = lat1[3]; // along meridian
+      lon2[3] = lon1[3];
+    }
+    std::vector<double> lat1, lon1, lat2, lon2;
+  };
+
+  TEST (haversine_known)
+  {
+    // on a sphere where 1 arc-minute is 1 nautical mile
+    const double r = 1_nmi * 60 * 180 / M_PI;
+    double az;
+    CHECK_CLOSE (1852., haversine (45_deg, 10_deg, 45_deg + 1_arcmin, 10_deg, &az, r), 1e-6);
+    CHECK_CLOSE (0., az, 1e-12);
+    CHECK_CLOSE (90 * 60_nmi, haversine (0, 0, 0, 90_deg, &az, r), 1e-6);
+    CHECK_CLOSE (90_deg, az, 1e-12);
+    CHECK_CLOSE (180 * 60_nmi, haversine (0, 0, 0, 180_deg, nullptr, r), 1e-6);
+    CHECK_CLOSE (1.2_nmi, haversine (0, 179.99_deg, 0, -179.99_deg, &az, r), 1e-6);
+    CHECK_CLOSE (90_deg, az, 1e-12);
+
+    CHECK_EQUAL (0., haversine (10_deg, 20_deg, 10_deg, 20_deg, &az));
+    CHECK_EQUAL (0., az);
+  }
+
+  TEST (vincenty_known)
+  {
+    // Vincenty (1975) test line: Flinders Peak to Buninyong
+    double d, az1, az2;
+    double lat1 = -375703.72030_dms, lon1 = 1442529.52440_dms;
+    double lat2 = -373910.15610_dms, lon2 = 1435535.38390_dms;
+    CHECK (vincenty (lat1, lon1, lat2, lon2, d, &az1, &az2));
+    CHECK_CLOSE (54972.271, d, 1e-3);
+    CHECK_CLOSE (3065205.37_dms, az1, 0.01_arcsec);
+    CHECK_CLOSE (3071025.07_dms, az2, 0.01_arcsec);
+
+    // quarter meridian
+    CHECK (vincenty (0, 0, 90_deg, 0, d));
+    CHECK_CLOSE (10001965.729, d, 1e-3);
+
+    // along equator
+    CHECK (vincenty (0, 0, 0, 1_deg, d, &az1));
+    CHECK_CLOSE (A_WGS84 * 1_deg, d, 1e-6);
+    CHECK_CLOSE (90_deg, az1, 1e-12);
+
+    CHECK (vincenty (10_deg, 20_deg, 10_deg, 20_deg, d, &az1));
+    CHECK_EQUAL (0., d);
+
+    // nearly antipodal points
+    CHECK (!vincenty (0, 0, 0.5_deg, 179.7_deg, d, &az1));
+    CHECK (isnan (d));
+  }
+
+  // Batch results match those of scalar functions
+  TEST (batch)
+  {
+    const size_t N = 100003;
+    pairs p (N, 1);
+    std::vector<double> d (N), az (N), az2 (N);
+    for (unsigned int nthreads : {1u, 4u})
+    {
+      haversine (p.lat1, p.lon1, p.lat2, p.lon2, d, az, nthreads);
+      for (size_t i = 0; i < N; i++)
+      {
+        double a;
+        CHECK_CLOSE (haversine (p.lat1[i], p.lon1[i], p.lat2[i], p.lon2[i], &a), d[i], 1e-6);
+        CHECK_CLOSE (a, az[i], 1e-10);
+      }
+
+      size_t failed = vincenty (p.lat1, p.lon1, p.lat2, p.lon2, d, az, az2, nthreads);
+      size_t failed1 = 0;
+      for (size_t i = 0; i < N; i++)
+      {
+        double d1, a1, a2;
+        if (!vincenty (p.lat1[i], p.lon1[i], p.lat2[i], p.lon2[i], d1, &a1, &a2))
+        {
+          failed1++;
+          CHECK (isnan (d[i]));
+          continue;
+        }
+        CHECK_EQUAL (d1, d[i]);
+        CHECK_EQUAL (a1, az[i]);
+        CHECK_EQUAL (a2, az2[i]);
+      }
+      CHECK_EQUAL (failed1, failed);
+    }
+
+    // azimuths are optional
+    haversine (p.lat1, p.lon1, p.lat2, p.lon2, d);
+    CHECK_EQUAL (0., d[0]);
+    CHECK_CLOSE (M_PI / 2 - p.lat2[1], d[1] / R_EARTH, 1e-12);
+  }
+
+  TEST (speed)
+  {
+    const size_t N = 1000000;
+    pairs p (N, 2);
+    std::vector<double> d (N), az (N);
+    UnitTest::Timer t;
+
+    t.Start ();
+    for (size_t i = 0; i < N; i++)
+      d[i] = haversine (p.lat1[i], p.lon1[i], p.lat2[i], p.lon2[i], &az[i]);
+    auto dt_hav1 = t.GetTimeInMs ();
+    t.Start ();
+    haversine (p.lat1, p.lon1, p.lat2, p.lon2, d, az, 1);
+    auto dt_hav = t.GetTimeInMs ();
+    t.Start ();
+    haversine (p.lat1, p.lon1, p.lat2, p.lon2, d, az);
+    auto dt_havn = t.GetTimeInMs ();
+
+    t.Start ();
+    vincenty (p.lat1, p.lon1, p.lat2, p.lon2, d, az, {}, 1);
+    auto dt_vin = t.GetTimeInMs ();
+    t.Start ();
+    vincenty (p.lat1, p.lon1, p.lat2, p.lon2, d, az);
+    auto dt_vinn = t.GetTimeInMs ();
+
+    cout << "Distance and azimuth for " << N << " pairs (ms):" << endl
+         << " haversine - scalar loop " << dt_hav1 << ", batch " << dt_hav
+         << ", batch all threads " << dt_havn << endl
+         << " Vincenty - batch " << dt_vin << ", batch all threads " << dt_vinn << endl;
+  }
+}
@@ -174,4 +174,76 @@ SUITE (poly)
     double vv = poly (M_PI/2, a);
     CHECK_CLOSE (1.0, vv, 0.001);
   }
+
+  // Batch evaluation gives the same results as scalar function
+  TEST (batch_poly)
+  {
+    std::vector<double> x (1003), out (x.size ());
+    for (size_t i = 0; i < x.size (); i++)
+      x[i] = -2. + i * 0.004;
+
+    for (int n = 0; n <= 20; n++)
+    {
+      std::vector<double> c (n);
+      for (int k = 0; k < n; k++)
+        c[k] = 1. / (k + 1) - 0.3 * k;
+
+      poly<double> (x, out, c.data (), n);
+      for (size_t i = 0; i < x.size (); i++)
+        CHECK_CLOSE (n ? poly (x[i], c) : 0., out[i], 1e-12);
+    }
+
+    std::array<double, 4> c3{1, -2, 0.5, 0.25};
+    poly (x, out, c3);
+    for (size_t i = 0; i < x.size (); i++)
+      CHECK_CLOSE (poly (x[i], c3), out[i], 1e-12);
+
+    // in place
+    auto y = x;
+    poly (y, y, c3);
+    CHECK_ARRAY_EQUAL (out, y, (int)y.size ());
+
+    // other types
+    std::vector<int> xi{0, 1, 2, 3}, outi (4);
+    poly (xi, outi, std::array<int, 4>{1, 3, 3, 1});
+    CHECK_EQUAL (27, outi[2]);
+    CHECK_EQUAL (64, outi[3]);
+  }
+
+  // Calibration polynomial applied to blocks of sensor samples
+  TEST (batch_speed)
+  {
+    const size_t N = 4096, blocks = 1000;
+    std::vector<double> x (N), out (N);
+    for (size_t i = 0; i < N; i++)
+      x[i] = sin (i * 0.001);
+    std::vector<double> cv{0.1, 1.02, -3e-3, 4e-5, -5e-7, 6e-9};
+    std::array<double, 6> ca{0.1, 1.02, -3e-3, 4e-5, -5e-7, 6e-9};
+    UnitTest::Timer t;
+
+    t.Start ();
+    for (size_t k = 0; k < blocks; k++)
+    {
+      for (size_t i = 0; i < N; i++)
+        out[i] = poly (x[i], cv.data (), (int)cv.size ());
+    }
+    auto dt_loop = t.GetTimeInUs ();
+
+    t.Start ();
+    for (size_t k = 0; k < blocks; k++)
+    {
+      for (size_t i = 0; i < N; i++)
+        out[i] = poly (x[i], ca);
+    }
+    auto dt_unrolled = t.GetTimeInUs ();
+
+    t.Start ();
+    for (size_t k = 0; k < blocks; k++)
+      poly (x, out, cv);
+    auto dt_batch = t.GetTimeInUs ();
+
+    cout << "Polynomial (degree 5) evaluation of " << N * blocks << " points (us):" << endl
+         << " scalar loop " << dt_loop << ", unrolled loop " << dt_unrolled << ", batch "
+         << dt_batch << endl;
+  }
 }
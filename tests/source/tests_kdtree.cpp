@@ -0,0 +1,188 @@
+#include <utpp/utpp.h>
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <iostream>
+#include <random>
+
+using namespace mlib;
+using namespace std;
+
+SUITE (kdtree)
+{
+  static std::vector<dpoint> random_points (size_t n, unsigned int seed = 1)
+  {
+    std::mt19937 rng (seed);
+    std::uniform_real_distribution<double> u (-100, 100);
+    std::vector<dpoint> pts (n);
+    for (auto& p : pts)
+      p = dpoint (u (rng), u (rng));
+    return pts;
+  }
+
+  // Brute force k nearest points, ties broken by index
+  static std::vector<size_t> brute_knn (const std::vector<dpoint>& pts, const dpoint& q, size_t k)
+  {
+    std::vector<std::pair<double, size_t>> d;
+    for (size_t i = 0; i < pts.size (); i++)
+    {
+      double dx = pts[i].x - q.x, dy = pts[i].y - q.y;
+      d.emplace_back (dx * dx + dy * dy, i);
+    }
+    std::sort (d.begin (), d.end ());
+    std::vector<size_t> ids;
+    for (size_t i = 0; i < k && i < d.size (); i++)
+      ids.push_back (d[i].second);
+    return ids;
+  }
+
+  TEST (empty)
+  {
+    KdTree<double> t;
+    std::vector<size_t> ids;
+    CHECK_EQUAL (0, t.size ());
+    CHECK_EQUAL (SIZE_MAX, t.nearest (dpoint (1, 2)));
+    CHECK_EQUAL (0, t.nearest (dpoint (1, 2), 3, ids));
+    CHECK_EQUAL (0, t.radius (dpoint (1, 2), 10, ids));
+  }
+
+  TEST (nearest)
+  {
+    auto pts = random_points (5000);
+    pts[10] = pts[20] = dpoint (1, 1); // duplicates
+    KdTree<double> t (pts);
+    CHECK_EQUAL (pts.size (), t.size ());
+
+    auto queries = random_points (500, 2);
+    queries.push_back (dpoint (1, 1));
+    queries.push_back (dpoint (500, -500)); // far outside
+    std::vector<size_t> ids;
+    for (auto& q : queries)
+    {
+      auto expected = brute_knn (pts, q, 7);
+      CHECK_EQUAL (expected[0], t.nearest (q));
+      CHECK_EQUAL (7, t.nearest (q, 7, ids));
+      CHECK (ids == expected);
+    }
+    CHECK_EQUAL (10, t.nearest (dpoint (1, 1)));
+
+    // more neighbours than points
+    KdTree<double> small (std::span (pts.data (), 5));
+    CHECK_EQUAL (5, small.nearest (dpoint (0, 0), 10, ids));
+  }
+
+  TEST (radius)
+  {
+    auto pts = random_points (5000);
+    KdTree<double> t (pts);
+    auto queries = random_points (200, 3);
+    std::vector<size_t> ids;
+    for (double r : {0., 1., 5., 30.})
+    {
+      for (auto& q : queries)
+      {
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < pts.size (); i++)
+          if (q.distance (pts[i]) <= r)
+            expected.push_back (i);
+        CHECK_EQUAL (expected.size (), t.radius (q, r, ids));
+        CHECK (ids == expected);
+      }
+    }
+    // query at a tree point with zero radius finds it
+    CHECK_EQUAL (1, t.radius (pts[42], 0, ids));
+    CHECK_EQUAL (42, ids[0]);
+  }
+
+  // Batch queries give the same results as individual ones
+  TEST (batch)
+  {
+    auto pts = random_points (20000);
+    KdTree<double> t (pts, 0);
+    auto queries = random_points (10000, 4);
+    std::vector<size_t> nn (queries.size ()), start, ids, found;
+
+    t.nearest (queries, nn, 4);
+    for (size_t i = 0; i < queries.size (); i++)
+      CHECK_EQUAL (t.nearest (queries[i]), nn[i]);
+
+    size_t total = t.radius (queries, 2., start, ids, 4);
+    CHECK_EQUAL (queries.size () + 1, start.size ());
+    CHECK_EQUAL (total, ids.size ());
+    CHECK_EQUAL (total, start.back ());
+    for (size_t i = 0; i < queries.size (); i++)
+    {
+      t.radius (queries[i], 2., found);
+      CHECK (std::equal (found.begin (), found.end (), ids.begin () + start[i],
+                         ids.begin () + start[i + 1]));
+    }
+  }
+
+  // Parallel build gives the same tree
+  TEST (parallel_build)
+  {
+    auto pts = random_points (100000, 5);
+    KdTree<double> t1 (pts, 1), t4 (pts, 4);
+    auto queries = random_points (1000, 6);
+    for (auto& q : queries)
+      CHECK_EQUAL (t1.nearest (q), t4.nearest (q));
+  }
+
+  TEST (other_types)
+  {
+    std::vector<Point<int>> ipts{{0, 0}, {3, 4}, {-1, 2}, {10, 10}};
+    KdTree<int> ti (ipts);
+    CHECK_EQUAL (2, ti.nearest (Point<int> (-2, 2)));
+    std::vector<size_t> ids;
+    CHECK_EQUAL (3, ti.radius (Point<int> (0, 0), 5, ids));
+
+    std::vector<Point<float>> fpts{{0.f, 0.f}, {3.f, 4.f}, {-1.f, 2.f}};
+    KdTree<float> tf (fpts);
+    CHECK_EQUAL (1, tf.nearest (Point<float> (2.5f, 4.f)));
+  }
+
+  TEST (speed)
+  {
+    const size_t N = 1000000, Q = 100000;
+    auto pts = random_points (N, 7);
+    auto queries = random_points (Q, 8);
+    dpoint_array pa (pts);
+    UnitTest::Timer t;
+
+    t.Start ();
+    KdTree<double> t1 (pts, 1);
+    auto dt_build1 = t.GetTimeInMs ();
+    t.Start ();
+    KdTree<double> tree (pts, 0);
+    auto dt_build = t.GetTimeInMs ();
+
+    // brute force on a sample of queries
+    const size_t S = 100;
+    t.Start ();
+    for (size_t i = 0; i < S; i++)
+      pa.nearest (queries[i]);
+    auto dt_brute = t.GetTimeInUs ();
+
+    t.Start ();
+    for (auto& q : queries)
+      tree.nearest (q);
+    auto dt_one = t.GetTimeInUs ();
+
+    std::vector<size_t> nn (Q), start, ids;
+    t.Start ();
+    tree.nearest (queries, nn);
+    auto dt_batch = t.GetTimeInUs ();
+
+    t.Start ();
+    tree.radius (queries, 0.5, start, ids);
+    auto dt_radius = t.GetTimeInUs ();
+
+    cout << "KdTree - " << N << " points, build " << dt_build1 << "ms (1 thread) / " << dt_build
+         << "ms (all threads)" << endl
+         << " nearest (queries/sec): brute force " << (dt_brute ? S * 1000000LL / dt_brute : 0)
+         << ", tree " << (dt_one ? Q * 1000000LL / dt_one : 0) << ", batch "
+         << (dt_batch ? Q * 1000000LL / dt_batch : 0) << endl
+         << " radius batch " << (dt_radius ? Q * 1000000LL / dt_radius : 0) << " queries/sec, "
+         << ids.size () << " points found" << endl;
+  }
+}
@@ -0,0 +1,1093 @@
+#include <utpp/utpp.h>
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+using namespace mlib;
+using namespace std;
+
+SUITE (nmea)
+{
+  const char* gga_sentence =
+    "$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*69\r\n";
+
+  TEST (checksum)
+  {
+    CHECK (nmea::checksum (gga_sentence));
+    CHECK (!nmea::checksum ("$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*68"));
+    CHECK (nmea::checksum ("$GPHDT,274.07,T\r\n")); // no checksum
+    CHECK (!nmea::checksum ("GPHDT,274.07,T*03"));  // no start character
+  }
+
+  TEST (checksum_batch)
+  {
+    std::string buf = std::string (gga_sentence)   // valid
+                      + "$GPHDT,274.07,T*04\r\n"    // bad checksum
+                      + "$GPHDT,274.07,T\r\n"       // no checksum
+                      + "\r\n"                      // empty line
+                      + "GPHDT,274.07,T*03\n"       // no start character
+                      + "!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0*24\n"
+                      + "$GPHDT,108.0,T*3c\r\n"     // lower case hex digits
+                      + "$GPHDT,274.07,T*03xx\r\n"  // garbage after checksum
+                      + "$GPHDT,274.07,T*0"         // truncated
+                      + "\n$GPHDT,274.07,T*03";     // not terminated
+    std::vector<nmea::checksum_result> res;
+    CHECK_EQUAL (5, nmea::checksum (buf.data (), buf.size (), res));
+    ABORT_EX (res.size () == 9, "Wrong number of results");
+    bool expected[] = {true, false, true, false, true, true, false, false, true};
+    for (size_t i = 0; i < res.size (); i++)
+    {
+      CHECK_EQUAL (expected[i], res[i].valid);
+      char c = buf[res[i].offset + res[i].length];
+      CHECK (c == '\r' || c == '\n' || res[i].offset + res[i].length == buf.size ());
+    }
+    CHECK_EQUAL (0, res[0].offset);
+    CHECK_EQUAL (strlen (gga_sentence) - 2, res[0].length);
+    CHECK (!res[2].present);
+    CHECK (res[8].present);
+  }
+
+  // Batch results must match sentence by sentence validation
+  TEST (checksum_batch_random)
+  {
+    srand (1);
+    std::string buf;
+    std::vector<bool> expected;
+    char line[256];
+    for (int i = 0; i < 1000; i++)
+    {
+      int len = rand () % 100;
+      line[0] = '$';
+      for (int j = 1; j <= len; j++)
+        line[j] = ' ' + rand () % 90;
+      for (int j = 1; j <= len; j++)
+        if (line[j] == '*' || line[j] == '$' || line[j] == '!')
+          line[j] = 'a';
+      line[len + 1] = 0;
+      unsigned char cks = 0;
+      for (int j = 1; j <= len; j++)
+        cks ^= line[j];
+      int k = rand () % 3;
+      if (k == 0)
+        sprintf (line + len + 1, "*%02X\r\n", cks); // good checksum
+      else if (k == 1)
+        sprintf (line + len + 1, "*%02X\r\n", (unsigned char)(cks ^ 1)); // bad checksum
+      else
+        strcpy (line + len + 1, "\r\n"); // no checksum
+      expected.push_back (nmea::checksum (line));
+      buf += line;
+    }
+    std::vector<nmea::checksum_result> res;
+    size_t nvalid = nmea::checksum (buf.data (), buf.size (), res);
+    ABORT_EX (res.size () == expected.size (), "Wrong number of results");
+    size_t n = 0;
+    for (size_t i = 0; i < res.size (); i++)
+    {
+      CHECK_EQUAL ((bool)expected[i], res[i].valid);
+      n += expected[i];
+    }
+    CHECK_EQUAL (n, nvalid);
+  }
+
+  TEST (checksum_speed)
+  {
+    const int N = 100000;
+    std::string buf;
+    for (int i = 0; i < N; i++)
+      buf += gga_sentence;
+
+    UnitTest::Timer t;
+    t.Start ();
+    size_t n1 = 0;
+    for (const char* p = buf.c_str (); *p; p = strchr (p, '\n') + 1)
+      n1 += nmea::checksum (p);
+    auto dt_one = t.GetTimeInUs ();
+
+    std::vector<nmea::checksum_result> res;
+    t.Start ();
+    size_t n2 = nmea::checksum (buf.data (), buf.size (), res);
+    auto dt_batch = t.GetTimeInUs ();
+
+    CHECK_EQUAL (N, n1);
+    CHECK_EQUAL (N, n2);
+    cout << "NMEA checksum validation (sentences/sec):" << endl
+         << " nmea::checksum - " << (dt_one ? N * 1000000LL / dt_one : 0) << endl
+         << " batch          - " << (dt_batch ? N * 1000000LL / dt_batch : 0) << endl;
+  }
+
+  TEST (gga)
+  {
+    double lat, lon, time, height, undul, dop, age;
+    int sat, mode, station;
+    CHECK_EQUAL (3, nmea::gga (gga_sentence, &lat, &lon, &time, &height, &undul, &dop, &sat, &mode,
+                               &age, &station));
+    CHECK_CLOSE (4807.038_dm, lat, 1e-12);
+    CHECK_CLOSE (01131.000_dm, lon, 1e-12);
+    CHECK_EQUAL (123519., time);
+    CHECK_CLOSE (545.4 + 46.9, height, 1e-9);
+    CHECK_EQUAL (46.9, undul);
+    CHECK_EQUAL (0.9, dop);
+    CHECK_EQUAL (8, sat);
+    CHECK_EQUAL (1, mode);
+
+    CHECK_EQUAL (3, nmea::gga ("$GPGGA,123519.00,4807.038,S,01131.000,W,4,12,0.9,545.4,M,46.9,M,"
+                               "1.5,0031*40\r\n",
+                               &lat, &lon, &time, &height, &undul, &dop, &sat, &mode, &age,
+                               &station));
+    CHECK_CLOSE (-4807.038_dm, lat, 1e-12);
+    CHECK_CLOSE (-01131.000_dm, lon, 1e-12);
+    CHECK_EQUAL (4, mode);
+    CHECK_EQUAL (1.5, age);
+    CHECK_EQUAL (31, station);
+
+    //null pointers are allowed
+    CHECK_EQUAL (3, nmea::gga (gga_sentence, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                               nullptr, nullptr, nullptr, nullptr));
+
+    //wrong sentence type
+    CHECK_EQUAL (0, nmea::gga ("$GPHDT,274.07,T*03\r\n", &lat, &lon, &time, &height, &undul, &dop,
+                               &sat, &mode, &age, &station));
+    //missing time
+    CHECK_EQUAL (0, nmea::gga ("$GPGGA,,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*69",
+                               &lat, &lon, &time, &height, &undul, &dop, &sat, &mode, &age,
+                               &station));
+  }
+
+  TEST (rmc)
+  {
+    double lat, lon, time, speed, head;
+    int date, mode;
+    CHECK_EQUAL (3, nmea::rmc ("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W,"
+                               "A*07\r\n",
+                               &lat, &lon, &time, &speed, &head, &date, &mode));
+    CHECK_CLOSE (4807.038_dm, lat, 1e-12);
+    CHECK_CLOSE (01131.000_dm, lon, 1e-12);
+    CHECK_EQUAL (123519., time);
+    CHECK_EQUAL (22.4, speed);
+    CHECK_CLOSE (84.4_deg, head, 1e-12);
+    CHECK_EQUAL (230394, date);
+    CHECK_EQUAL (1, mode);
+  }
+
+  TEST (vtg)
+  {
+    double speed, head;
+    CHECK_EQUAL (3, nmea::vtg ("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n", &speed, &head));
+    CHECK_CLOSE (54.7_deg, head, 1e-12);
+    CHECK_EQUAL (5.5, speed);
+  }
+
+  TEST (hdt_hdg)
+  {
+    double head, dev, var;
+    CHECK_EQUAL (2, nmea::hdt ("$GPHDT,274.07,T*03\r\n", &head));
+    CHECK_CLOSE (274.07_deg, head, 1e-12);
+
+    CHECK_EQUAL (3, nmea::hdg ("$HEHDG,98.3,0.0,E,12.6,W*51\r\n", &head, &dev, &var));
+    CHECK_CLOSE (98.3_deg, head, 1e-12);
+    CHECK_EQUAL (0., dev);
+    CHECK_CLOSE (-12.6_deg, var, 1e-12);
+  }
+
+  TEST (gst)
+  {
+    double time, rms, smaj, smin, orient, stdlat, stdlon, stdh;
+    CHECK_EQUAL (3, nmea::gst ("$GPGST,024603.00,3.2,1.4,0.8,35.2,1.1,0.9,2.1*66\r\n", &time, &rms,
+                               &smaj, &smin, &orient, &stdlat, &stdlon, &stdh));
+    CHECK_EQUAL (24603., time);
+    CHECK_EQUAL (3.2, rms);
+    CHECK_EQUAL (1.4, smaj);
+    CHECK_EQUAL (0.8, smin);
+    CHECK_EQUAL (35.2, orient);
+    CHECK_EQUAL (1.1, stdlat);
+    CHECK_EQUAL (0.9, stdlon);
+    CHECK_EQUAL (2.1, stdh);
+  }
+
+  TEST (zda)
+  {
+    double time;
+    unsigned short day, month, year;
+    CHECK_EQUAL (3, nmea::zda ("$GPZDA,201530.00,04,07,2002,00,00*60\r\n", &time, &day, &month,
+                               &year));
+    CHECK_EQUAL (201530., time);
+    CHECK_EQUAL (4, day);
+    CHECK_EQUAL (7, month);
+    CHECK_EQUAL (2002, year);
+
+    CHECK_EQUAL (0, nmea::zda ("$GPZDA,201530.00,,07,2002,00,00*60\r\n", &time, &day, &month,
+                               &year));
+  }
+
+  TEST (gsa)
+  {
+    int hmode, fmode, sv[12];
+    double pdop, hdop, vdop;
+    CHECK_EQUAL (3, nmea::gsa ("$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n", &hmode,
+                               &fmode, sv, &pdop, &hdop, &vdop));
+    CHECK_EQUAL (1, hmode);
+    CHECK_EQUAL (3, fmode);
+    int expected[12] = {4, 5, 0, 9, 12, 0, 0, 24, 0, 0, 0, 0};
+    CHECK_ARRAY_EQUAL (expected, sv, 12);
+    CHECK_EQUAL (2.5, pdop);
+    CHECK_EQUAL (1.3, hdop);
+    CHECK_EQUAL (2.1, vdop);
+  }
+
+  TEST (gsv)
+  {
+    int tmsg, msg, count, sv[36], az[36], elev[36], snr[36];
+    CHECK_EQUAL (1, nmea::gsv ("$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,"
+                               "00*74\r\n",
+                               &tmsg, &msg, &count, sv, az, elev, snr));
+    CHECK_EQUAL (3, tmsg);
+    CHECK_EQUAL (1, msg);
+    CHECK_EQUAL (11, count);
+    CHECK_EQUAL (13, sv[3]);
+    CHECK_EQUAL (6, elev[3]);
+    CHECK_EQUAL (292, az[3]);
+  }
+
+  TEST (gll)
+  {
+    double lat, lon, time;
+    int mode;
+    CHECK_EQUAL (3, nmea::gll ("$GPGLL,4916.45,N,12311.12,W,225444,A,D*59\r\n", &lat, &lon, &time,
+                               &mode));
+    CHECK_CLOSE (4916.45_dm, lat, 1e-12);
+    CHECK_CLOSE (-12311.12_dm, lon, 1e-12);
+    CHECK_EQUAL (225444., time);
+    CHECK_EQUAL (2, mode);
+
+    //NMEA 1.x sentence without time
+    CHECK_EQUAL (1, nmea::gll ("$GPGLL,4916.45,N,12311.12,W", &lat, &lon, &time, &mode));
+  }
+
+  TEST (depth)
+  {
+    double depth, offset, range;
+    CHECK_EQUAL (2, nmea::dbt ("$SDDBT,36.1,f,11.0,M,6.0,F*04\r\n", &depth));
+    CHECK_EQUAL (11., depth);
+    CHECK_EQUAL (3, nmea::dbs ("$SDDBS,36.1,f,,M,6.0,F\r\n", &depth));
+    CHECK_CLOSE (36.1 * 0.3048, depth, 1e-12);
+    CHECK_EQUAL (0, nmea::dbt ("$SDDBT,36.1,x,11.0,M,6.0,F\r\n", &depth));
+
+    CHECK_EQUAL (3, nmea::dpt ("$SDDPT,11.0,0.5,100*7F\r\n", &depth, &offset, &range));
+    CHECK_EQUAL (11., depth);
+    CHECK_EQUAL (0.5, offset);
+    CHECK_EQUAL (100., range);
+    CHECK_EQUAL (2, nmea::dpt ("$SDDPT,11.0,0.5*7F\r\n", &depth, &offset, &range));
+  }
+
+  TEST (pashr)
+  {
+    double time, hdg, pitch, roll, heave, roll_std, pitch_std, hdg_std;
+    int flag_h, flag_i;
+    CHECK_EQUAL (3, nmea::pashr ("$PASHR,145719.272,252.41,T,1.22,0.48,0.01,0.090,0.090,0.116,2,"
+                                 "1*11\r\n",
+                                 &time, &hdg, &pitch, &roll, &heave, &roll_std, &pitch_std,
+                                 &hdg_std, &flag_h, &flag_i));
+    CHECK_EQUAL (145719.272, time);
+    CHECK_CLOSE (252.41_deg, hdg, 1e-12);
+    CHECK_CLOSE (1.22_deg, roll, 1e-12);
+    CHECK_CLOSE (0.48_deg, pitch, 1e-12);
+    CHECK_EQUAL (0.01, heave);
+    CHECK_CLOSE (0.116_deg, hdg_std, 1e-12);
+    CHECK_EQUAL (2, flag_h);
+    CHECK_EQUAL (1, flag_i);
+  }
+
+  TEST (ttm)
+  {
+    double utc, dist, brg, speed, cog, cpa, tcpa;
+    int num, relbrg, relcog, stat;
+    char name[32];
+    CHECK_EQUAL (1, nmea::ttm ("$RATTM,11,25.3,13.7,T,7.0,20.0,T,10.1,20.2,N,TGT11,T,,123519.00,"
+                               "A*79\r\n",
+                               &utc, &num, name, &dist, &brg, &relbrg, &speed, &cog, &relcog, &cpa,
+                               &tcpa, &stat));
+    CHECK_EQUAL (11, num);
+    CHECK_EQUAL (25.3 * 1852, dist);
+    CHECK_EQUAL (13.7, brg);
+    CHECK_EQUAL (0, relbrg);
+    CHECK_EQUAL (7.0 / MPS2KNOT, speed);
+    CHECK_EQUAL ("TGT11", name);
+    CHECK_EQUAL (0, stat);
+    CHECK_EQUAL (123519., utc);
+  }
+
+  TEST (ptnlggk)
+  {
+    double lat, lon, time, height, dop;
+    int sat, mode;
+    CHECK_EQUAL (1, nmea::ptnlggk ("$PTNL,GGK,172814.00,071296,3723.46587704,N,12202.26957864,W,3,"
+                                   "06,1.7,EHT-6.777,M*4B\r\n",
+                                   &lat, &lon, &time, &height, &dop, &sat, &mode));
+    CHECK_CLOSE (3723.46587704_dm, lat, 1e-12);
+    CHECK_CLOSE (-12202.26957864_dm, lon, 1e-12);
+    CHECK_EQUAL (-6.777, height);
+    CHECK_EQUAL (6, sat);
+    CHECK_EQUAL (3, mode);
+  }
+
+  TEST (parse_gga)
+  {
+    auto s = nmea::parse (gga_sentence);
+    auto r = std::get_if<nmea::GGA> (&s);
+    ABORT_EX (r, "Sentence type %d instead of GGA", (int)s.index ());
+    CHECK_CLOSE (4807.038_dm, r->lat, 1e-12);
+    CHECK_CLOSE (01131.000_dm, r->lon, 1e-12);
+    CHECK_EQUAL (123519., r->time);
+    CHECK_EQUAL (8, r->sat);
+    CHECK_EQUAL (1, r->mode);
+  }
+
+  TEST (parse_types)
+  {
+    CHECK (holds_alternative<nmea::HDT> (nmea::parse ("$GPHDT,274.07,T*03\r\n")));
+    CHECK (holds_alternative<nmea::HDM> (nmea::parse ("$HCHDM,238.5,M*29\r\n")));
+    CHECK (holds_alternative<nmea::RMC> (nmea::parse (
+      "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W,A*07\r\n")));
+    CHECK (holds_alternative<nmea::ZDA> (nmea::parse ("$GPZDA,201530.00,04,07,2002,00,00*60\r\n")));
+    CHECK (holds_alternative<nmea::PTNLGGK> (
+      nmea::parse ("$PTNL,GGK,172814.00,071296,3723.46587704,N,12202.26957864,W,3,"
+                   "06,1.7,EHT-6.777,M*4B\r\n")));
+    CHECK (holds_alternative<nmea::PSATHPR> (nmea::parse ("$PSAT,HPR,123519.00,274.07,1.2,-0.8,N")));
+  }
+
+  TEST (parse_invalid)
+  {
+    CHECK (holds_alternative<monostate> (nmea::parse ("")));
+    CHECK (holds_alternative<monostate> (nmea::parse ("$GP")));
+    CHECK (holds_alternative<monostate> (nmea::parse ("$GPXYZ,1,2,3*00")));
+    CHECK (holds_alternative<monostate> (nmea::parse ("$PABCD,1,2")));
+    CHECK (holds_alternative<monostate> (nmea::parse ("$GPGGA")));
+  }
+
+  TEST (parse_gsv)
+  {
+    auto s = nmea::parse (
+      "$GPGSV,3,2,11,14,25,170,00,16,57,208,39,18,67,296,40,19,40,246,00*74\r\n");
+    auto r = std::get_if<nmea::GSV> (&s);
+    ABORT_EX (r, "Sentence type %d instead of GSV", (int)s.index ());
+    CHECK_EQUAL (3, r->tmsg);
+    CHECK_EQUAL (2, r->msg);
+    CHECK_EQUAL (11, r->count);
+    int sv[] = {14, 16, 18, 19};
+    CHECK_ARRAY_EQUAL (sv, r->sv, 4);
+    CHECK_EQUAL (296, r->az[2]);
+  }
+
+  TEST (parse_ttm_long_name)
+  {
+    auto s = nmea::parse ("$RATTM,11,25.3,13.7,T,7.0,20.0,T,10.1,20.2,N,"
+                          "A_VERY_LONG_TARGET_NAME_THAT_DOES_NOT_FIT,T,,123519.00,A");
+    auto r = std::get_if<nmea::TTM> (&s);
+    ABORT_EX (r, "Sentence type %d instead of TTM", (int)s.index ());
+    CHECK_EQUAL (sizeof (r->name) - 1, strlen (r->name));
+    CHECK_EQUAL (123519., r->utc);
+  }
+
+  TEST (framer_chunks)
+  {
+    string stream = string ("garbage") + gga_sentence + "$GPHDT,274.07,T*03\r\n"
+                    + "$GPHDT,274.07,T*04\r\n" // bad checksum
+                    + "$GPGGA,12351$GPHDT,274.07,T\n"; // incomplete sentence
+    // feed the stream in every possible chunk size
+    for (size_t sz = 1; sz <= stream.size (); sz++)
+    {
+      nmea::framer fr;
+      vector<string> out;
+      for (size_t i = 0; i < stream.size (); i += sz)
+      {
+        fr.push (stream.data () + i, min (sz, stream.size () - i));
+        string_view s;
+        while (fr.next (s))
+        {
+          out.emplace_back (s);
+          CHECK (s.data ()[s.size ()] == '\r' || s.data ()[s.size ()] == '\n');
+        }
+      }
+      CHECK_EQUAL (3, out.size ());
+      CHECK_EQUAL (string (gga_sentence, strlen (gga_sentence) - 2), out[0]);
+      CHECK_EQUAL ("$GPHDT,274.07,T*03", out[1]);
+      CHECK_EQUAL ("$GPHDT,274.07,T", out[2]);
+      auto& st = fr.statistics ();
+      CHECK_EQUAL (3, st.sentences);
+      CHECK_EQUAL (1, st.bad_checksum);
+      CHECK_EQUAL (0, st.overlong);
+      CHECK_EQUAL (7 + 12, st.dropped);
+    }
+  }
+
+  TEST (framer_zero_copy)
+  {
+    nmea::framer fr;
+    fr.push (gga_sentence, strlen (gga_sentence));
+    string_view s;
+    CHECK (fr.next (s));
+    CHECK (s.data () == gga_sentence);
+    CHECK (!fr.next (s));
+
+    double head = 0;
+    const char* hdt = "$GPHDT,274.07,T\n";
+    fr.push (hdt, strlen (hdt));
+    CHECK (fr.next (s));
+    CHECK_EQUAL (2, nmea::hdt (s.data (), &head));
+    CHECK_CLOSE (274.07_deg, head, 1e-12);
+  }
+
+  // Short sentences ending exactly at the end of a chunk, without a null terminator
+  TEST (framer_parse_short)
+  {
+    auto parse_chunk = [] (const char* line) {
+      size_t len = strlen (line);
+      auto chunk = std::make_unique<char[]> (len);
+      memcpy (chunk.get (), line, len);
+      nmea::framer fr;
+      fr.push (chunk.get (), len);
+      string_view s;
+      return fr.next (s) ? nmea::parse (s.data ()) : nmea::sentence{};
+    };
+    const char* lines[] = {"$\r", "$GP\r", "$GPHD\n", "$GP,HDT\r", "$PASH\r", "$PTNL,\r"};
+    for (auto line : lines)
+      CHECK (holds_alternative<monostate> (parse_chunk (line)));
+    CHECK (holds_alternative<nmea::HDT> (parse_chunk ("$GPHDT,274.07,T\r")));
+  }
+
+  TEST (framer_overlong)
+  {
+    nmea::framer fr (20, true);
+    string stream = "$GPHDT,274.07,T*03\r\n$GPHDT,274.07,T,,,,,,,*03\r\n$GPHDT,274.07,T\r\n"
+                    "$GPHDT,274.07,T*03\r\n";
+    fr.push (stream.data (), stream.size ());
+    string_view s;
+    int n = 0;
+    while (fr.next (s))
+      n++;
+    CHECK_EQUAL (2, n);
+    CHECK_EQUAL (1, fr.statistics ().overlong);
+    CHECK_EQUAL (1, fr.statistics ().bad_checksum); // no checksum
+  }
+
+  TEST (field_decoders)
+  {
+    int64_t val;
+    int dec;
+    CHECK (nmea::fixed ("-12.345", val, dec));
+    CHECK_EQUAL (-12345, val);
+    CHECK_EQUAL (3, dec);
+    CHECK (!nmea::fixed ("", val, dec));
+
+    CHECK_EQUAL (0., nmea::decimal (""));
+    CHECK_EQUAL (545.4, nmea::decimal ("545.4"));
+    CHECK_EQUAL (-6.777, nmea::decimal ("-6.777,M"));
+    CHECK_EQUAL (1.5e3, nmea::decimal ("1.5e3"));
+    CHECK_EQUAL (1234567890.12345678, nmea::decimal ("1234567890.12345678"));
+
+    CHECK_CLOSE (4807.038_dm, nmea::latlon ("4807.038"), 1e-15);
+    CHECK_CLOSE (-4807.038_dm, nmea::latlon ("-4807.038"), 1e-15);
+    CHECK_CLOSE (01131.000_dm, nmea::latlon ("01131.000"), 1e-15);
+
+    CHECK_EQUAL (12 * 3600 + 35 * 60 + 19.5, nmea::hms ("123519.50"));
+    CHECK_EQUAL (0., nmea::hms ("000000"));
+    CHECK_EQUAL (23 * 3600 + 59 * 60 + 59.999, nmea::hms ("235959.999"));
+  }
+
+  // Fixed-point decoders must return the same results as atof
+  TEST (field_decoders_exact)
+  {
+    char buf[64];
+    uint64_t seed = 12345;
+    auto rnd = [&seed] () {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      return seed >> 11;
+    };
+    int decimal_diffs = 0;
+    double max_latlon = 0;
+    for (int i = 0; i < 100000; i++)
+    {
+      int decimals = rnd () % 10;
+      double v = (double)(rnd () % 100000000000ULL) / 1e4;
+      if (rnd () & 1)
+        v = -v;
+      snprintf (buf, sizeof (buf), "%.*f", decimals, v);
+      if (nmea::decimal (buf) != atof (buf))
+        decimal_diffs++;
+
+      // DDMM.mmmmmmm coordinates
+      snprintf (buf, sizeof (buf), "%02d%02d.%07d", (int)(rnd () % 90), (int)(rnd () % 60),
+                (int)(rnd () % 10000000));
+      max_latlon = max (max_latlon, fabs (nmea::latlon (buf) - DM2rad (atof (buf))));
+    }
+    CHECK_EQUAL (0, decimal_diffs);
+    CHECK (max_latlon < 1e-15);
+  }
+
+  TEST (field_decoders_speed)
+  {
+    const int N = 1000000;
+    const char* fld[] = {"4807.038", "545.4", "0.9", "123519.00", "3723.46587704", "274.07"};
+    double sum = 0;
+    UnitTest::Timer t;
+
+    t.Start ();
+    for (int i = 0; i < N; i++)
+      sum += atof (fld[i % 6]);
+    auto dt_atof = t.GetTimeInUs ();
+
+    t.Start ();
+    for (int i = 0; i < N; i++)
+      sum += nmea::decimal (fld[i % 6]);
+    auto dt_decimal = t.GetTimeInUs ();
+
+    t.Start ();
+    for (int i = 0; i < N; i++)
+      sum += DM2rad (atof (fld[i % 6]));
+    auto dt_dm2rad = t.GetTimeInUs ();
+
+    t.Start ();
+    for (int i = 0; i < N; i++)
+      sum += nmea::latlon (fld[i % 6]);
+    auto dt_latlon = t.GetTimeInUs ();
+
+    cout << "NMEA field decoding speed (fields/sec):" << endl
+         << " atof                  - " << (dt_atof ? N * 1000000LL / dt_atof : 0) << endl
+         << " nmea::decimal         - " << (dt_decimal ? N * 1000000LL / dt_decimal : 0) << endl
+         << " DM2rad (atof)         - " << (dt_dm2rad ? N * 1000000LL / dt_dm2rad : 0) << endl
+         << " nmea::latlon          - " << (dt_latlon ? N * 1000000LL / dt_latlon : 0) << endl;
+    CHECK (sum != 0);
+  }
+
+  // Write a synthetic NMEA log file
+  static size_t make_log (const char* fname, int n, bool terminated)
+  {
+    FILE* f = fopen (fname, "wb");
+    size_t count = 0;
+    char body[128];
+    for (int i = 0; i < n; i++)
+    {
+      snprintf (body, sizeof (body),
+                "GPGGA,%02d%02d%05.2f,4807.%03d,N,01131.%03d,E,%d,08,0.9,%d.4,M,46.9,M,,",
+                (i / 360000) % 24, (i / 6000) % 60, (i % 6000) / 100., i % 1000, (i * 7) % 1000,
+                i % 5, i % 1000);
+      unsigned char cks = 0;
+      for (char* p = body; *p; p++)
+        cks ^= *p;
+      fprintf (f, "$%s*%02X\r\n", body, cks);
+      if (i % 10 == 0)
+        fprintf (f, "$GPHDT,%d.5,T\r\n", i % 360);
+      if (i % 100 == 0)
+        fprintf (f, "garbage$GPGST,1,2,3*00\r\n"); // bad checksum
+      count += 1 + (i % 10 == 0);
+    }
+    if (!terminated)
+      fprintf (f, "$GPHDT,1.5,T");
+    fclose (f);
+    return count + !terminated;
+  }
+
+  TEST (decode_log)
+  {
+    const int N = 20000;
+    size_t n = make_log ("nmea_test.log", N, false);
+
+    nmea::log_table t1, t4;
+    nmea::log_stats st1, st4;
+    CHECK_EQUAL (0, nmea::decode_log ("nmea_test.log", t1, &st1, 1));
+    CHECK_EQUAL (0, nmea::decode_log ("nmea_test.log", t4, &st4, 4));
+
+    CHECK_EQUAL (n, st1.sentences);
+    CHECK_EQUAL (n, st1.decoded);
+    CHECK_EQUAL (N / 100, st1.bad_checksum);
+    CHECK_EQUAL (7 * N / 100, st1.dropped);
+    CHECK_EQUAL (N, t1.gga.time.size ());
+    CHECK_EQUAL (N / 10 + 1, t1.hdt.head.size ());
+    CHECK_CLOSE (1.5_deg, t1.hdt.head.back (), 1e-12);
+
+    CHECK_EQUAL (st1.sentences, st4.sentences);
+    CHECK (t1.gga.lat == t4.gga.lat);
+    CHECK (t1.gga.time == t4.gga.time);
+    CHECK (t1.gga.quality == t4.gga.quality);
+    CHECK (t1.hdt.head == t4.hdt.head);
+    CHECK (t1.hdt.time == t4.hdt.time);
+
+    // HDT time is that of preceding GGA
+    ABORT_EX (t1.hdt.time.size () == t1.hdt.head.size (), "HDT columns size mismatch");
+    int bad_time = 0;
+    for (size_t k = 0; k < N / 10; k++)
+      bad_time += (t1.hdt.time[k] != t1.gga.time[10 * k]);
+    CHECK_EQUAL (0, bad_time);
+    CHECK_EQUAL (t1.gga.time.back (), t1.hdt.time.back ());
+
+    double lat;
+    nmea::gga ("$GPGGA,000001.23,4807.123,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,", &lat, nullptr,
+               nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+    CHECK_EQUAL (lat, t1.gga.lat[123]);
+    CHECK_EQUAL (1.23, t1.gga.time[123]);
+    CHECK_EQUAL (3, t1.gga.quality[123]);
+
+    // round trip through a binary file
+    nmea::log_table t2;
+    CHECK_EQUAL (0, t1.write ("nmea_test.bin"));
+    CHECK_EQUAL (0, t2.read ("nmea_test.bin"));
+    CHECK (t1.gga.height == t2.gga.height);
+    CHECK (t1.gga.sat == t2.gga.sat);
+    CHECK (t1.hdt.head == t2.hdt.head);
+    CHECK (t1.hdt.time == t2.hdt.time);
+
+    // truncated file
+    size_t fsize = std::filesystem::file_size ("nmea_test.bin");
+    std::filesystem::resize_file ("nmea_test.bin", fsize / 2);
+    CHECK_EQUAL (EINVAL, t2.read ("nmea_test.bin"));
+    CHECK (t2.gga.time.empty ());
+
+    // column size larger than file
+    FILE* f = fopen ("nmea_test.bin", "wb");
+    uint64_t huge = 1ULL << 40;
+    fwrite ("NMEACOL2", 8, 1, f);
+    fwrite (&huge, sizeof (huge), 1, f);
+    fclose (f);
+    CHECK_EQUAL (EINVAL, t2.read ("nmea_test.bin"));
+
+    remove ("nmea_test.log");
+    remove ("nmea_test.bin");
+  }
+
+  TEST (decode_log_missing)
+  {
+    nmea::log_table t;
+    erc ret = nmea::decode_log ("no_such_file.log", t);
+    CHECK (ret != 0);
+    ret.deactivate ();
+  }
+
+  TEST (decode_log_speed)
+  {
+    const int N = 1000000;
+    make_log ("nmea_speed.log", N, true);
+    nmea::log_stats st1, st;
+    nmea::log_table tbl;
+    nmea::decode_log ("nmea_speed.log", tbl, &st1, 1);
+    tbl.clear ();
+    nmea::decode_log ("nmea_speed.log", tbl, &st);
+    cout << "NMEA log decoding (sentences/sec):" << endl
+         << " 1 thread - " << (long long)st1.rate () << endl
+         << " " << std::thread::hardware_concurrency () << " threads - " << (long long)st.rate ()
+         << endl;
+    remove ("nmea_speed.log");
+  }
+
+  TEST (encode_gga)
+  {
+    char buf[128];
+    nmea::GGA r{};
+    r.time = 123519.;
+    r.lat = 4807.038_dm;
+    r.lon = 1131.0_dm;
+    r.mode = 1;
+    r.sat = 8;
+    r.dop = 0.9;
+    r.height = 545.4 + 46.9;
+    r.undul = 46.9;
+    size_t len = nmea::encode (buf, sizeof (buf), r);
+    CHECK_EQUAL (strlen (buf), len);
+    CHECK_EQUAL ("$GPGGA,123519.00,4807.0380000,N,01131.0000000,E,1,08,0.9,545.400,M,46.900,M,,*69\r\n",
+                 buf);
+    CHECK (nmea::checksum (buf));
+
+    // too small buffer
+    CHECK_EQUAL (0, nmea::encode (buf, 20, r));
+    CHECK_EQUAL ("", buf);
+
+    // unknown quality and number of satellites leave fields empty
+    r.mode = -1;
+    r.sat = 100;
+    nmea::encode (buf, sizeof (buf), r);
+    CHECK (strstr (buf, ",E,,,0.9,"));
+
+    // rounding carries into minutes, hours and days
+    r.time = 123559.996;
+    nmea::encode (buf, sizeof (buf), r);
+    CHECK (!strncmp (buf, "$GPGGA,123600.00,", 17));
+    r.time = 235959.999;
+    nmea::encode (buf, sizeof (buf), r);
+    CHECK (!strncmp (buf, "$GPGGA,000000.00,", 17));
+    r.time = NAN;
+    nmea::encode (buf, sizeof (buf), r);
+    CHECK (!strncmp (buf, "$GPGGA,,", 8));
+  }
+
+  TEST (encode_hdt)
+  {
+    char buf[32];
+    CHECK_EQUAL (20, nmea::encode (buf, sizeof (buf), nmea::HDT{-85.93_deg}, "HE"));
+    CHECK_EQUAL ("$HEHDT,274.07,T*19\r\n", buf);
+    CHECK (nmea::checksum (buf));
+  }
+
+  // Encode random records and parse them back
+  TEST (encode_round_trip)
+  {
+    char buf[128];
+    uint64_t seed = 4321;
+    auto rnd = [&seed] (double lo, double hi) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      return lo + (hi - lo) * (double)(seed >> 11) / (double)(1ULL << 53);
+    };
+    for (int i = 0; i < 10000; i++)
+    {
+      nmea::GGA g{};
+      g.time = (int)rnd (0, 24) * 10000 + (int)rnd (0, 60) * 100 + round (rnd (0, 60) * 100) / 100;
+      g.lat = rnd (-90, 90) * D2R;
+      g.lon = rnd (-180, 180) * D2R;
+      g.mode = (int)rnd (0, 9);
+      g.sat = (int)rnd (0, 30);
+      g.dop = round (rnd (0, 10) * 10) / 10;
+      g.undul = round (rnd (-100, 100) * 1000) / 1000;
+      g.height = g.undul + round (rnd (-100, 5000) * 1000) / 1000;
+      g.age = (i % 2) ? round (rnd (1, 10) * 10) / 10 : 0;
+      g.station = (i % 2) ? (int)rnd (0, 1023) : 0;
+      ABORT_EX (nmea::encode (buf, sizeof (buf), g, "GN"), "GGA encoding failed");
+      CHECK (nmea::checksum (buf));
+      auto s = nmea::parse (buf);
+      auto p = get_if<nmea::GGA> (&s);
+      ABORT_EX (p, "GGA parsing failed for %s", buf);
+      CHECK_CLOSE (g.time, p->time, 1e-9);
+      CHECK_CLOSE (g.lat, p->lat, 2e-11); // 1e-7 minutes = 3e-11 rad
+      CHECK_CLOSE (g.lon, p->lon, 2e-11);
+      CHECK_EQUAL (g.mode, p->mode);
+      CHECK_EQUAL (g.sat, p->sat);
+      CHECK_CLOSE (g.dop, p->dop, 1e-9);
+      CHECK_CLOSE (g.height, p->height, 1e-9);
+      CHECK_CLOSE (g.undul, p->undul, 1e-9);
+      CHECK_CLOSE (g.age, p->age, 1e-9);
+      CHECK_EQUAL (g.station, p->station);
+
+      nmea::RMC r{};
+      r.time = g.time;
+      r.lat = g.lat;
+      r.lon = g.lon;
+      r.speed = round (rnd (0, 100) * 1000) / 1000;
+      r.head = rnd (0, 359.99) * D2R;
+      r.date = (int)rnd (1, 31) * 10000 + (int)rnd (1, 12) * 100 + (int)rnd (0, 99);
+      r.mode = (int)rnd (0, 6);
+      ABORT_EX (nmea::encode (buf, sizeof (buf), r), "RMC encoding failed");
+      CHECK (nmea::checksum (buf));
+      double lat, lon, time, speed, head;
+      int date, mode;
+      CHECK_EQUAL (3, nmea::rmc (buf, &lat, &lon, &time, &speed, &head, &date, &mode));
+      CHECK_CLOSE (r.lat, lat, 2e-11);
+      CHECK_CLOSE (r.lon, lon, 2e-11);
+      CHECK_CLOSE (r.speed, speed, 1e-9);
+      CHECK_CLOSE (r.head, head, 0.01_deg);
+      CHECK_EQUAL (r.date, date);
+      CHECK_EQUAL (r.mode, mode);
+
+      nmea::VTG v{r.speed, r.head};
+      ABORT_EX (nmea::encode (buf, sizeof (buf), v), "VTG encoding failed");
+      CHECK_EQUAL (3, nmea::vtg (buf, &speed, &head));
+      CHECK_CLOSE (v.speed, speed, 1e-9);
+      CHECK_CLOSE (v.head, head, 0.01_deg);
+
+      nmea::HDT h{r.head};
+      ABORT_EX (nmea::encode (buf, sizeof (buf), h), "HDT encoding failed");
+      CHECK_EQUAL (2, nmea::hdt (buf, &head));
+      CHECK_CLOSE (h.head, head, 0.01_deg);
+    }
+  }
+
+  TEST (encode_zda)
+  {
+    char buf[64];
+    nmea::encode (buf, sizeof (buf), nmea::ZDA{201530., 4, 7, 2002});
+    double time;
+    unsigned short day, month, year;
+    CHECK_EQUAL (3, nmea::zda (buf, &time, &day, &month, &year));
+    CHECK_EQUAL (201530., time);
+    CHECK_EQUAL (4, day);
+    CHECK_EQUAL (7, month);
+    CHECK_EQUAL (2002, year);
+  }
+
+  TEST (encode_speed)
+  {
+    const int N = 500000;
+    char buf[128];
+    nmea::GGA g{123519., 4807.038_dm, 1131.0_dm, 592.3, 46.9, 0.9, 0., 8, 1, 0};
+    size_t total = 0;
+    UnitTest::Timer t;
+    t.Start ();
+    for (int i = 0; i < N; i++)
+    {
+      g.time += 0.01;
+      total += nmea::encode (buf, sizeof (buf), g);
+    }
+    auto dt = t.GetTimeInUs ();
+    cout << "NMEA GGA encoding speed: " << (dt ? N * 1000000LL / dt : 0) << " sentences/sec"
+         << endl;
+    CHECK (total > 0);
+  }
+
+  // GGA sentence with only time and latitude set
+  nmea::GGA gga_at (double time, double lat = 0.)
+  {
+    nmea::GGA r{};
+    r.time = time;
+    r.lat = lat;
+    return r;
+  }
+
+  // GST sentence with only time set
+  nmea::GST gst_at (double time)
+  {
+    nmea::GST r{};
+    r.time = time;
+    return r;
+  }
+
+  TEST (epoch_grouping)
+  {
+    nmea::epoch_assembler ea (nmea::fix::gga | nmea::fix::gst | nmea::fix::hdt);
+    nmea::fix f;
+
+    auto gga = gga_at (120000., 0.8);
+    gga.lon = 0.2;
+    gga.height = 10.;
+    gga.sat = 8;
+    gga.mode = 1;
+    ea.add (gga);
+    ea.add (nmea::HDT{1.5});
+    CHECK (!ea.next (f)); // epoch not complete yet
+    auto gst = gst_at (120000.01);
+    gst.rms = 0.5;
+    gst.stdlat = 0.1;
+    gst.stdlon = 0.2;
+    gst.stdh = 0.3;
+    ea.add (gst);
+    ABORT_EX (ea.next (f), "Complete epoch not produced");
+    CHECK_EQUAL (nmea::fix::gga | nmea::fix::gst | nmea::fix::hdt, f.have);
+    CHECK_EQUAL (120000., f.time);
+    CHECK_EQUAL (0.8, f.lat);
+    CHECK_EQUAL (8, f.sat);
+    CHECK_EQUAL (1.5, f.heading);
+    CHECK_EQUAL (0.3, f.stdh);
+    CHECK (!ea.next (f));
+
+    // new epoch starts when time advances past tolerance
+    ea.add (gga_at (120001., 0.9));
+    ea.add (gga_at (120002., 1.0));
+    ABORT_EX (ea.next (f), "Incomplete epoch not produced");
+    CHECK_EQUAL (nmea::fix::gga, f.have);
+    CHECK_EQUAL (0.9, f.lat);
+    CHECK (!ea.next (f));
+
+    ea.flush ();
+    ABORT_EX (ea.next (f), "Flush did not produce epoch");
+    CHECK_EQUAL (1.0, f.lat);
+    CHECK_EQUAL (120002., f.time);
+
+    auto st = ea.statistics ();
+    CHECK_EQUAL (3, st.epochs);
+    CHECK_EQUAL (1, st.complete);
+    CHECK_EQUAL (0, st.late);
+  }
+
+  TEST (epoch_late)
+  {
+    nmea::epoch_assembler ea (nmea::fix::gga | nmea::fix::gst, 0.05);
+    nmea::fix f;
+
+    ea.add (gga_at (235959.5));
+    ea.add (gst_at (235959.5));
+    ea.add (gst_at (235959.52)); // same epoch, already produced
+    CHECK (ea.next (f));
+
+    ea.add (gga_at (0.5));      // midnight rollover
+    ea.add (gst_at (235959.9)); // older than current epoch
+    ea.add (nmea::ZDA{0.5, 5, 6, 2024});
+    ea.add (gst_at (0.51));
+    ABORT_EX (ea.next (f), "Epoch after midnight not produced");
+    CHECK_EQUAL (nmea::fix::gga | nmea::fix::gst | nmea::fix::zda, f.have);
+    CHECK_EQUAL (0.5, f.time);
+    CHECK_EQUAL (2024, f.year);
+
+    auto st = ea.statistics ();
+    CHECK_EQUAL (2, st.epochs);
+    CHECK_EQUAL (2, st.late);
+  }
+
+  // Sentences of a 20Hz receiver with default tolerance
+  TEST (epoch_20hz)
+  {
+    const int N = 200;
+    nmea::epoch_assembler ea (nmea::fix::gga | nmea::fix::gsa | nmea::fix::gst);
+    nmea::fix f;
+    int n = 0;
+    for (int i = 0; i < N; i++)
+    {
+      double t = 120000. + i * 0.05;
+      ea.add (gga_at (t, i));
+      nmea::GSA gsa{};
+      gsa.pdop = i;
+      ea.add (gsa);
+      auto gst = gst_at (t);
+      gst.rms = i;
+      ea.add (gst);
+      ea.add (nmea::HDT{1.}); // arrives after epoch was produced
+
+      ABORT_EX (ea.next (f), "Epoch not produced");
+      CHECK_EQUAL (nmea::fix::gga | nmea::fix::gsa | nmea::fix::gst, f.have);
+      CHECK_EQUAL (t, f.time);
+      CHECK_EQUAL (i, f.lat);
+      CHECK_EQUAL (i, f.pdop);
+      CHECK_EQUAL (i, f.rms);
+      n++;
+    }
+    CHECK (!ea.next (f));
+
+    auto st = ea.statistics ();
+    CHECK_EQUAL (N, st.epochs);
+    CHECK_EQUAL (N, st.complete);
+    CHECK_EQUAL (0, st.late);
+    CHECK_EQUAL (N, st.untimed);
+
+    // late sentence for the previous epoch
+    ea.add (gst_at (120000. + (N - 1) * 0.05));
+    CHECK_EQUAL (1, ea.statistics ().late);
+  }
+
+  TEST (epoch_sentences)
+  {
+    nmea::epoch_assembler ea (nmea::fix::gga | nmea::fix::hdt);
+    nmea::fix f;
+    ea.add ("$GPHDT,274.07,T*03\r\n");
+    ea.add (gga_sentence);
+    ABORT_EX (ea.next (f), "Epoch not produced");
+    CHECK_CLOSE (274.07_deg, f.heading, 1e-9);
+    CHECK_CLOSE (4807.038_dm, f.lat, 1e-9);
+    CHECK_EQUAL (123519., f.time);
+  }
+
+  TEST (epoch_overflow)
+  {
+    nmea::epoch_assembler ea (nmea::fix::gga, 0.05, 4);
+    for (int i = 0; i < 6; i++)
+      ea.add (gga_at (100000. + i));
+    nmea::fix f;
+    int n = 0;
+    while (ea.next (f))
+      n++;
+    CHECK_EQUAL (4, n);
+    CHECK_EQUAL (2, ea.statistics ().overflow);
+  }
+
+  // Producers and consumers running on different threads
+  TEST (epoch_threads)
+  {
+    const int N = 100000;
+    nmea::epoch_assembler ea (nmea::fix::gga | nmea::fix::gst, 0.05, 1024);
+    std::atomic<bool> done{false};
+    std::atomic<int> received{0};
+
+    auto consumer = [&] () {
+      nmea::fix f;
+      for (;;)
+      {
+        if (ea.next (f))
+          received++;
+        else if (done)
+        {
+          while (ea.next (f))
+            received++;
+          break;
+        }
+        else
+          std::this_thread::yield ();
+      }
+    };
+
+    // timestamps are multiples of 0.1s up to 10000s
+    auto hms = [] (int i) {
+      int ds = i % 10, s = i / 10;
+      return (s / 3600) * 10000. + (s / 60 % 60) * 100. + s % 60 + ds / 10.;
+    };
+
+    UnitTest::Timer t;
+    t.Start ();
+    std::thread c1 (consumer), c2 (consumer);
+    // each producer simulates one data stream; streams are kept roughly in sync
+    std::atomic<int> progress[2]{0, 0};
+    auto producer = [&] (int id) {
+      for (int i = 0; i < N; i++)
+      {
+        while (i > progress[1 - id])
+          std::this_thread::yield ();
+        if (id == 0)
+          ea.add (gga_at (hms (i)));
+        else
+          ea.add (gst_at (hms (i)));
+        progress[id] = i + 1;
+      }
+    };
+    std::thread p1 (producer, 0), p2 (producer, 1);
+    p1.join ();
+    p2.join ();
+    ea.flush ();
+    done = true;
+    c1.join ();
+    c2.join ();
+    auto dt = t.GetTimeInUs ();
+
+    auto st = ea.statistics ();
+    CHECK_EQUAL (st.epochs - st.overflow, (size_t)received);
+    CHECK_EQUAL (2 * N, 2 * st.epochs - (st.epochs - st.complete) + st.late);
+    cout << "Epoch assembler: " << st.epochs << " epochs (" << st.complete << " complete, "
+         << st.late << " late sentences) in " << dt / 1000 << "ms, average latency "
+         << st.latency * 1e6 << "us, max " << st.max_latency * 1e6 << "us" << endl;
+  }
+
+  //Parsing speed
+  TEST (parse_speed)
+  {
+    const int N = 200000;
+    const char* rmc_sentence =
+      "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W,A*07\r\n";
+    double lat, lon, time, height, undul, dop, age, speed, head;
+    int sat, mode, station, date;
+    UnitTest::Timer t;
+
+    t.Start ();
+    for (int i = 0; i < N; i++)
+      nmea::gga (gga_sentence, &lat, &lon, &time, &height, &undul, &dop, &sat, &mode, &age,
+                 &station);
+    auto dt_gga = t.GetTimeInUs ();
+
+    t.Start ();
+    for (int i = 0; i < N; i++)
+      nmea::rmc (rmc_sentence, &lat, &lon, &time, &speed, &head, &date, &mode);
+    auto dt_rmc = t.GetTimeInUs ();
+
+    t.Start ();
+    for (int i = 0; i < N; i++)
+      nmea::hdt ("$GPHDT,274.07,T*03\r\n", &head);
+    auto dt_hdt = t.GetTimeInUs ();
+
+    const char* mix[] = {gga_sentence, rmc_sentence, "$GPHDT,274.07,T*03\r\n"};
+    size_t valid = 0;
+    t.Start ();
+    for (int i = 0; i < N; i++)
+      valid += nmea::parse (mix[i % 3]).index () != 0;
+    auto dt_mix = t.GetTimeInUs ();
+    CHECK_EQUAL (N, valid);
+
+    cout << "NMEA parsing speed (sentences/sec):" << endl
+         << " GGA - " << (dt_gga ? N * 1000000LL / dt_gga : 0) << endl
+         << " RMC - " << (dt_rmc ? N * 1000000LL / dt_rmc : 0) << endl
+         << " HDT - " << (dt_hdt ? N * 1000000LL / dt_hdt : 0) << endl
+         << " mixed (nmea::parse) - " << (dt_mix ? N * 1000000LL / dt_mix : 0) << endl;
+  }
+}
@@ -0,0 +1,401 @@
+#include <utpp/utpp.h>
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <functional>
+
+using namespace mlib;
+using namespace std;
+
+/*
+  Synthetic NMEA-0183 corpus generator.
+
+  Produces a stream that looks like the output of a GNSS receiver with
+  attached heading sensor, echo sounder and radar. Each epoch contains GGA,
+  GNS, GLL, GSA, 3 GSV, GST, RMC, VTG, ZDA, HDT, PASHR sentences. Every 10th
+  epoch also has a DBT sentence and a TTM sentence.
+
+  Sentences can be corrupted (one character changed, resulting in a bad
+  checksum) or truncated (cut short without line terminator).
+*/
+class nmea_corpus
+{
+public:
+  enum kind
+  {
+    DBT,
+    GGA,
+    GLL,
+    GNS,
+    GSA,
+    GST,
+    GSV,
+    HDT,
+    PASHR,
+    RMC,
+    TTM,
+    VTG,
+    ZDA,
+    KIND_COUNT
+  };
+
+  nmea_corpus (unsigned int seed = 1)
+    : rng (seed)
+    , secs (12 * 3600.)
+    , lat (45.5)
+    , lon (-73.6)
+    , heading (30.)
+  {}
+
+  /// Probability that a sentence is corrupted
+  double corrupt = 0;
+
+  /// Probability that a sentence is truncated
+  double truncate = 0;
+
+  /// Generated sentences counters
+  size_t good = 0, corrupted = 0, truncated = 0;
+
+  /// Return a valid sentence of given kind terminated by CR/LF
+  std::string sentence (kind k);
+
+  /// Return a stream with the given number of epochs
+  std::string stream (size_t epochs);
+
+  /// Advance to next epoch
+  void tick ();
+
+private:
+  double uniform (double lo, double hi)
+  {
+    return std::uniform_real_distribution<double> (lo, hi) (rng);
+  }
+  int uniform (int lo, int hi)
+  {
+    return std::uniform_int_distribution<int> (lo, hi) (rng);
+  }
+  std::string finish (const char* body);
+  void add (std::string& str, kind k);
+
+  std::mt19937 rng;
+  double secs, lat, lon, heading;
+  int gsv_msg = 0;
+};
+
+// Format time and coordinates fields
+static int put_time (char* buf, double secs)
+{
+  int s = (int)secs;
+  return sprintf (buf, "%02d%02d%05.2f", s / 3600 % 24, s / 60 % 60, secs - s / 60 * 60);
+}
+
+static int put_coord (char* buf, double deg, int degw, char pos, char neg)
+{
+  char hemi = deg >= 0 ? pos : neg;
+  deg = fabs (deg);
+  int d = (int)deg;
+  return sprintf (buf, "%0*d%010.7f,%c", degw, d, (deg - d) * 60., hemi);
+}
+
+std::string nmea_corpus::finish (const char* body)
+{
+  unsigned char cks = 0;
+  for (const char* p = body + 1; *p; p++)
+    cks ^= *p;
+  char trailer[8];
+  sprintf (trailer, "*%02X\r\n", cks);
+  return std::string (body) + trailer;
+}
+
+std::string nmea_corpus::sentence (kind k)
+{
+  char body[256], tm[16], la[32], lo[32];
+  put_time (tm, secs);
+  put_coord (la, lat, 2, 'N', 'S');
+  put_coord (lo, lon, 3, 'E', 'W');
+
+  switch (k)
+  {
+  case DBT:
+  {
+    double d = uniform (5., 200.);
+    sprintf (body, "$SDDBT,%.1f,f,%.1f,M,%.1f,F", d / 0.3048, d, d / 1.8288);
+    break;
+  }
+  case GGA:
+    sprintf (body, "$GPGGA,%s,%s,%s,%d,%02d,%.1f,%.3f,M,%.3f,M,%.1f,%04d", tm, la, lo, 4,
+             uniform (6, 14), uniform (0.6, 1.5), uniform (20., 40.), -32.5, uniform (0.5, 2.),
+             uniform (0, 1023));
+    break;
+  case GLL:
+    sprintf (body, "$GPGLL,%s,%s,%s,A,D", la, lo, tm);
+    break;
+  case GNS:
+    sprintf (body, "$GNGNS,%s,%s,%s,AA,%02d,%.1f,%.3f,%.3f,%.1f,%04d", tm, la, lo, uniform (10, 24),
+             uniform (0.6, 1.5), uniform (20., 40.), -32.5, uniform (0.5, 2.), uniform (0, 1023));
+    break;
+  case GSA:
+  {
+    int n = sprintf (body, "$GPGSA,A,3");
+    for (int i = 0; i < 12; i++)
+    {
+      if (i < 9)
+        n += sprintf (body + n, ",%02d", uniform (1, 32));
+      else
+        n += sprintf (body + n, ",");
+    }
+    sprintf (body + n, ",%.1f,%.1f,%.1f", uniform (1., 2.5), uniform (0.6, 1.5), uniform (1., 2.));
+    break;
+  }
+  case GST:
+    sprintf (body, "$GPGST,%s,%.2f,%.3f,%.3f,%.1f,%.3f,%.3f,%.3f", tm, uniform (0.1, 2.),
+             uniform (0.01, 0.05), uniform (0.01, 0.05), uniform (0., 180.), uniform (0.01, 0.05),
+             uniform (0.01, 0.05), uniform (0.02, 0.1));
+    break;
+  case GSV:
+  {
+    int n = sprintf (body, "$GPGSV,3,%d,11", gsv_msg % 3 + 1);
+    int nsat = (gsv_msg % 3 == 2) ? 3 : 4;
+    for (int i = 0; i < nsat; i++)
+      n += sprintf (body + n, ",%02d,%02d,%03d,%02d", uniform (1, 32), uniform (5, 90),
+                    uniform (0, 359), uniform (20, 50));
+    gsv_msg++;
+    break;
+  }
+  case HDT:
+    sprintf (body, "$HEHDT,%.2f,T", heading);
+    break;
+  case PASHR:
+    sprintf (body, "$PASHR,%s,%.2f,T,%.2f,%.2f,%.2f,%.3f,%.3f,%.3f,%d,%d", tm, heading,
+             uniform (-5., 5.), uniform (-3., 3.), uniform (-0.5, 0.5), uniform (0.01, 0.1),
+             uniform (0.01, 0.1), uniform (0.01, 0.2), 2, 1);
+    break;
+  case RMC:
+    sprintf (body, "$GPRMC,%s,A,%s,%s,%.3f,%.2f,150724,,,D", tm, la, lo, uniform (5., 12.),
+             heading);
+    break;
+  case TTM:
+    sprintf (body, "$RATTM,%02d,%.2f,%.1f,T,%.1f,%.1f,T,%.2f,%.1f,N,TGT%02d,T,,%s,A",
+             uniform (1, 99), uniform (0.5, 12.), uniform (0., 359.9), uniform (0., 25.),
+             uniform (0., 359.9), uniform (0., 5.), uniform (-60., 60.), uniform (1, 99), tm);
+    break;
+  case VTG:
+    sprintf (body, "$GPVTG,%.2f,T,,M,%.3f,N,%.3f,K,D", heading, 8., 8. * 1.852);
+    break;
+  case ZDA:
+    sprintf (body, "$GPZDA,%s,15,07,2024,,", tm);
+    break;
+  default:
+    return std::string ();
+  }
+  return finish (body);
+}
+
+void nmea_corpus::tick ()
+{
+  secs += 0.1;
+  if (secs >= 86400.)
+    secs -= 86400.;
+  lat += uniform (-1e-6, 1e-6);
+  lon += uniform (-1e-6, 1e-6);
+  heading = fmod (heading + uniform (-0.5, 0.5) + 360., 360.);
+}
+
+// Append a sentence possibly corrupting or truncating it
+void nmea_corpus::add (std::string& str, kind k)
+{
+  std::string s = sentence (k);
+  double r = uniform (0., 1.);
+  size_t star = s.find ('*');
+  if (r < corrupt)
+  {
+    // change a character between start and checksum
+    size_t pos = uniform (1, (int)star - 1);
+    static const char repl[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789,.-";
+    char c;
+    do
+      c = repl[uniform (0, (int)sizeof (repl) - 2)];
+    while (c == s[pos]);
+    s[pos] = c;
+    corrupted++;
+  }
+  else if (r < corrupt + truncate)
+  {
+    s.resize (uniform (1, (int)star));
+    truncated++;
+  }
+  else
+    good++;
+  str += s;
+}
+
+std::string nmea_corpus::stream (size_t epochs)
+{
+  static const kind epoch[] = {GGA, GNS, GLL, GSA, GSV, GSV, GSV, GST, RMC, VTG, ZDA, HDT, PASHR};
+  std::string str;
+  for (size_t i = 0; i < epochs; i++)
+  {
+    for (auto k : epoch)
+      add (str, k);
+    if (i % 10 == 0)
+    {
+      add (str, DBT);
+      add (str, TTM);
+    }
+    tick ();
+  }
+  return str;
+}
+
+SUITE (nmea_bench)
+{
+  // Every generated sentence can be parsed
+  TEST (corpus_valid)
+  {
+    nmea_corpus gen;
+    for (int i = 0; i < 100; i++)
+    {
+      for (int k = 0; k < nmea_corpus::KIND_COUNT; k++)
+      {
+        auto s = gen.sentence ((nmea_corpus::kind)k);
+        CHECK (nmea::checksum (s.c_str ()));
+        if (nmea::parse (s.c_str ()).index () == 0)
+          CHECK_EX (false, "Cannot parse %s", s.c_str ());
+      }
+      gen.tick ();
+    }
+  }
+
+  // Framer statistics match the number of generated good and bad sentences
+  TEST (corpus_errors)
+  {
+    nmea_corpus gen (2);
+    gen.corrupt = 0.02;
+    gen.truncate = 0.01;
+    auto str = gen.stream (2000);
+    CHECK (gen.corrupted > 0);
+    CHECK (gen.truncated > 0);
+
+    nmea::framer fr (128, true);
+    fr.push (str.data (), str.size ());
+    std::string_view s;
+    size_t parsed = 0;
+    while (fr.next (s))
+      parsed += nmea::parse (std::string (s).c_str ()).index () != 0;
+    auto& st = fr.statistics ();
+    CHECK_EQUAL (gen.good, st.sentences);
+    CHECK_EQUAL (gen.corrupted, st.bad_checksum);
+    CHECK_EQUAL (gen.good, parsed);
+    CHECK (st.dropped > 0);
+  }
+
+  // Speed of each sentence parser
+  TEST (parsers)
+  {
+    const int N = 100000;
+    const int M = 256; // different sentences of each type
+    double d[12];
+    int n[12], sv[12], az[4], el[4], snr[4];
+    unsigned short us[3];
+    char name[32];
+
+    struct parser
+    {
+      const char* name;
+      nmea_corpus::kind kind;
+      std::function<int (const char*)> fn;
+    } parsers[] = {
+      {"dbt", nmea_corpus::DBT, [&] (const char* s) { return nmea::dbt (s, d); }},
+      {"gga", nmea_corpus::GGA,
+       [&] (const char* s) {
+         return nmea::gga (s, d, d + 1, d + 2, d + 3, d + 4, d + 5, n, n + 1, d + 6, n + 2);
+       }},
+      {"gll", nmea_corpus::GLL, [&] (const char* s) { return nmea::gll (s, d, d + 1, d + 2, n); }},
+      {"gns", nmea_corpus::GNS,
+       [&] (const char* s) {
+         return nmea::gns (s, d, d + 1, d + 2, n, n + 1, d + 3, d + 4, d + 5, n + 2);
+       }},
+      {"gsa", nmea_corpus::GSA,
+       [&] (const char* s) { return nmea::gsa (s, n, n + 1, sv, d, d + 1, d + 2); }},
+      {"gst", nmea_corpus::GST,
+       [&] (const char* s) {
+         return nmea::gst (s, d, d + 1, d + 2, d + 3, d + 4, d + 5, d + 6, d + 7);
+       }},
+      {"gsv", nmea_corpus::GSV,
+       [&] (const char* s) { return nmea::gsv (s, n, n + 1, n + 2, sv, az, el, snr); }},
+      {"hdt", nmea_corpus::HDT, [&] (const char* s) { return nmea::hdt (s, d); }},
+      {"pashr", nmea_corpus::PASHR,
+       [&] (const char* s) {
+         return nmea::pashr (s, d, d + 1, d + 2, d + 3, d + 4, d + 5, d + 6, d + 7, n, n + 1);
+       }},
+      {"rmc", nmea_corpus::RMC,
+       [&] (const char* s) { return nmea::rmc (s, d, d + 1, d + 2, d + 3, d + 4, n, n + 1); }},
+      {"ttm", nmea_corpus::TTM,
+       [&] (const char* s) {
+         return nmea::ttm (s, d, n, name, d + 1, d + 2, n + 1, d + 3, d + 4, n + 2, d + 5, d + 6,
+                           n + 3);
+       }},
+      {"vtg", nmea_corpus::VTG, [&] (const char* s) { return nmea::vtg (s, d, d + 1); }},
+      {"zda", nmea_corpus::ZDA,
+       [&] (const char* s) { return nmea::zda (s, d, us, us + 1, us + 2); }},
+    };
+
+    nmea_corpus gen;
+    cout << "NMEA parsers speed:" << endl;
+    for (auto& p : parsers)
+    {
+      std::vector<std::string> sentences;
+      for (int i = 0; i < M; i++)
+      {
+        sentences.push_back (gen.sentence (p.kind));
+        gen.tick ();
+      }
+
+      int ok = 0;
+      UnitTest::Timer t;
+      t.Start ();
+      for (int i = 0; i < N; i++)
+        ok += p.fn (sentences[i % M].c_str ()) != 0;
+      auto dt = t.GetTimeInUs ();
+
+      CHECK_EQUAL (N, ok);
+      cout << " " << left << setw (6) << p.name << right << setw (10)
+           << (dt ? N * 1000000LL / dt : 0) << " sentences/sec " << setw (7) << fixed
+           << setprecision (1) << dt * 1000. / N << " ns/sentence" << endl;
+    }
+    cout.unsetf (ios::floatfield);
+  }
+
+  // Speed of framing, checksum validation and parsing of a mixed stream
+  TEST (stream)
+  {
+    nmea_corpus gen;
+    gen.corrupt = 0.01;
+    gen.truncate = 0.005;
+    auto str = gen.stream (20000);
+    size_t total = gen.good + gen.corrupted + gen.truncated;
+
+    nmea::framer fr (128, true);
+    std::string_view s;
+    char buf[256];
+    size_t parsed = 0;
+    UnitTest::Timer t;
+    t.Start ();
+    fr.push (str.data (), str.size ());
+    while (fr.next (s))
+    {
+      memcpy (buf, s.data (), s.size ());
+      buf[s.size ()] = 0;
+      parsed += nmea::parse (buf).index () != 0;
+    }
+    auto dt = t.GetTimeInUs ();
+
+    CHECK_EQUAL (gen.good, parsed);
+    cout << "NMEA mixed stream (" << str.size () / 1024 << "kB, " << total
+         << " sentences): " << (dt ? total * 1000000LL / dt : 0) << " sentences/sec, "
+         << (dt ? str.size () / dt : 0) << " MB/sec" << endl;
+  }
+}
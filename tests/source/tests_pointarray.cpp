@@ -0,0 +1,168 @@
+#include <utpp/utpp.h>
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <iostream>
+#include <random>
+
+using namespace mlib;
+using namespace std;
+
+SUITE (pointarray)
+{
+  static std::vector<dpoint> random_points (size_t n, unsigned int seed = 1)
+  {
+    std::mt19937 rng (seed);
+    std::uniform_real_distribution<double> u (-100, 100);
+    std::vector<dpoint> pts (n);
+    for (auto& p : pts)
+      p = dpoint (u (rng), u (rng));
+    return pts;
+  }
+
+  TEST (container)
+  {
+    auto pts = random_points (11);
+    dpoint_array pa (pts);
+    CHECK_EQUAL (11, pa.size ());
+    CHECK_EQUAL (pts[3].x, pa.x ()[3]);
+    CHECK_EQUAL (pts[3].y, pa.y ()[3]);
+    CHECK (pa.points () == pts);
+
+    pa.push_back (dpoint (1, 2));
+    CHECK_EQUAL (dpoint (1, 2), pa[11]);
+    pa.set (0, dpoint (3, 4));
+    CHECK_EQUAL (4., pa.y ()[0]);
+
+    // coordinates can be changed in place
+    pa.x ()[1] = 5;
+    CHECK_EQUAL (5., pa[1].x);
+    pa.clear ();
+    CHECK (pa.empty ());
+  }
+
+  // Bulk results match those of Point functions
+  TEST (kernels)
+  {
+    auto pts = random_points (1001);
+    pts[5] = pts[0];                 // coincident with reference point
+    pts[6] = pts[0] + dpoint (0, 1); // due north
+    pts[7] = pts[0] + dpoint (0, -1); // due south
+    pts[8] = pts[0] + dpoint (-1, 0); // due west
+    dpoint_array pa (pts);
+    dpoint ref = pts[0];
+    std::vector<double> d (pts.size ()), az (pts.size ());
+
+    pa.distance (ref, d);
+    pa.azimuth (ref, az);
+    for (size_t i = 0; i < pts.size (); i++)
+    {
+      CHECK_CLOSE (ref.distance (pts[i]), d[i], 1e-12);
+      CHECK_CLOSE (ref.azimuth (pts[i]), az[i], 1e-14);
+    }
+    CHECK_EQUAL (0., az[5]);
+    CHECK_CLOSE (M_PI, az[7], 1e-15);
+    CHECK_CLOSE (1.5 * M_PI, az[8], 1e-15);
+
+    dpoint ll, ur;
+    CHECK (pa.bbox (ll, ur));
+    for (auto& p : pts)
+      CHECK (ll.x <= p.x && p.x <= ur.x && ll.y <= p.y && p.y <= ur.y);
+
+    dpoint q (10, 10);
+    size_t k = pa.nearest (q);
+    for (auto& p : pts)
+      CHECK (q.distance (pts[k]) <= q.distance (p));
+    CHECK_EQUAL (0, pa.nearest (ref)); // first of two equal points
+
+    CHECK_EQUAL (SIZE_MAX, dpoint_array ().nearest (q));
+    CHECK (!dpoint_array ().bbox (ll, ur));
+  }
+
+  TEST (transforms)
+  {
+    auto pts = random_points (103);
+    dpoint_array pa (pts);
+    pa.translate (dpoint (1, -2));
+    pa.rotate (0.3);
+    dpoint c (5, 6);
+    pa.rotate (-0.2, c);
+    for (size_t i = 0; i < pts.size (); i++)
+    {
+      dpoint p = pts[i] + dpoint (1, -2);
+      p.rotate (0.3);
+      p -= c;
+      p.rotate (-0.2);
+      p += c;
+      CHECK_CLOSE (p.x, pa[i].x, 1e-12);
+      CHECK_CLOSE (p.y, pa[i].y, 1e-12);
+    }
+  }
+
+  // Other point types use generic code
+  TEST (float_points)
+  {
+    point_array<float> pa;
+    pa.push_back (Point<float> (0, 0));
+    pa.push_back (Point<float> (3, 4));
+    pa.push_back (Point<float> (-1, 2));
+    std::vector<double> d (3);
+    pa.distance (Point<float> (0, 0), d);
+    CHECK_EQUAL (5., d[1]);
+    CHECK_EQUAL (2, pa.nearest (Point<float> (-2, 2)));
+    Point<float> ll, ur;
+    pa.bbox (ll, ur);
+    CHECK_EQUAL (-1.f, ll.x);
+    CHECK_EQUAL (4.f, ur.y);
+  }
+
+  TEST (speed)
+  {
+    const size_t N = 1000000;
+    auto pts = random_points (N, 2);
+    dpoint_array pa (pts);
+    dpoint ref (1, 2);
+    std::vector<double> out (N);
+    UnitTest::Timer t;
+
+    t.Start ();
+    for (size_t i = 0; i < N; i++)
+      out[i] = ref.distance (pts[i]);
+    auto dt_dist1 = t.GetTimeInUs ();
+    t.Start ();
+    pa.distance (ref, out);
+    auto dt_dist = t.GetTimeInUs ();
+
+    t.Start ();
+    for (size_t i = 0; i < N; i++)
+      out[i] = ref.azimuth (pts[i]);
+    auto dt_az1 = t.GetTimeInUs ();
+    t.Start ();
+    pa.azimuth (ref, out);
+    auto dt_az = t.GetTimeInUs ();
+
+    t.Start ();
+    size_t k1 = 0;
+    for (size_t i = 1; i < N; i++)
+      if (ref.distance (pts[i]) < ref.distance (pts[k1]))
+        k1 = i;
+    auto dt_near1 = t.GetTimeInUs ();
+    t.Start ();
+    size_t k = pa.nearest (ref);
+    auto dt_near = t.GetTimeInUs ();
+    CHECK_EQUAL (k1, k);
+
+    t.Start ();
+    for (auto& p : pts)
+      p.rotate (0.1);
+    auto dt_rot1 = t.GetTimeInUs ();
+    t.Start ();
+    pa.rotate (0.1);
+    auto dt_rot = t.GetTimeInUs ();
+
+    cout << "point_array - " << N << " points, Point loop vs. bulk (us):" << endl
+         << " distance " << dt_dist1 << " / " << dt_dist << ", azimuth " << dt_az1 << " / "
+         << dt_az << ", nearest " << dt_near1 << " / " << dt_near << ", rotate " << dt_rot1
+         << " / " << dt_rot << endl;
+  }
+}
@@ -0,0 +1,173 @@
+#include <utpp/utpp.h>
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <iostream>
+#include <random>
+
+using namespace mlib;
+using namespace std;
+
+SUITE (rotations)
+{
+  static std::vector<double> random_values (size_t n, unsigned int seed)
+  {
+    std::mt19937 rng (seed);
+    std::uniform_real_distribution<double> u (-100, 100);
+    std::vector<double> v (n);
+    for (auto& x : v)
+      x = u (rng);
+    return v;
+  }
+
+  // Batch rotations give the same results as rotating each point
+  TEST (batch)
+  {
+    RotMat r (10_deg, -5_deg, 123_deg);
+    const size_t N = 1001;
+    auto x = random_values (N, 1), y = random_values (N, 2), z = random_values (N, 3);
+    std::vector<double> xyz (3 * N);
+    for (size_t i = 0; i < N; i++)
+    {
+      xyz[3 * i] = x[i];
+      xyz[3 * i + 1] = y[i];
+      xyz[3 * i + 2] = z[i];
+    }
+    auto x1 = x, y1 = y, z1 = z;
+
+    r.rotate (xyz.data (), N);
+    r.rotate (x1, y1, z1);
+    for (size_t i = 0; i < N; i++)
+    {
+      double p[3] = {x[i], y[i], z[i]};
+      r.rotate (p);
+      CHECK_ARRAY_CLOSE (p, &xyz[3 * i], 3, 1e-12);
+      CHECK_CLOSE (p[0], x1[i], 1e-12);
+      CHECK_CLOSE (p[1], y1[i], 1e-12);
+      CHECK_CLOSE (p[2], z1[i], 1e-12);
+    }
+  }
+
+  TEST (combined)
+  {
+    RotMat mount (1_deg, 2_deg, 3_deg), att (5_deg, -3_deg, 80_deg);
+    RotMat both = att * mount;
+    double p[3] = {1, 2, 3}, q[3] = {1, 2, 3};
+    mount.rotate (p);
+    att.rotate (p);
+    both.rotate (q);
+    CHECK_ARRAY_CLOSE (p, q, 3, 1e-12);
+
+    // rotation followed by its inverse is identity
+    RotMat id = att.transpose () * att;
+    double eye[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    CHECK_ARRAY2D_CLOSE (eye, id.matrix (), 3, 3, 1e-12);
+  }
+
+  TEST (quaternion)
+  {
+    for (double rz : {0_deg, 45_deg, 170_deg, 190_deg, 300_deg})
+    {
+      RotMat r (30_deg, -20_deg, rz);
+      Quaternion q (30_deg, -20_deg, rz);
+      CHECK_ARRAY2D_CLOSE (r.matrix (), q.rotmat ().matrix (), 3, 3, 1e-12);
+
+      // conversion from matrix gives the same rotation (q or -q)
+      Quaternion q1 (r);
+      double d = q.w * q1.w + q.x * q1.x + q.y * q1.y + q.z * q1.z;
+      CHECK_CLOSE (1., fabs (d), 1e-12);
+
+      double p[3] = {1, -2, 3};
+      double x = 1, y = -2, z = 3;
+      r.rotate (p);
+      q.rotate (x, y, z);
+      CHECK_CLOSE (p[0], x, 1e-12);
+      CHECK_CLOSE (p[1], y, 1e-12);
+      CHECK_CLOSE (p[2], z, 1e-12);
+    }
+
+    Quaternion a (10_deg, 0, 0), b (0, 0, 30_deg);
+    RotMat ab = a.rotmat () * b.rotmat ();
+    CHECK_ARRAY2D_CLOSE (ab.matrix (), (a * b).rotmat ().matrix (), 3, 3, 1e-12);
+    Quaternion id = a * a.conjugate ();
+    CHECK_CLOSE (1., id.w, 1e-12);
+  }
+
+  TEST (interpolation)
+  {
+    Quaternion q0 (0, 0, 10_deg), q1 (0, 0, 50_deg);
+    Quaternion q = slerp (q0, q1, 0.25);
+    Quaternion expected (0, 0, 20_deg);
+    CHECK_ARRAY2D_CLOSE (expected.rotmat ().matrix (), q.rotmat ().matrix (), 3, 3, 1e-12);
+
+    // crossing north goes the short way
+    q0 = Quaternion (0, 0, 350_deg);
+    q1 = Quaternion (0, 0, 10_deg);
+    expected = Quaternion (0, 0, 0);
+    q = slerp (q0, q1, 0.5);
+    CHECK_ARRAY2D_CLOSE (expected.rotmat ().matrix (), q.rotmat ().matrix (), 3, 3, 1e-12);
+    q = nlerp (q0, q1, 0.5);
+    CHECK_ARRAY2D_CLOSE (expected.rotmat ().matrix (), q.rotmat ().matrix (), 3, 3, 1e-12);
+
+    // end points
+    q0 = Quaternion (3_deg, -2_deg, 100_deg);
+    q1 = Quaternion (-1_deg, 1_deg, 102_deg);
+    CHECK_ARRAY2D_CLOSE (q0.rotmat ().matrix (), slerp (q0, q1, 0).rotmat ().matrix (), 3, 3,
+                         1e-12);
+    CHECK_ARRAY2D_CLOSE (q1.rotmat ().matrix (), nlerp (q0, q1, 1).rotmat ().matrix (), 3, 3,
+                         1e-12);
+  }
+
+  // Motion compensation of sonar pings: interpolate attitude, rotate beams
+  TEST (speed)
+  {
+    const size_t beams = 512, pings = 2000;
+    auto x = random_values (beams, 4), y = random_values (beams, 5), z = random_values (beams, 6);
+    std::vector<double> xyz (3 * beams);
+    RotMat mount (0.5_deg, -0.2_deg, 1_deg);
+    UnitTest::Timer t;
+
+    t.Start ();
+    for (size_t k = 0; k < pings; k++)
+    {
+      RotMat r (2_deg * sin (k * 0.01), 1_deg * cos (k * 0.01), 90_deg + k * 0.001);
+      for (size_t i = 0; i < beams; i++)
+      {
+        double p[3] = {x[i], y[i], z[i]};
+        mount.rotate (p);
+        r.rotate (p);
+      }
+    }
+    auto dt_loop = t.GetTimeInUs ();
+
+    auto x1 = x, y1 = y, z1 = z;
+    Quaternion a0 (2_deg, 1_deg, 90_deg), a1 (-2_deg, 1.5_deg, 91_deg);
+    t.Start ();
+    for (size_t k = 0; k < pings; k++)
+    {
+      RotMat r = nlerp (a0, a1, (double)k / pings).rotmat () * mount;
+      r.rotate (x1, y1, z1);
+    }
+    auto dt_soa = t.GetTimeInUs ();
+
+    for (size_t i = 0; i < beams; i++)
+    {
+      xyz[3 * i] = x[i];
+      xyz[3 * i + 1] = y[i];
+      xyz[3 * i + 2] = z[i];
+    }
+    t.Start ();
+    for (size_t k = 0; k < pings; k++)
+    {
+      RotMat r = nlerp (a0, a1, (double)k / pings).rotmat () * mount;
+      r.rotate (xyz.data (), beams);
+    }
+    auto dt_aos = t.GetTimeInUs ();
+
+    const long long N = beams * pings;
+    cout << "Rotation of " << pings << " pings x " << beams << " beams (points/sec):" << endl
+         << " point by point " << (dt_loop ? N * 1000000LL / dt_loop : 0)
+         << ", interpolated attitude + batch SoA " << (dt_soa ? N * 1000000LL / dt_soa : 0)
+         << ", batch AoS " << (dt_aos ? N * 1000000LL / dt_aos : 0) << endl;
+  }
+}
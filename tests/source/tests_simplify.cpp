@@ -0,0 +1,156 @@
+#include <utpp/utpp.h>
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <iostream>
+#include <random>
+
+using namespace mlib;
+using namespace std;
+
+SUITE (simplify)
+{
+  // Random walk with small steps and occasional turns
+  static std::vector<dpoint> random_track (size_t n, unsigned int seed = 1)
+  {
+    std::mt19937 rng (seed);
+    std::normal_distribution<double> noise (0, 0.2);
+    std::uniform_real_distribution<double> u (0, 1);
+    std::vector<dpoint> pts (n);
+    dpoint p (0, 0);
+    double heading = 0;
+    for (auto& pt : pts)
+    {
+      if (u (rng) < 0.01)
+        heading += (u (rng) - 0.5) * M_PI;
+      p += dpoint (sin (heading), cos (heading)) + dpoint (noise (rng), noise (rng));
+      pt = p;
+    }
+    return pts;
+  }
+
+  // Maximum distance from removed points to the simplified polyline
+  static double max_deviation (const std::vector<dpoint>& pts, const std::vector<size_t>& keep)
+  {
+    double dmax = 0;
+    for (size_t k = 1; k < keep.size (); k++)
+    {
+      for (size_t i = keep[k - 1] + 1; i < keep[k]; i++)
+        dmax = (std::max) (dmax, detail::seg_dist2 (pts[i], pts[keep[k - 1]], pts[keep[k]]));
+    }
+    return sqrt (dmax);
+  }
+
+  TEST (douglas_peucker)
+  {
+    std::vector<dpoint> pts{{0, 0}, {1, 0.1}, {2, -0.1}, {3, 5}, {4, 6}, {5, 7}};
+    std::vector<size_t> keep;
+    CHECK_EQUAL (4, douglas_peucker<double> (pts, 0.5, keep));
+    std::vector<size_t> expected{0, 2, 3, 5};
+    CHECK (keep == expected);
+
+    // zero tolerance keeps only non-collinear points
+    std::vector<dpoint> line{{0, 0}, {1, 1}, {2, 2}, {3, 3}};
+    CHECK_EQUAL (2, douglas_peucker<double> (line, 0, keep));
+
+    // degenerate inputs
+    CHECK_EQUAL (0, douglas_peucker<double> ({}, 1, keep));
+    CHECK_EQUAL (1, douglas_peucker<double> (std::span (pts.data (), 1), 1, keep));
+
+    auto track = random_track (10000);
+    douglas_peucker<double> (track, 2., keep);
+    CHECK (keep.size () < track.size () / 5);
+    CHECK (max_deviation (track, keep) <= 2.);
+    CHECK_EQUAL (0, keep.front ());
+    CHECK_EQUAL (track.size () - 1, keep.back ());
+  }
+
+  TEST (visvalingam)
+  {
+    std::vector<dpoint> pts{{0, 0}, {1, 0.1}, {2, -0.1}, {3, 5}, {4, 6}, {5, 7}};
+    std::vector<size_t> keep;
+    CHECK_EQUAL (4, visvalingam<double> (pts, 1., keep));
+    std::vector<size_t> expected{0, 2, 3, 5};
+    CHECK (keep == expected);
+
+    CHECK_EQUAL (6, visvalingam<double> (pts, 0., keep));
+
+    auto track = random_track (10000);
+    visvalingam<double> (track, 5., keep);
+    CHECK (keep.size () < track.size () / 3);
+    CHECK_EQUAL (0, keep.front ());
+    CHECK_EQUAL (track.size () - 1, keep.back ());
+    for (size_t k = 1; k < keep.size () - 1; k++)
+      CHECK (detail::tri_area (track[keep[k - 1]], track[keep[k]], track[keep[k + 1]]) > 0);
+  }
+
+  TEST (online)
+  {
+    auto track = random_track (10000, 2);
+    OnlineSimplifier<double> simp (2.);
+    std::vector<size_t> keep;
+    for (auto& p : track)
+    {
+      if (simp.add (p))
+      {
+        CHECK (simp.key () == track[simp.key_index ()]);
+        keep.push_back (simp.key_index ());
+      }
+    }
+    CHECK (simp.finish ());
+    keep.push_back (simp.key_index ());
+    CHECK (!simp.finish ());
+
+    CHECK_EQUAL (0, keep.front ());
+    CHECK_EQUAL (track.size () - 1, keep.back ());
+    CHECK (std::is_sorted (keep.begin (), keep.end ()));
+    CHECK (keep.size () < track.size () / 5);
+    CHECK (max_deviation (track, keep) <= 2.);
+
+    // number of pending points is bounded
+    OnlineSimplifier<double> bounded (1e6, 100);
+    keep.clear ();
+    for (auto& p : track)
+    {
+      if (bounded.add (p))
+        keep.push_back (bounded.key_index ());
+    }
+    for (size_t k = 1; k < keep.size (); k++)
+      CHECK (keep[k] - keep[k - 1] <= 100);
+
+    bounded.clear ();
+    CHECK_EQUAL (0, bounded.count ());
+    CHECK_EQUAL (SIZE_MAX, bounded.key_index ());
+    CHECK (!bounded.finish ());
+  }
+
+  TEST (speed)
+  {
+    const size_t N = 1000000;
+    auto track = random_track (N, 3);
+    std::vector<size_t> keep;
+    UnitTest::Timer t;
+
+    t.Start ();
+    douglas_peucker<double> (track, 1., keep);
+    auto dt_dp = t.GetTimeInMs ();
+    size_t n_dp = keep.size ();
+
+    t.Start ();
+    visvalingam<double> (track, 2., keep);
+    auto dt_vw = t.GetTimeInMs ();
+    size_t n_vw = keep.size ();
+
+    t.Start ();
+    OnlineSimplifier<double> simp (1.);
+    size_t n_online = 0;
+    for (auto& p : track)
+      n_online += simp.add (p);
+    n_online += simp.finish ();
+    auto dt_online = t.GetTimeInMs ();
+
+    cout << "Simplification of " << N << " points track (ms / points kept):" << endl
+         << " Douglas-Peucker " << dt_dp << " / " << n_dp << ", Visvalingam " << dt_vw << " / "
+         << n_vw << ", online " << dt_online << " / " << n_online << endl;
+  }
+}
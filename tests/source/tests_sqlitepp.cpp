@@ -429,4 +429,241 @@ TEST (method_schema)
   remove ("disk1.db");
   remove ("disk2.db");
 }
-}
\ No newline at end of file
+
+TEST (scalar_function)
+{
+  Database db ("");
+  CHECK_EQUAL (erc::success, db.create_function ("half", [] (double x) { return x / 2; }));
+  Query q (db, "SELECT half (5)");
+  q.step ();
+  CHECK_EQUAL (2.5, q.column_double (0));
+}
+
+TEST (scalar_function_text)
+{
+  Database db ("");
+  std::string prefix = "Hello ";
+  db.create_function ("greet", [prefix] (const std::string& s) { return prefix + s; });
+  Query q (db, "SELECT greet ('world')");
+  q.step ();
+  CHECK_EQUAL ("Hello world", q.column_str (0));
+}
+
+TEST (scalar_function_null)
+{
+  Database db ("");
+  db.create_function ("twice", [] (std::optional<int> x) -> std::optional<int> {
+    if (x)
+      return *x * 2;
+    return std::nullopt;
+  });
+  Query q (db, "SELECT twice (NULL), twice (21)");
+  q.step ();
+  CHECK_EQUAL (SQLITE_NULL, q.column_type (0));
+  CHECK_EQUAL (42, q.column_int (1));
+}
+
+TEST (scalar_function_results)
+{
+  Database db ("");
+  db.create_function ("big", [] () { return (uint32_t)3000000000u; });
+  db.create_function ("none", [] () { return (const char*)nullptr; });
+  Query q (db, "SELECT big (), none ()");
+  q.step ();
+  CHECK_EQUAL (3000000000LL, q.column_int64 (0));
+  CHECK_EQUAL (SQLITE_NULL, q.column_type (1));
+}
+
+TEST (scalar_function_filter)
+{
+  Database db ("");
+  db.exec ("CREATE TABLE pts (x REAL, y REAL);"
+           "INSERT INTO pts VALUES (1, 1);"
+           "INSERT INTO pts VALUES (5, 5);"
+           "INSERT INTO pts VALUES (2, 3);");
+  db.create_function ("inside", [] (double x, double y) { return x < 4 && y < 4; });
+  Query q (db, "SELECT count(*) FROM pts WHERE inside (x, y)");
+  q.step ();
+  CHECK_EQUAL (2, q.column_int (0));
+}
+
+TEST (scalar_function_throw)
+{
+  Database db ("");
+  db.create_function ("fail", [] (int) -> int { throw std::runtime_error ("bad argument"); });
+  Query q (db, "SELECT fail (1)");
+  CHECK_EQUAL (SQLITE_ERROR, q.step ());
+  CHECK_EQUAL ("bad argument", std::string (sqlite3_errmsg (db)));
+}
+
+struct product
+{
+  double p = 1;
+  void step (double x)
+  {
+    p *= x;
+  }
+  double result () const
+  {
+    return p;
+  }
+};
+
+TEST (aggregate_function)
+{
+  Database db ("");
+  db.exec ("CREATE TABLE tab (grp INTEGER, val REAL);"
+           "INSERT INTO tab VALUES (1, 2);"
+           "INSERT INTO tab VALUES (1, 3);"
+           "INSERT INTO tab VALUES (2, 4);"
+           "INSERT INTO tab VALUES (2, 5);");
+  CHECK_EQUAL (erc::success, db.create_aggregate<product> ("product"));
+  Query q (db, "SELECT grp, product (val) FROM tab GROUP BY grp ORDER BY grp");
+  q.step ();
+  CHECK_EQUAL (6., q.column_double (1));
+  q.step ();
+  CHECK_EQUAL (20., q.column_double (1));
+
+  //empty table produces result of default constructed object
+  q = "SELECT product (val) FROM tab WHERE grp = 3";
+  q.step ();
+  CHECK_EQUAL (1., q.column_double (0));
+}
+
+struct moving_sum
+{
+  int s = 0;
+  void step (int x)
+  {
+    s += x;
+  }
+  void inverse (int x)
+  {
+    s -= x;
+  }
+  int result () const
+  {
+    return s;
+  }
+};
+
+TEST (window_function)
+{
+  Database db ("");
+  db.exec ("CREATE TABLE tab (val INTEGER);"
+           "INSERT INTO tab VALUES (1);"
+           "INSERT INTO tab VALUES (2);"
+           "INSERT INTO tab VALUES (3);"
+           "INSERT INTO tab VALUES (4);");
+  CHECK_EQUAL (erc::success, db.create_window_function<moving_sum> ("msum"));
+  Query q (db, "SELECT msum (val) OVER (ORDER BY val ROWS BETWEEN 1 PRECEDING AND CURRENT ROW) "
+               "FROM tab");
+  int expected[] = {1, 3, 5, 7};
+  for (auto e : expected)
+  {
+    q.step ();
+    CHECK_EQUAL (e, q.column_int (0));
+  }
+}
+
+TEST (remove_function)
+{
+  Database db ("");
+  db.create_function ("one", [] () { return 1; });
+  CHECK_EQUAL (erc::success, db.remove_function ("one", 0));
+  auto q = db.make_query ("SELECT one ()");
+  CHECK_EQUAL (SQLITE_ERROR, q);
+}
+
+TEST (rtree_points)
+{
+  Database db ("");
+  db.exec ("CREATE TABLE pts (x REAL, y REAL)");
+  RTree idx (db, "pts");
+  CHECK_EQUAL (erc::success, idx.create ());
+  for (int i = 0; i < 10; i++)
+    for (int j = 0; j < 10; j++)
+      Query (db, "INSERT INTO pts VALUES (?, ?)").bind (1, i + 0.5).bind (2, j + 0.5).step ();
+
+  //bounding box query
+  auto q = idx.query (dpoint (0, 0), dpoint (2, 2));
+  int n = 0;
+  while (q.step () == SQLITE_ROW)
+  {
+    CHECK (q.column_double ("x") < 2 && q.column_double ("y") < 2);
+    n++;
+  }
+  CHECK_EQUAL (4, n);
+
+  //non-square rectangle
+  q = idx.query (dpoint (0, 3), dpoint (1, 8));
+  n = 0;
+  while (q.step () == SQLITE_ROW)
+  {
+    CHECK (q.column_double ("x") < 1 && q.column_double ("y") > 3);
+    n++;
+  }
+  CHECK_EQUAL (5, n);
+
+  //triangle with vertexes (0,0), (10,0), (0,10)
+  Border b;
+  b.add (0, 0);
+  b.add (10, 0);
+  b.add (0, 10);
+  b.close (1, 1);
+  auto ids = idx.inside (b);
+  CHECK_EQUAL (45u, ids.size ());
+
+  //hole border: points outside the triangle
+  Border h;
+  h.add (0, 0);
+  h.add (10, 0);
+  h.add (0, 10);
+  h.close (9, 9);
+  CHECK_EQUAL (55u, idx.inside (h).size ());
+}
+
+TEST (rtree_maintenance)
+{
+  Database db ("");
+  db.exec ("CREATE TABLE pts (x REAL, y REAL);"
+           "INSERT INTO pts VALUES (1, 1);"
+           "INSERT INTO pts VALUES (5, 5);");
+  RTree idx (db, "pts");
+  idx.create (); // existing rows are indexed
+
+  Query cnt (db, "SELECT count(*) FROM pts_rtree");
+  cnt.step ();
+  CHECK_EQUAL (2, cnt.column_int (0));
+
+  db.exec ("UPDATE pts SET x=2, y=2 WHERE x=5");
+  auto q = idx.query (dpoint (1.5, 1.5), dpoint (2.5, 2.5));
+  CHECK_EQUAL (SQLITE_ROW, q.step ());
+  CHECK_EQUAL (2., q.column_double ("x"));
+
+  db.exec ("DELETE FROM pts WHERE x=1");
+  cnt.reset ();
+  cnt.step ();
+  CHECK_EQUAL (1, cnt.column_int (0));
+
+  q.clear ();
+  cnt.clear ();
+  CHECK_EQUAL (erc::success, idx.drop ());
+  CHECK_EQUAL (SQLITE_ERROR, db.exec ("SELECT * FROM pts_rtree"));
+}
+
+TEST (rtree_boxes)
+{
+  Database db ("");
+  db.exec ("CREATE TABLE areas (name TEXT, x0 REAL, x1 REAL, y0 REAL, y1 REAL);"
+           "INSERT INTO areas VALUES ('A', 0, 10, 0, 10);"
+           "INSERT INTO areas VALUES ('B', 20, 30, 20, 30);");
+  RTree idx (db, "areas", "x0", "x1", "y0", "y1");
+  idx.create ();
+  CHECK (!idx.points ());
+  auto q = idx.query (dpoint (5, 5), dpoint (6, 6));
+  CHECK_EQUAL (SQLITE_ROW, q.step ());
+  CHECK_EQUAL ("A", q.column_str ("name"));
+  CHECK_EQUAL (SQLITE_DONE, q.step ());
+}
+}
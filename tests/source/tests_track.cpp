@@ -0,0 +1,244 @@
+#include <utpp/utpp.h>
+#include <mlib/mlib.h>
+#pragma hdrstop
+
+#include <filesystem>
+#include <iostream>
+
+using namespace mlib;
+using namespace std;
+
+SUITE (track)
+{
+  // Simulated 20 Hz track of a vehicle moving on a circle
+  static track_point sample (size_t i)
+  {
+    double t = 43200. + i * 0.05;
+    double a = i * 1e-4;
+    return {t,
+            {-73.6_deg + 1e-4 * cos (a), 45.5_deg + 1e-4 * sin (a)},
+            25. + 0.5 * sin (a * 10),
+            (int)(i / 1000) % 2 ? 4 : 5,
+            12 + (int)(i / 500) % 3};
+  }
+
+  TEST (write_read)
+  {
+    const size_t N = 3000;
+    {
+      track_writer tw;
+      CHECK_EQUAL (0, tw.open ("track_test.trk", track_resolution{}, 256));
+      for (size_t i = 0; i < N; i++)
+        CHECK_EQUAL (0, tw.append (sample (i)));
+      CHECK_EQUAL (0, tw.close ());
+    }
+
+    track_reader tr;
+    CHECK_EQUAL (0, tr.open ("track_test.trk"));
+    CHECK_EQUAL (N, tr.size ());
+    CHECK_EQUAL (12, tr.index ().size ());
+    size_t i = 0;
+    for (auto& p : tr)
+    {
+      auto s = sample (i++);
+      CHECK_CLOSE (s.time, p.time, 1e-9);
+      CHECK_CLOSE (s.pos.x, p.pos.x, 1e-10);
+      CHECK_CLOSE (s.pos.y, p.pos.y, 1e-10);
+      CHECK_CLOSE (s.height, p.height, 1e-3);
+      CHECK_EQUAL (s.quality, p.quality);
+      CHECK_EQUAL (s.sat, p.sat);
+    }
+    CHECK_EQUAL (N, i);
+    tr.close ();
+    std::filesystem::remove ("track_test.trk");
+  }
+
+  TEST (time_lookup)
+  {
+    {
+      track_writer tw;
+      tw.open ("track_test.trk", track_resolution{}, 100);
+      for (size_t i = 0; i < 1000; i++)
+        tw.append (sample (i));
+    }
+
+    track_reader tr;
+    CHECK_EQUAL (0, tr.open ("track_test.trk"));
+    auto p = tr.lower_bound (43210.);
+    ABORT_EX (p != tr.end (), "Time not found");
+    CHECK_CLOSE (43210., p->time, 1e-9);
+    p = tr.lower_bound (43210.01); // between points
+    CHECK_CLOSE (43210.05, p->time, 1e-9);
+    CHECK_CLOSE (sample (201).pos.x, p->pos.x, 1e-10);
+
+    p = tr.lower_bound (0.); // before start
+    CHECK (p == tr.begin ());
+    CHECK (tr.lower_bound (50000.) == tr.end ()); // after end
+
+    // iterate over a time range
+    int n = 0;
+    for (p = tr.lower_bound (43205.); p != tr.end () && p->time < 43215.; ++p)
+      n++;
+    CHECK_EQUAL (200, n);
+    tr.close ();
+    std::filesystem::remove ("track_test.trk");
+  }
+
+  TEST (append)
+  {
+    track_writer tw;
+    track_resolution res;
+    res.pos = 1e-9;
+    CHECK_EQUAL (0, tw.open ("track_test.trk", res, 128));
+    for (size_t i = 0; i < 500; i++)
+      tw.append (sample (i));
+    tw.close ();
+
+    // reopen and append; file resolution is kept
+    CHECK_EQUAL (0, tw.open ("track_test.trk"));
+    CHECK_EQUAL (1e-9, tw.resolution ().pos);
+    erc ret = tw.append (sample (10)); // out of order
+    CHECK_EQUAL (EINVAL, ret.code ());
+    ret.deactivate ();
+    for (size_t i = 500; i < 1000; i++)
+      tw.append (sample (i));
+    tw.close ();
+
+    track_reader tr;
+    tr.open ("track_test.trk");
+    CHECK_EQUAL (1000, tr.size ());
+    size_t i = 0;
+    for (auto& p : tr)
+      CHECK_CLOSE (sample (i++).pos.y, p.pos.y, 1e-9);
+    tr.close ();
+    std::filesystem::remove ("track_test.trk");
+  }
+
+  // Incomplete last block is ignored by reader and discarded by writer
+  TEST (truncated)
+  {
+    track_writer tw;
+    tw.open ("track_test.trk", track_resolution{}, 100);
+    for (size_t i = 0; i < 250; i++)
+      tw.append (sample (i));
+    tw.close ();
+    auto sz = std::filesystem::file_size ("track_test.trk");
+    std::filesystem::resize_file ("track_test.trk", sz - 5);
+
+    track_reader tr;
+    CHECK_EQUAL (0, tr.open ("track_test.trk"));
+    CHECK_EQUAL (200, tr.size ());
+    tr.close ();
+
+    CHECK_EQUAL (0, tw.open ("track_test.trk"));
+    for (size_t i = 200; i < 300; i++)
+      CHECK_EQUAL (0, tw.append (sample (i)));
+    tw.close ();
+
+    tr.open ("track_test.trk");
+    CHECK_EQUAL (300, tr.size ());
+    size_t i = 0;
+    for (auto& p : tr)
+      CHECK_CLOSE (sample (i++).time, p.time, 1e-9);
+    tr.close ();
+    std::filesystem::remove ("track_test.trk");
+  }
+
+  TEST (bad_file)
+  {
+    FILE* f = fopen ("track_test.trk", "wb");
+    fputs ("not a track file, just some text", f);
+    fclose (f);
+
+    track_reader tr;
+    erc ret = tr.open ("track_test.trk");
+    CHECK_EQUAL (EINVAL, ret.code ());
+    ret.deactivate ();
+    std::filesystem::remove ("track_test.trk");
+  }
+
+  // Block headers and encoded points that don't match
+  TEST (corrupted_block)
+  {
+    const long count_offset = 36;   // after file header and block magic
+    const long payload_offset = 64; // after file header and block header
+    track_writer tw;
+    tw.open ("track_test.trk", track_resolution{}, 100);
+    for (size_t i = 0; i < 10; i++)
+      tw.append (sample (i));
+    tw.close ();
+    auto sz = std::filesystem::file_size ("track_test.trk");
+
+    // count too large for block size
+    FILE* f = fopen ("track_test.trk", "r+b");
+    uint32_t hdr[2] = {1000000, 20};
+    fseek (f, count_offset, SEEK_SET);
+    fwrite (hdr, sizeof (hdr), 1, f);
+    fclose (f);
+    track_reader tr;
+    CHECK_EQUAL (0, tr.open ("track_test.trk"));
+    CHECK_EQUAL (0, tr.size ());
+    tr.close ();
+
+    // payload made of never ending varints
+    f = fopen ("track_test.trk", "r+b");
+    hdr[0] = 4;
+    hdr[1] = 20;
+    fseek (f, count_offset, SEEK_SET);
+    fwrite (hdr, sizeof (hdr), 1, f);
+    fseek (f, payload_offset, SEEK_SET);
+    std::vector<uint8_t> junk (sz - payload_offset, 0xff);
+    fwrite (junk.data (), 1, junk.size (), f);
+    fclose (f);
+    CHECK_EQUAL (0, tr.open ("track_test.trk"));
+    CHECK_EQUAL (4, tr.size ());
+    size_t n = 0;
+    for (auto& p : tr)
+      n += (p.quality >= 0);
+    CHECK_EQUAL (4, n);
+    tr.close ();
+    std::filesystem::remove ("track_test.trk");
+  }
+
+  // One day of 20 Hz data
+  TEST (day_speed)
+  {
+    const size_t N = 24 * 3600 * 20;
+    UnitTest::Timer t;
+    t.Start ();
+    {
+      track_writer tw;
+      tw.open ("track_speed.trk");
+      for (size_t i = 0; i < N; i++)
+        tw.append (sample (i));
+    }
+    auto dt_write = t.GetTimeInMs ();
+
+    t.Start ();
+    track_reader tr;
+    tr.open ("track_speed.trk");
+    auto dt_open = t.GetTimeInUs ();
+
+    t.Start ();
+    double sum = 0;
+    for (auto& p : tr)
+      sum += p.height;
+    auto dt_read = t.GetTimeInMs ();
+
+    t.Start ();
+    auto p = tr.lower_bound (43200. + 12 * 3600.);
+    auto dt_find = t.GetTimeInUs ();
+    CHECK_CLOSE (43200. + 12 * 3600., p->time, 1e-9);
+
+    CHECK_EQUAL (N, tr.size ());
+    CHECK (sum > 0);
+    auto fsize = std::filesystem::file_size ("track_speed.trk");
+    cout << "Track store - " << N << " points:" << endl
+         << " file size " << fsize / 1024 << "kB (" << (double)fsize / N << " bytes/point, "
+         << 100. * fsize / (N * sizeof (track_point)) << "% of raw size)" << endl
+         << " write " << dt_write << "ms, open " << dt_open << "us, read all " << dt_read
+         << "ms, time lookup " << dt_find << "us" << endl;
+    tr.close ();
+    std::filesystem::remove ("track_speed.trk");
+  }
+}